@@ -0,0 +1,50 @@
+# ============================================================================
+# vv_embed_spirv.cmake
+# Compiles GLSL to SPIR-V at build time and embeds it into a target.
+# Utilities:
+#   - vv_embed_spirv(<target> GLSLC <exe> INCLUDE_DIR <dir> SHADERS <files...>)
+#     For each shader <name>.<stage> adds <binary dir>/vv_spirv/<name>.<stage>.inc
+#     holding `static constexpr uint32_t <name>_<stage>_spv[] = {...};` and puts
+#     that directory on the target's private include path.
+# Script mode (used by the build step above):
+#   cmake -DINPUT=<spv> -DOUTPUT=<inc> -DNAME=<identifier> -P vv_embed_spirv.cmake
+# ============================================================================
+
+if (CMAKE_SCRIPT_MODE_FILE)
+    file(READ "${INPUT}" hex HEX)
+    # SPIR-V is a little-endian word stream: bytes b0 b1 b2 b3 -> 0xb3b2b1b0
+    string(REGEX REPLACE "([0-9a-f][0-9a-f])([0-9a-f][0-9a-f])([0-9a-f][0-9a-f])([0-9a-f][0-9a-f])" "0x\\4\\3\\2\\1u," words "${hex}")
+    string(REGEX REPLACE "(0x[0-9a-f]+u,0x[0-9a-f]+u,0x[0-9a-f]+u,0x[0-9a-f]+u,0x[0-9a-f]+u,0x[0-9a-f]+u,0x[0-9a-f]+u,0x[0-9a-f]+u,)" "\\1\n    " words "${words}")
+    file(WRITE "${OUTPUT}" "// Generated from ${INPUT}; do not edit\nstatic constexpr uint32_t ${NAME}[] = {\n    ${words}\n};\n")
+    return()
+endif ()
+
+if (DEFINED _VV_EMBED_SPIRV_INCLUDED)
+    return()
+endif ()
+set(_VV_EMBED_SPIRV_INCLUDED TRUE)
+set(_VV_EMBED_SPIRV_SCRIPT ${CMAKE_CURRENT_LIST_FILE})
+
+function(vv_embed_spirv target)
+    cmake_parse_arguments(ARG "" "GLSLC;INCLUDE_DIR" "SHADERS" ${ARGN})
+    set(out_dir ${CMAKE_CURRENT_BINARY_DIR}/vv_spirv)
+    file(MAKE_DIRECTORY ${out_dir})
+    file(GLOB includes ${ARG_INCLUDE_DIR}/*.glsl)
+    set(outputs)
+    foreach (src ${ARG_SHADERS})
+        get_filename_component(file ${src} NAME)
+        string(MAKE_C_IDENTIFIER "${file}_spv" name)
+        set(spv ${out_dir}/${file}.spv)
+        set(inc ${out_dir}/${file}.inc)
+        add_custom_command(OUTPUT ${inc}
+                COMMAND ${ARG_GLSLC} --target-env=vulkan1.3 -O -I ${ARG_INCLUDE_DIR} -c ${src} -o ${spv}
+                COMMAND ${CMAKE_COMMAND} -DINPUT=${spv} -DOUTPUT=${inc} -DNAME=${name} -P ${_VV_EMBED_SPIRV_SCRIPT}
+                DEPENDS ${src} ${includes} ${_VV_EMBED_SPIRV_SCRIPT}
+                COMMENT "[glslc] ${file} -> ${file}.inc"
+                VERBATIM)
+        list(APPEND outputs ${inc})
+    endforeach ()
+    add_custom_target(${target}_spirv DEPENDS ${outputs})
+    add_dependencies(${target} ${target}_spirv)
+    target_include_directories(${target} PRIVATE ${out_dir})
+endfunction()
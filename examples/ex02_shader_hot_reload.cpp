@@ -1,34 +1,16 @@
 #include "vk_engine.h"
 #include <vulkan/vulkan.h>
 #include <imgui.h>
-#include <fstream>
+#include <algorithm>
+#include <filesystem>
+#include <span>
 #include <stdexcept>
 #include <string>
+#include <utility>
 #include <vector>
 #ifndef VK_CHECK
 #define VK_CHECK(x) do{VkResult r=(x);if(r!=VK_SUCCESS)throw std::runtime_error("vk: "+std::to_string(r));}while(false)
 #endif
-static std::vector<char> load_spv(const std::string& p)
-{
-    std::ifstream f(p, std::ios::binary | std::ios::ate);
-    if (!f)throw std::runtime_error("open " + p);
-    size_t s = (size_t)f.tellg();
-    f.seekg(0);
-    std::vector<char> d(s);
-    f.read(d.data(), s);
-    return d;
-}
-
-static VkShaderModule mk(VkDevice d, const std::vector<char>& b)
-{
-    VkShaderModuleCreateInfo ci{VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO};
-    ci.codeSize = b.size();
-    ci.pCode = reinterpret_cast<const uint32_t*>(b.data());
-    VkShaderModule m{};
-    VK_CHECK(vkCreateShaderModule(d,&ci,nullptr,&m));
-    return m;
-}
-
 class R : public IRenderer
 {
 public:
@@ -44,19 +26,58 @@ public:
     void initialize(const EngineContext& e, const RendererCaps& c, const FrameContext&) override
     {
         dev = e.device;
+        cache = e.pipeline_cache;
+        shaders = e.shaders;
         fmt = c.color_attachments.front().format;
-        build_pipeline();
+        VkPipelineLayoutCreateInfo lci{VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO};
+        VK_CHECK(vkCreatePipelineLayout(dev,&lci,nullptr,&layout));
+        const vv::CompiledShader vs = shaders->compile_now({.path = SHADER_SOURCE_DIR "/triangle.vert"});
+        const vv::CompiledShader fs = shaders->compile_now({.path = SHADER_SOURCE_DIR "/triangle.frag"});
+        if (!vs.module || !fs.module) throw std::runtime_error("triangle shaders: " + vs.log + fs.log);
+        pipe = build_pipeline(vs.module, fs.module);
+        shaders->release(vs.module);
+        shaders->release(fs.module);
     }
 
-    void destroy(const EngineContext& e, const RendererCaps&) override { cleanup_pipeline(e.device); }
+    void destroy(const EngineContext& e, const RendererCaps&) override
+    {
+        if (pending_vs.valid()) { shaders->release(pending_vs.get().module); shaders->release(pending_fs.get().module); }
+        pending_vs = {};
+        pending_fs = {};
+        if (pipe)vkDestroyPipeline(e.device, pipe, nullptr);
+        if (layout)vkDestroyPipelineLayout(e.device, layout, nullptr);
+        pipe = VK_NULL_HANDLE;
+        layout = VK_NULL_HANDLE;
+    }
 
-    void reload_assets(const EngineContext& e) override
+    // Compiles on the shader service's workers; the current pipeline keeps drawing until update() swaps the new one in.
+    // Only edits to this pipeline's stages rebuild it; the unchanged stage comes straight from the SPIR-V cache.
+    using IRenderer::reload_assets;
+    void reload_assets(const EngineContext&, std::span<const std::filesystem::path> changed) override
     {
-        cleanup_pipeline(e.device);
-        try { build_pipeline(); }
-        catch (...)
-        {
-        }
+        const bool ours = std::ranges::any_of(changed, [](const std::filesystem::path& p) {
+            return p.filename() == "triangle.vert" || p.filename() == "triangle.frag" || std::filesystem::is_directory(p); // directory: the watcher lost track of individual files
+        });
+        if (!ours) return;
+        if (pending_vs.valid()) { dirty = true; return; } // the compiles in flight hold module references: recompile once they land
+        compile_stages();
+    }
+
+    void update(const EngineContext& e, const FrameContext&) override
+    {
+        if (!pending_vs.valid() || !vv::ShaderService::ready(pending_vs) || !vv::ShaderService::ready(pending_fs)) return;
+        const vv::CompiledShader vs = pending_vs.get(), fs = pending_fs.get();
+        pending_vs = {};
+        pending_fs = {};
+        if (std::exchange(dirty, false)) { shaders->release(vs.module); shaders->release(fs.module); compile_stages(); return; } // saved again meanwhile
+        status = vs.log + fs.log;
+        if (!vs.module || !fs.module) { shaders->release(vs.module); shaders->release(fs.module); return; } // keep drawing with the last good pipeline
+        VkPipeline next = build_pipeline(vs.module, fs.module);
+        shaders->release(vs.module); // the pipeline no longer needs them: an edited stage's old module is destroyed here
+        shaders->release(fs.module);
+        if (pipe) e.retire_queue->retire(pipe, e.retire_queue->frame_value());
+        pipe = next;
+        reloads++;
     }
 
     void record_graphics(VkCommandBuffer cmd, const EngineContext&, const FrameContext& f) override
@@ -116,14 +137,21 @@ public:
             ImGui::TextUnformatted("Shader hot-reload controls");
             ImGui::Separator();
             ImGui::TextUnformatted("Modify shaders in examples/shaders and observe reload.");
+            ImGui::Text("Reloads: %u%s", reloads, pending_vs.valid() ? " (compiling)" : "");
+            if (!status.empty()) ImGui::TextWrapped("%s", status.c_str());
         });
     }
 
 private:
-    void build_pipeline()
+    void compile_stages()
+    {
+        pending_vs = shaders->compile({.path = SHADER_SOURCE_DIR "/triangle.vert"});
+        pending_fs = shaders->compile({.path = SHADER_SOURCE_DIR "/triangle.frag"});
+    }
+
+    // Modules belong to the shader service; the caller release()s its references once the pipeline exists
+    VkPipeline build_pipeline(VkShaderModule vs, VkShaderModule fs)
     {
-        std::string dir(SHADER_OUTPUT_DIR);
-        VkShaderModule vs = mk(dev, load_spv(dir + "/triangle.vert.spv")), fs = mk(dev, load_spv(dir + "/triangle.frag.spv"));
         VkPipelineShaderStageCreateInfo st[2]{};
         st[0].sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
         st[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
@@ -132,8 +160,6 @@ private:
         st[1] = st[0];
         st[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
         st[1].module = fs;
-        VkPipelineLayoutCreateInfo lci{VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO};
-        VK_CHECK(vkCreatePipelineLayout(dev,&lci,nullptr,&layout));
         VkPipelineVertexInputStateCreateInfo vi{VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO};
         VkPipelineInputAssemblyStateCreateInfo ia{VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO};
         ia.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
@@ -171,20 +197,18 @@ private:
         pci.pColorBlendState = &cb;
         pci.pDynamicState = &ds;
         pci.layout = layout;
-        VK_CHECK(vkCreateGraphicsPipelines(dev,VK_NULL_HANDLE,1,&pci,nullptr,&pipe));
-        vkDestroyShaderModule(dev, vs, nullptr);
-        vkDestroyShaderModule(dev, fs, nullptr);
-    }
-
-    void cleanup_pipeline(VkDevice d)
-    {
-        if (pipe)vkDestroyPipeline(d, pipe, nullptr);
-        if (layout)vkDestroyPipelineLayout(d, layout, nullptr);
-        pipe = VK_NULL_HANDLE;
-        layout = VK_NULL_HANDLE;
+        VkPipeline p{};
+        VK_CHECK(cache->create(pci,&p)); // reloads of unchanged shaders hit the cache
+        return p;
     }
 
     VkDevice dev{};
+    vv::PipelineCache* cache{};
+    vv::ShaderService* shaders{};
+    vv::ShaderFuture pending_vs{}, pending_fs{};
+    bool dirty{false}; // a batch arrived while pending_* were compiling
+    std::string status{};
+    uint32_t reloads{0};
     VkFormat fmt{};
     VkPipelineLayout layout{};
     VkPipeline pipe{};
@@ -198,7 +222,7 @@ int main()
         e.configure_window(1280, 720, "ex02_shader_hot_reload");
         e.set_renderer(std::make_unique<R>());
 #ifdef VV_ENABLE_HOTRELOAD
-        e.add_hot_reload_watch_path(std::string(SHADER_SOURCE_DIR));e.add_hot_reload_watch_path(std::string(SHADER_OUTPUT_DIR));
+        e.add_hot_reload_watch_path(std::string(SHADER_SOURCE_DIR));
 #endif
         e.init();
         e.run();
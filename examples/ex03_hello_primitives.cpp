@@ -96,7 +96,7 @@ public:
             pci.pDynamicState = &ds;
             pci.layout = layout;
             VkPipeline p{};
-            VK_CHECK(vkCreateGraphicsPipelines(dev,VK_NULL_HANDLE,1,&pci,nullptr,&p));
+            VK_CHECK(e.pipeline_cache->create(pci,&p));
             return p;
         };
         pipe_tri = makePipe(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST);
@@ -97,7 +97,7 @@ public:
         pci.pColorBlendState = &cb;
         pci.pDynamicState = &ds;
         pci.layout = layout;
-        VK_CHECK(vkCreateGraphicsPipelines(dev,VK_NULL_HANDLE,1,&pci,nullptr,&pipe));
+        VK_CHECK(e.pipeline_cache->create(pci,&pipe));
         vkDestroyShaderModule(dev, vs, nullptr);
         vkDestroyShaderModule(dev, fs, nullptr);
     }
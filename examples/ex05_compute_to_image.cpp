@@ -38,70 +38,51 @@ public:
     void initialize(const EngineContext& e, const RendererCaps&, const FrameContext&) override
     {
         dev = e.device;
-        alloc = e.descriptorAllocator;
+        heap = e.bindless;
+        if (!heap) throw std::runtime_error("ex05 needs the bindless heap (RendererCaps::descriptor_indexing)");
         std::string d(SHADER_OUTPUT_DIR);
         auto spv = rd(d + "/comp_noise.comp.spv");
         VkShaderModuleCreateInfo sci{VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO};
         sci.codeSize = spv.size();
         sci.pCode = reinterpret_cast<const uint32_t*>(spv.data());
         VK_CHECK(vkCreateShaderModule(dev,&sci,nullptr,&cs));
-        VkDescriptorSetLayoutBinding b{.binding = 0, .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, .descriptorCount = 1, .stageFlags = VK_SHADER_STAGE_COMPUTE_BIT};
-        VkDescriptorSetLayoutCreateInfo dl{VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO};
-        dl.bindingCount = 1;
-        dl.pBindings = &b;
-        VK_CHECK(vkCreateDescriptorSetLayout(dev,&dl,nullptr,&dsl));
-        VkPushConstantRange pcr{VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(float) * 4};
-        VkPipelineLayoutCreateInfo lci{VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO};
-        lci.setLayoutCount = 1;
-        lci.pSetLayouts = &dsl;
-        lci.pushConstantRangeCount = 1;
-        lci.pPushConstantRanges = &pcr;
-        VK_CHECK(vkCreatePipelineLayout(dev,&lci,nullptr,&layout));
         VkComputePipelineCreateInfo ci{VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO};
         VkPipelineShaderStageCreateInfo st{VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO};
         st.stage = VK_SHADER_STAGE_COMPUTE_BIT;
         st.module = cs;
         st.pName = "main";
         ci.stage = st;
-        ci.layout = layout;
-        VK_CHECK(vkCreateComputePipelines(dev,VK_NULL_HANDLE,1,&ci,nullptr,&pipe));
-        ds = alloc->allocate(dev, dsl);
+        ci.layout = heap->pipeline_layout(); // set 0 = bindless tables, push constants carry the image index
+        VK_CHECK(e.pipeline_cache->create(ci,&pipe));
     }
 
     void destroy(const EngineContext& e, const RendererCaps&) override
     {
         if (pipe)vkDestroyPipeline(e.device, pipe, nullptr);
-        if (layout)vkDestroyPipelineLayout(e.device, layout, nullptr);
-        if (dsl)vkDestroyDescriptorSetLayout(e.device, dsl, nullptr);
         if (cs)vkDestroyShaderModule(e.device, cs, nullptr);
     }
 
-    void record_compute(VkCommandBuffer cmd, const EngineContext&, const FrameContext& f) override
+    // Registered once per attachment lifetime; the old index is recycled after the frames still reading it
+    void on_swapchain_ready(const EngineContext& e, const FrameContext& f) override
     {
         if (f.color_attachments.empty())return;
-        const auto& t = f.color_attachments.front();
-        VkDescriptorImageInfo ii{.sampler = VK_NULL_HANDLE, .imageView = t.view, .imageLayout = VK_IMAGE_LAYOUT_GENERAL};
-        VkWriteDescriptorSet w{VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET};
-        w.dstSet = ds;
-        w.dstBinding = 0;
-        w.descriptorCount = 1;
-        w.descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
-        w.pImageInfo = &ii;
-        vkUpdateDescriptorSets(dev, 1, &w, 0, nullptr);
-        VkImageMemoryBarrier2 toGen{
-            .sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2, .srcStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, .srcAccessMask = VK_ACCESS_2_MEMORY_WRITE_BIT, .dstStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT,
-            .dstAccessMask = VK_ACCESS_2_SHADER_WRITE_BIT, .oldLayout = VK_IMAGE_LAYOUT_GENERAL, .newLayout = VK_IMAGE_LAYOUT_GENERAL, .image = t.image, .subresourceRange = {t.aspect, 0, 1, 0, 1}
-        };
-        VkDependencyInfo dep{VK_STRUCTURE_TYPE_DEPENDENCY_INFO};
-        dep.imageMemoryBarrierCount = 1;
-        dep.pImageMemoryBarriers = &toGen;
-        vkCmdPipelineBarrier2(cmd, &dep);
-        vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, pipe);
-        vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, layout, 0, 1, &ds, 0, nullptr);
-        float pc[4]{float(f.time_sec), 0, 0, 0};
-        vkCmdPushConstants(cmd, layout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(pc), pc);
-        uint32_t gx = (f.extent.width + 7) / 8, gy = (f.extent.height + 7) / 8;
-        vkCmdDispatch(cmd, gx, gy, 1);
+        heap->release(vv::BindlessHeap::Table::StorageImage, out_index, e.retire_queue->frame_value());
+        out_index = heap->add_storage_image(f.color_attachments.front().view);
+    }
+
+    void build_render_graph(vv::RenderGraph& g, const EngineContext&, const FrameContext& f) override
+    {
+        const auto out = g.find("comp_out");
+        if (out == vv::RenderGraph::invalid || out_index == vv::BindlessHeap::invalid)return;
+        // The graph moves comp_out to GENERAL before the dispatch and to TRANSFER_SRC for the engine blit
+        g.add_pass("noise", [this, time = float(f.time_sec), extent = f.extent](VkCommandBuffer cmd) {
+            vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, pipe);
+            heap->bind(cmd, VK_PIPELINE_BIND_POINT_COMPUTE);
+            struct { float time; uint32_t image; } pc{time, out_index};
+            vkCmdPushConstants(cmd, heap->pipeline_layout(), VK_SHADER_STAGE_ALL, 0, sizeof(pc), &pc);
+            uint32_t gx = (extent.width + 7) / 8, gy = (extent.height + 7) / 8;
+            vkCmdDispatch(cmd, gx, gy, 1);
+        }).use(out, vv::use::storage_write_compute);
     }
 
     void record_graphics(VkCommandBuffer, const EngineContext&, const FrameContext&) override
@@ -114,17 +95,16 @@ public:
         if (!host) return;
         host->add_tab("compute_to_image", [this,&f]{
             ImGui::Text("Extent %u x %u", f.extent.width, f.extent.height);
+            ImGui::Text("Bindless storage image index %u", out_index);
         });
     }
 
 private:
     VkDevice dev{};
-    DescriptorAllocator* alloc{};
+    vv::BindlessHeap* heap{};
     VkShaderModule cs{};
-    VkDescriptorSetLayout dsl{};
-    VkPipelineLayout layout{};
     VkPipeline pipe{};
-    VkDescriptorSet ds{};
+    uint32_t out_index{vv::BindlessHeap::invalid};
 };
 
 int main()
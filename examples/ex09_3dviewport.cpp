@@ -81,7 +81,7 @@ public:
         ri.colorAttachmentCount = 1; ri.pColorAttachmentFormats = &color_fmt_; ri.depthAttachmentFormat = depth_fmt_;
         VkGraphicsPipelineCreateInfo pci{VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO};
         pci.pNext = &ri; pci.stageCount = 2; pci.pStages = st; pci.pVertexInputState = &vi; pci.pInputAssemblyState = &ia; pci.pViewportState = &vp; pci.pRasterizationState = &rs; pci.pMultisampleState = &ms; pci.pDepthStencilState = &ds; pci.pColorBlendState = &cb; pci.pDynamicState = &dsi; pci.layout = layout_;
-        VK_CHECK(vkCreateGraphicsPipelines(dev_, VK_NULL_HANDLE, 1, &pci, nullptr, &pipe_));
+        VK_CHECK(e.pipeline_cache->create(pci, &pipe_));
         vkDestroyShaderModule(dev_, vs, nullptr); vkDestroyShaderModule(dev_, fs, nullptr);
 
         // initial camera
@@ -1,5 +1,6 @@
 #include "vk_engine.h"
 #include "vv_camera.h"
+#include "vv_profiler.h"
 #include <imgui.h>
 #include <vulkan/vulkan.h>
 #include <vk_mem_alloc.h>
@@ -9,6 +10,7 @@
 #include <cmath>
 #include <cstring>
 #include <algorithm>
+#include <chrono>
 #include <stdexcept>
 #include <fstream>
 
@@ -55,16 +57,19 @@ public:
         c.color_attachments = { AttachmentRequest{ .name = "color", .format = VK_FORMAT_B8G8R8A8_UNORM } }; c.presentation_attachment = "color";
         c.depth_attachment = AttachmentRequest{ .name = "depth", .format = c.preferred_depth_format, .usage = VK_IMAGE_USAGE_DEPTH_STENCIL_ATTACHMENT_BIT, .samples = VK_SAMPLE_COUNT_1_BIT, .aspect = VK_IMAGE_ASPECT_DEPTH_BIT, .initial_layout = VK_IMAGE_LAYOUT_UNDEFINED };
         c.uses_depth = VK_TRUE;
+        c.color_samples = VK_SAMPLE_COUNT_4_BIT; // lines and points: the blit presents the engine's "color_resolve"
+        c.allow_async_transfer = true; // index buffers go to device-local memory through eng.uploads
     }
 
-    void initialize(const EngineContext& e, const RendererCaps&, const FrameContext&) override {
-        eng_ = e; dev_ = e.device; color_fmt_ = VK_FORMAT_B8G8R8A8_UNORM; depth_fmt_ = e.device? VK_FORMAT_D32_SFLOAT : VK_FORMAT_D32_SFLOAT;
+    void initialize(const EngineContext& e, const RendererCaps& caps, const FrameContext&) override {
+        eng_ = e; dev_ = e.device; samples_ = caps.color_samples; color_fmt_ = VK_FORMAT_B8G8R8A8_UNORM; depth_fmt_ = e.device? VK_FORMAT_D32_SFLOAT : VK_FORMAT_D32_SFLOAT;
         // build scene
         cloth_.build_grid(params_.grid_x, params_.grid_y, params_.spacing);
         apply_compliance_(); recenter_cloth_at_origin_(); build_gpu_buffers_(); build_pipelines_();
         cam_.set_mode(vv::CameraMode::Orbit); auto s = cam_.state(); s.target={0,0,0}; s.distance=2.0f; s.pitch_deg=15.0f; s.yaw_deg=-120.0f; s.znear=0.01f; s.zfar=100.0f; cam_.set_state(s);
         update_scene_bounds_(); cam_.frame_scene(1.12f);
         sim_accum_ = 0.0;
+        if (e.metrics) { metric_sim_ms_ = e.metrics->gauge("cloth_sim_ms", "ms", true); metric_steps_ = e.metrics->counter("cloth_steps"); } // Metrics tab + HUD
     }
 
     void destroy(const EngineContext& e, const RendererCaps&) override {
@@ -73,7 +78,9 @@ public:
 
     void update(const EngineContext&, const FrameContext& f) override {
         cam_.update(f.dt_sec, (int)f.extent.width, (int)f.extent.height); vp_w_=(int)f.extent.width; vp_h_=(int)f.extent.height;
-        if (params_.simulate) { sim_accum_ += f.dt_sec; double fixed=std::clamp<double>(params_.fixed_dt, 1.0/600.0, 1.0/30.0); int maxSteps=4; while(sim_accum_>=fixed && maxSteps--){ step_sim_((float)fixed); sim_accum_-=fixed; } }
+        const auto t0 = std::chrono::steady_clock::now();
+        if (params_.simulate) { sim_accum_ += f.dt_sec; double fixed=std::clamp<double>(params_.fixed_dt, 1.0/600.0, 1.0/30.0); int maxSteps=4; while(sim_accum_>=fixed && maxSteps--){ step_sim_((float)fixed); sim_accum_-=fixed; if (eng_.metrics) eng_.metrics->add(metric_steps_); } }
+        if (eng_.metrics) eng_.metrics->set(metric_sim_ms_, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count());
         // upload positions
         if (pos_buf_.mapped && !cloth_.x.empty()) { std::memcpy(pos_buf_.mapped, cloth_.x.data(), cloth_.x.size()*sizeof(vv::float3)); }
     }
@@ -90,18 +97,22 @@ public:
             VkImageMemoryBarrier2 b{VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2}; b.srcStageMask=src; b.dstStageMask=dst; b.srcAccessMask=sa; b.dstAccessMask=da; b.oldLayout=oldL; b.newLayout=newL; b.image=img; b.subresourceRange={aspect,0,1,0,1}; VkDependencyInfo di{VK_STRUCTURE_TYPE_DEPENDENCY_INFO}; di.imageMemoryBarrierCount=1; di.pImageMemoryBarriers=&b; vkCmdPipelineBarrier2(cmd,&di);
         };
         barrier_img(color.image, color.aspect, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_2_MEMORY_WRITE_BIT, VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT);
+        if (color.resolve_image) barrier_img(color.resolve_image, color.aspect, VK_IMAGE_LAYOUT_GENERAL, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_2_MEMORY_READ_BIT|VK_ACCESS_2_MEMORY_WRITE_BIT, VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT);
         if (depth) barrier_img(depth->image, depth->aspect, VK_IMAGE_LAYOUT_UNDEFINED, VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT, 0, VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT);
         VkClearValue clear_color{.color={{0.05f,0.06f,0.07f,1.0f}}}; VkClearValue clear_depth{.depthStencil={1.0f,0}};
-        VkRenderingAttachmentInfo ca{VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO}; ca.imageView=color.view; ca.imageLayout=VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL; ca.loadOp=VK_ATTACHMENT_LOAD_OP_CLEAR; ca.storeOp=VK_ATTACHMENT_STORE_OP_STORE; ca.clearValue=clear_color;
+        // Multisampled: averaged into color_resolve at vkCmdEndRendering, the samples themselves are not kept
+        const VkRenderingAttachmentInfo ca = color.rendering_info(VK_ATTACHMENT_LOAD_OP_CLEAR, clear_color, color.resolve_view ? VK_ATTACHMENT_STORE_OP_DONT_CARE : VK_ATTACHMENT_STORE_OP_STORE);
         VkRenderingAttachmentInfo da{}; if (depth){ da.sType=VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO; da.imageView=depth->view; da.imageLayout=VK_IMAGE_LAYOUT_DEPTH_ATTACHMENT_OPTIMAL; da.loadOp=VK_ATTACHMENT_LOAD_OP_CLEAR; da.storeOp=VK_ATTACHMENT_STORE_OP_STORE; da.clearValue=clear_depth; }
         VkRenderingInfo ri{VK_STRUCTURE_TYPE_RENDERING_INFO}; ri.renderArea={{0,0}, f.extent}; ri.layerCount=1; ri.colorAttachmentCount=1; ri.pColorAttachments=&ca; ri.pDepthAttachment = depth? &da : nullptr; vkCmdBeginRendering(cmd,&ri);
         VkViewport vp{}; vp.x=0; vp.y=0; vp.width=(float)f.extent.width; vp.height=(float)f.extent.height; vp.minDepth=0; vp.maxDepth=1; VkRect2D sc{{0,0}, f.extent}; vkCmdSetViewport(cmd,0,1,&vp); vkCmdSetScissor(cmd,0,1,&sc);
         const vv::float4x4 V = cam_.view_matrix(); const vv::float4x4 P = cam_.proj_matrix(); vv::float4x4 MVP = vv::mul(P, V);
-        struct PC { float mvp[16]; float color[4]; float pointSize; float _pad[3]; } pc{};
+        struct PC { float mvp[16]; float color[4]; float pointSize; float _pad; VkDeviceAddress positions; } pc{}; // 96 bytes, matches cloth.vert
         std::memcpy(pc.mvp, MVP.m.data(), sizeof(pc.mvp));
-        VkDeviceSize offs = 0; vkCmdBindVertexBuffers(cmd, 0, 1, &pos_buf_.buf, &offs);
+        pc.positions = pos_buf_.addr;
         // Draw mesh (triangles)
-        if (params_.show_mesh){
+        const bool indices_ready = !eng_.uploads || eng_.uploads->ready(idx_ticket_); // rebuilt index buffers arrive a frame or two later
+        if (params_.show_mesh && indices_ready){
+            vv::gpu_zone zone(cmd, "mesh", vv::ZoneFlags::PipelineStats);
             pc.color[0]=0.55f; pc.color[1]=0.7f; pc.color[2]=0.95f; pc.color[3]=1.0f; pc.pointSize = params_.point_size;
             vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pipe_tri_.pipeline);
             vkCmdPushConstants(cmd, pipe_tri_.layout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(PC), &pc);
@@ -109,7 +120,8 @@ public:
             vkCmdDrawIndexed(cmd, tri_count_, 1, 0, 0, 0);
         }
         // Draw constraints (lines)
-        if (params_.show_constraints){
+        if (params_.show_constraints && indices_ready){
+            vv::gpu_zone zone(cmd, "constraints", vv::ZoneFlags::PipelineStats);
             pc.pointSize = params_.point_size;
             vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pipe_line_.pipeline);
             // struct
@@ -124,6 +136,7 @@ public:
         }
         // Draw vertices (points)
         if (params_.show_vertices){
+            vv::gpu_zone zone(cmd, "points", vv::ZoneFlags::PipelineStats);
             pc.color[0]=1.0f; pc.color[1]=1.0f; pc.color[2]=1.0f; pc.color[3]=1.0f; pc.pointSize = params_.point_size;
             vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, pipe_point_.pipeline);
             vkCmdPushConstants(cmd, pipe_point_.layout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(PC), &pc);
@@ -131,6 +144,7 @@ public:
         }
         vkCmdEndRendering(cmd);
         barrier_img(color.image, color.aspect, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_GENERAL, VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT, VK_ACCESS_2_MEMORY_READ_BIT|VK_ACCESS_2_MEMORY_WRITE_BIT);
+        if (color.resolve_image) barrier_img(color.resolve_image, color.aspect, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL, VK_IMAGE_LAYOUT_GENERAL, VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT, VK_ACCESS_2_MEMORY_READ_BIT|VK_ACCESS_2_MEMORY_WRITE_BIT);
     }
 
     void on_imgui(const EngineContext& eng, const FrameContext&) override {
@@ -164,16 +178,17 @@ private:
     struct Params { bool simulate{false}; float fixed_dt{1.0f/120.0f}; int substeps{2}; int iterations{10}; float damping{0.02f}; vv::float3 gravity{0.0f,-9.8f,0.0f}; int grid_x{20}, grid_y{20}; float spacing{0.06f}; float comp_struct{0.0f}; float comp_shear{0.0f}; float comp_bend{0.005f}; bool show_mesh{true}; bool show_vertices{true}; bool show_constraints{true}; float point_size{5.0f}; } params_{};
 
     vv::CameraService cam_{}; ClothXPBD cloth_{}; double sim_accum_{0.0}; int vp_w_{0}, vp_h_{0};
+    vv::MetricsRegistry::MetricId metric_sim_ms_{vv::MetricsRegistry::invalid}, metric_steps_{vv::MetricsRegistry::invalid};
 
-    struct GpuBuffer { VkBuffer buf{}; VmaAllocation alloc{}; void* mapped{}; size_t size{}; };
-    GpuBuffer pos_buf_{}; // vec3 positions
-    GpuBuffer tri_idx_{}; uint32_t tri_count_{0};
+    struct GpuBuffer { VkBuffer buf{}; VmaAllocation alloc{}; void* mapped{}; size_t size{}; bool vma_mapped{}; VkDeviceAddress addr{}; }; // vma_mapped: persistently mapped at creation (uploads / device buffers), not vmaMapMemory'd
+    GpuBuffer pos_buf_{}; // vec3 positions, pulled by address in cloth.vert
+    GpuBuffer tri_idx_{}; uint32_t tri_count_{0}; vv::UploadService::Ticket idx_ticket_{0};
     GpuBuffer line_struct_{}; uint32_t line_struct_count_{0};
     GpuBuffer line_shear_{};  uint32_t line_shear_count_{0};
     GpuBuffer line_bend_{};   uint32_t line_bend_count_{0};
 
     struct Pipeline { VkPipeline pipeline{}; VkPipelineLayout layout{}; };
-    Pipeline pipe_tri_{}, pipe_line_{}, pipe_point_{}; VkFormat color_fmt_{VK_FORMAT_B8G8R8A8_UNORM}; VkFormat depth_fmt_{VK_FORMAT_D32_SFLOAT}; VkDevice dev_{VK_NULL_HANDLE}; EngineContext eng_{};
+    Pipeline pipe_tri_{}, pipe_line_{}, pipe_point_{}; VkFormat color_fmt_{VK_FORMAT_B8G8R8A8_UNORM}; VkFormat depth_fmt_{VK_FORMAT_D32_SFLOAT}; VkSampleCountFlagBits samples_{VK_SAMPLE_COUNT_1_BIT}; VkDevice dev_{VK_NULL_HANDLE}; EngineContext eng_{};
 
     void apply_compliance_(){ for (auto& e : cloth_.edges){ if (e.type==ClothXPBD::Edge::Structural) e.compliance = params_.comp_struct; else if (e.type==ClothXPBD::Edge::Shear) e.compliance = params_.comp_shear; else e.compliance = params_.comp_bend; } }
 
@@ -192,12 +207,26 @@ private:
         VK_CHECK(vmaCreateBuffer(eng_.allocator, &bi, &ai, &out.buf, &out.alloc, nullptr)); out.size=(size_t)sz; out.mapped=nullptr;
         if (mapped) { vmaMapMemory(eng_.allocator, out.alloc, &out.mapped); }
     }
-    void destroy_buffer_(GpuBuffer& b){ if (b.mapped) { vmaUnmapMemory(eng_.allocator, b.alloc); b.mapped=nullptr; } if (b.buf) vmaDestroyBuffer(eng_.allocator, b.buf, b.alloc); b = {}; }
+    void destroy_buffer_(GpuBuffer& b){ if (b.mapped && !b.vma_mapped) { vmaUnmapMemory(eng_.allocator, b.alloc); b.mapped=nullptr; } if (b.buf) eng_.retire_queue->retire(b.buf, b.alloc, eng_.retire_queue->frame_value()); b = {}; } // in-flight frames may still read it
+
+    // Static data: device-local through the upload service (staged on the transfer queue, or written in place on ReBAR).
+    // The old buffer is retired, never overwritten, so frames in flight keep drawing with it.
+    void upload_indices_(const std::vector<uint32_t>& data, GpuBuffer& dst){
+        const VkDeviceSize bytes = data.size()*sizeof(uint32_t);
+        destroy_buffer_(dst); if (bytes == 0) return;
+        if (!eng_.uploads) { create_buffer_(bytes, VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VMA_MEMORY_USAGE_AUTO, true, dst); std::memcpy(dst.mapped, data.data(), bytes); return; }
+        const vv::UploadService::Buffer b = eng_.uploads->create_buffer(bytes, VK_BUFFER_USAGE_INDEX_BUFFER_BIT);
+        dst = GpuBuffer{b.buffer, b.allocation, b.mapped, (size_t)bytes, true, 0};
+        idx_ticket_ = std::max(idx_ticket_, eng_.uploads->upload(b, 0, data.data(), bytes));
+    }
 
     void build_gpu_buffers_(){
-        // positions
-        create_buffer_(cloth_.x.size()*sizeof(vv::float3), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, VMA_MEMORY_USAGE_AUTO, true, pos_buf_);
-        if (pos_buf_.mapped) std::memcpy(pos_buf_.mapped, cloth_.x.data(), cloth_.x.size()*sizeof(vv::float3));
+        // positions: rewritten every frame, so device-local only when the CPU can write it directly (ReBAR/UMA); staging would add
+        // a frame of latency. The vertex shader reads cloth_.x as is through the buffer address: no vertex input, no repacking.
+        const VkDeviceSize pos_bytes = cloth_.x.size()*sizeof(vv::float3);
+        const vv::DeviceBuffer b = vv::create_device_buffer(dev_, eng_.allocator, pos_bytes, 0u, vv::BufferAccess::HostWrite);
+        pos_buf_ = GpuBuffer{b.buffer, b.allocation, b.mapped, (size_t)pos_bytes, true, b.address};
+        if (pos_buf_.mapped) std::memcpy(pos_buf_.mapped, cloth_.x.data(), pos_bytes);
         rebuild_indices_only_();
     }
 
@@ -209,11 +238,9 @@ private:
                 idx.push_back(a); idx.push_back(b); idx.push_back(d); idx.push_back(a); idx.push_back(d); idx.push_back(c);
         }}
         tri_count_ = (uint32_t)idx.size();
-        if (!tri_idx_.buf) create_buffer_(idx.size()*sizeof(uint32_t), VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VMA_MEMORY_USAGE_AUTO, true, tri_idx_);
-        else if (tri_idx_.size < idx.size()*sizeof(uint32_t)) { destroy_buffer_(tri_idx_); create_buffer_(idx.size()*sizeof(uint32_t), VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VMA_MEMORY_USAGE_AUTO, true, tri_idx_); }
-        std::memcpy(tri_idx_.mapped, idx.data(), idx.size()*sizeof(uint32_t));
+        upload_indices_(idx, tri_idx_);
         // lines by type
-        auto fill_lines = [&](ClothXPBD::Edge::Type t, GpuBuffer& dst, uint32_t& count){ std::vector<uint32_t> L; L.reserve(cloth_.edges.size()*2); for(const auto& e: cloth_.edges){ if (e.type!=t) continue; L.push_back((uint32_t)e.i); L.push_back((uint32_t)e.j);} count=(uint32_t)L.size(); if (!dst.buf) create_buffer_(L.size()*sizeof(uint32_t), VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VMA_MEMORY_USAGE_AUTO, true, dst); else if (dst.size < L.size()*sizeof(uint32_t)) { destroy_buffer_(dst); create_buffer_(L.size()*sizeof(uint32_t), VK_BUFFER_USAGE_INDEX_BUFFER_BIT, VMA_MEMORY_USAGE_AUTO, true, dst);} if (!L.empty()) std::memcpy(dst.mapped, L.data(), L.size()*sizeof(uint32_t)); };
+        auto fill_lines = [&](ClothXPBD::Edge::Type t, GpuBuffer& dst, uint32_t& count){ std::vector<uint32_t> L; L.reserve(cloth_.edges.size()*2); for(const auto& e: cloth_.edges){ if (e.type!=t) continue; L.push_back((uint32_t)e.i); L.push_back((uint32_t)e.j);} count=(uint32_t)L.size(); upload_indices_(L, dst); };
         fill_lines(ClothXPBD::Edge::Structural, line_struct_, line_struct_count_);
         fill_lines(ClothXPBD::Edge::Shear,      line_shear_,  line_shear_count_);
         fill_lines(ClothXPBD::Edge::Bend,       line_bend_,   line_bend_count_);
@@ -224,20 +251,18 @@ private:
     void build_pipelines_(){
         std::string dir(SHADER_OUTPUT_DIR); VkShaderModule vs = make_shader(dev_, load_spv(dir+"/cloth.vert.spv")); VkShaderModule fs = make_shader(dev_, load_spv(dir+"/cloth.frag.spv"));
         VkPipelineShaderStageCreateInfo st[2]{}; for(int i=0;i<2;++i) st[i].sType=VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO; st[0].stage=VK_SHADER_STAGE_VERTEX_BIT; st[0].module=vs; st[0].pName="main"; st[1]=st[0]; st[1].stage=VK_SHADER_STAGE_FRAGMENT_BIT; st[1].module=fs;
-        VkVertexInputBindingDescription bind{0, sizeof(vv::float3), VK_VERTEX_INPUT_RATE_VERTEX}; VkVertexInputAttributeDescription attr{0,0,VK_FORMAT_R32G32B32_SFLOAT,0};
-        VkPipelineVertexInputStateCreateInfo vi{VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO}; vi.vertexBindingDescriptionCount=1; vi.pVertexBindingDescriptions=&bind; vi.vertexAttributeDescriptionCount=1; vi.pVertexAttributeDescriptions=&attr;
         VkPipelineViewportStateCreateInfo vp{VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO}; vp.viewportCount=1; vp.scissorCount=1;
         VkPipelineRasterizationStateCreateInfo rs{VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO}; rs.polygonMode=VK_POLYGON_MODE_FILL; rs.cullMode=VK_CULL_MODE_NONE; rs.frontFace=VK_FRONT_FACE_COUNTER_CLOCKWISE; rs.lineWidth=1.0f;
-        VkPipelineMultisampleStateCreateInfo ms{VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO}; ms.rasterizationSamples=VK_SAMPLE_COUNT_1_BIT;
+        VkPipelineMultisampleStateCreateInfo ms{VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO}; ms.rasterizationSamples=samples_;
         VkPipelineDepthStencilStateCreateInfo ds{VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO}; ds.depthTestEnable=VK_TRUE; ds.depthWriteEnable=VK_TRUE; ds.depthCompareOp=VK_COMPARE_OP_LESS;
         VkPipelineColorBlendAttachmentState ba{}; ba.colorWriteMask=0xF; VkPipelineColorBlendStateCreateInfo cb{VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO}; cb.attachmentCount=1; cb.pAttachments=&ba;
         const VkDynamicState dyns[2] = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR }; VkPipelineDynamicStateCreateInfo dsi{VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO}; dsi.dynamicStateCount=2; dsi.pDynamicStates=dyns;
-        // Push constants layout (96 bytes)
+        // Push constants layout (96 bytes); one layout for all three topologies since vertices are pulled by address
         VkPushConstantRange pcr{VK_SHADER_STAGE_VERTEX_BIT, 0, 96}; VkPipelineLayoutCreateInfo lci{VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO}; lci.pushConstantRangeCount=1; lci.pPushConstantRanges=&pcr; VK_CHECK(vkCreatePipelineLayout(dev_, &lci, nullptr, &pipe_tri_.layout));
         // share same layout for others
         pipe_line_.layout = pipe_tri_.layout; pipe_point_.layout = pipe_tri_.layout;
         VkPipelineRenderingCreateInfo rinfo{VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO}; rinfo.colorAttachmentCount=1; rinfo.pColorAttachmentFormats=&color_fmt_; rinfo.depthAttachmentFormat=depth_fmt_;
-        auto make_pipeline = [&](VkPrimitiveTopology topo, Pipeline& out){ VkPipelineInputAssemblyStateCreateInfo ia{VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO}; ia.topology=topo; VkGraphicsPipelineCreateInfo pci{VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO}; pci.pNext=&rinfo; pci.stageCount=2; pci.pStages=st; pci.pVertexInputState=&vi; pci.pInputAssemblyState=&ia; pci.pViewportState=&vp; pci.pRasterizationState=&rs; pci.pMultisampleState=&ms; pci.pDepthStencilState=&ds; pci.pColorBlendState=&cb; pci.pDynamicState=&dsi; pci.layout=pipe_tri_.layout; VK_CHECK(vkCreateGraphicsPipelines(dev_, VK_NULL_HANDLE, 1, &pci, nullptr, &out.pipeline)); };
+        auto make_pipeline = [&](VkPrimitiveTopology topo, Pipeline& out){ VkPipelineInputAssemblyStateCreateInfo ia{VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO}; ia.topology=topo; VkGraphicsPipelineCreateInfo pci{VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO}; pci.pNext=&rinfo; pci.stageCount=2; pci.pStages=st; pci.pVertexInputState=&vv::no_vertex_input; pci.pInputAssemblyState=&ia; pci.pViewportState=&vp; pci.pRasterizationState=&rs; pci.pMultisampleState=&ms; pci.pDepthStencilState=&ds; pci.pColorBlendState=&cb; pci.pDynamicState=&dsi; pci.layout=pipe_tri_.layout; VK_CHECK(eng_.pipeline_cache->create(pci, &out.pipeline)); };
         make_pipeline(VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST, pipe_tri_);
         make_pipeline(VK_PRIMITIVE_TOPOLOGY_LINE_LIST, pipe_line_);
         make_pipeline(VK_PRIMITIVE_TOPOLOGY_POINT_LIST, pipe_point_);
@@ -1,7 +1,10 @@
 #include "vk_engine.h"
 #include "vv_camera.h"
+#include "vv_profiler.h"
 #include <vulkan/vulkan.h>
 #include <vk_mem_alloc.h>
+#include <algorithm>
+#include <array>
 #include <cstdio>
 #include <vector>
 #include <string>
@@ -27,17 +30,19 @@ public:
         c.presentation_mode = PresentationMode::EngineBlit;
         c.color_attachments = { AttachmentRequest{ .name = "color", .format = VK_FORMAT_R8G8B8A8_UNORM, .usage = VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT, .samples = VK_SAMPLE_COUNT_1_BIT, .aspect = VK_IMAGE_ASPECT_COLOR_BIT, .initial_layout = VK_IMAGE_LAYOUT_GENERAL } };
         c.presentation_attachment = "color";
+        c.allow_async_compute = true; // simulation on the compute queue, overlapping the previous frame's raymarch
     }
 
-    void initialize(const EngineContext& e, const RendererCaps&, const FrameContext& f0) override {
+    void initialize(const EngineContext& e, const RendererCaps& caps, const FrameContext& f0) override {
         eng_ = e; dev_ = e.device; alloc_ = e.allocator; da_ = e.descriptorAllocator;
-        create_all(f0.extent);
+        frames_in_flight_ = std::clamp(caps.frames_in_flight, 1u, MAX_FRAMES_IN_FLIGHT);
+        create_all(f0.swapchain_extent);
         create_pipelines_();
         // Setup camera like ex10 (orbit)
         vv::CameraState s = cam_.state(); s.mode = vv::CameraMode::Orbit; s.target = { (float)sim_w_*0.5f, (float)sim_h_*0.5f, (float)sim_d_*0.5f }; s.distance = std::max({sim_w_,sim_h_,sim_d_}) * 1.6f; s.yaw_deg = -35.0f; s.pitch_deg = 25.0f; s.znear=0.01f; s.zfar = std::max({sim_w_,sim_h_,sim_d_})*5.0f; cam_.set_state(s);
         vv::BoundingBox bb{ .min = {0,0,0}, .max = { (float)sim_w_, (float)sim_h_, (float)sim_d_ }, .valid = true }; cam_.set_scene_bounds(bb); cam_.frame_scene(1.08f);
     }
-    void on_swapchain_ready(const EngineContext& e, const FrameContext& f) override { (void)e; recreate_for_extent_(f.extent); vv::BoundingBox bb{ .min = {0,0,0}, .max = { (float)sim_w_, (float)sim_h_, (float)sim_d_ }, .valid = true }; cam_.set_scene_bounds(bb); cam_.frame_scene(1.02f); }
+    void on_swapchain_ready(const EngineContext& e, const FrameContext& f) override { (void)e; recreate_for_extent_(f.swapchain_extent); vv::BoundingBox bb{ .min = {0,0,0}, .max = { (float)sim_w_, (float)sim_h_, (float)sim_d_ }, .valid = true }; cam_.set_scene_bounds(bb); cam_.frame_scene(1.02f); }
     void on_swapchain_destroy(const EngineContext& e) override { (void)e; destroy_images_(); }
 
     void destroy(const EngineContext& e, const RendererCaps&) override {
@@ -61,9 +66,38 @@ public:
         host->add_overlay([this]{ cam_.imgui_draw_mini_axis_gizmo(); });
     }
 
-    void record_compute(VkCommandBuffer cmd, const EngineContext&, const FrameContext& f) override {
+    void get_async_compute_outputs(const EngineContext&, const FrameContext& f, std::vector<AsyncComputeOutput>& out) override {
+        // Each frame slot raymarches its own snapshot while the compute queue already advances the next slot's
+        if (images_ready_) out.push_back(AsyncComputeOutput{ .image = den_out_[slot_(f)].img, .graphics_stages = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, .graphics_access = VK_ACCESS_2_SHADER_STORAGE_READ_BIT });
+    }
+
+    bool record_async_compute(VkCommandBuffer cmd, const EngineContext&, const FrameContext& f) override {
+        if (!images_ready_) return false;
+        simulate_(cmd, f);
+        snapshot_density_(cmd, den_out_[slot_(f)]);
+        return true;
+    }
+
+    void record_compute(VkCommandBuffer cmd, const EngineContext& eng, const FrameContext& f) override {
         if (!images_ready_) return;
+        if (!eng.async_compute) simulate_(cmd, f); // no dedicated compute queue: simulate inline and raymarch the live field
+        raymarch_(cmd, f, eng.async_compute ? den_out_[slot_(f)] : denA_, !eng.async_compute);
+    }
+
+    void record_graphics(VkCommandBuffer, const EngineContext&, const FrameContext&) override {}
+
+private:
+    [[nodiscard]] uint32_t slot_(const FrameContext& f) const { return static_cast<uint32_t>(f.frame_index % frames_in_flight_); }
+
+    static void barrier_img_(VkCommandBuffer cmd, VkImage img, VkImageAspectFlags aspect, VkPipelineStageFlags2 src, VkPipelineStageFlags2 dst, VkAccessFlags2 sa, VkAccessFlags2 da){
+        VkImageMemoryBarrier2 b{VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2};
+        b.srcStageMask=src; b.dstStageMask=dst; b.srcAccessMask=sa; b.dstAccessMask=da;
+        b.oldLayout = VK_IMAGE_LAYOUT_GENERAL; b.newLayout = VK_IMAGE_LAYOUT_GENERAL;
+        b.image=img; b.subresourceRange={aspect,0,1,0,1};
+        VkDependencyInfo di{VK_STRUCTURE_TYPE_DEPENDENCY_INFO}; di.imageMemoryBarrierCount=1; di.pImageMemoryBarriers=&b; vkCmdPipelineBarrier2(cmd, &di);
+    }
 
+    void simulate_(VkCommandBuffer cmd, const FrameContext& f){
         if (!images_initialized_) {
             // One-time transition UNDEFINED->GENERAL and clear resources
             auto barrier_to_general = [&](VkImage img){
@@ -75,6 +109,7 @@ public:
                 VkDependencyInfo di{VK_STRUCTURE_TYPE_DEPENDENCY_INFO}; di.imageMemoryBarrierCount=1; di.pImageMemoryBarriers=&b; vkCmdPipelineBarrier2(cmd, &di);
             };
             barrier_to_general(velA_.img); barrier_to_general(velB_.img); barrier_to_general(denA_.img); barrier_to_general(denB_.img); barrier_to_general(pA_.img); barrier_to_general(pB_.img); barrier_to_general(div_.img);
+            for (uint32_t i = 0; i < frames_in_flight_; ++i) barrier_to_general(den_out_[i].img);
             auto clear0 = [&](VkImage img){ VkClearColorValue z{}; z.float32[0]=0; z.float32[1]=0; z.float32[2]=0; z.float32[3]=0; VkImageSubresourceRange r{VK_IMAGE_ASPECT_COLOR_BIT,0,1,0,1}; vkCmdClearColorImage(cmd, img, VK_IMAGE_LAYOUT_GENERAL, &z, 1, &r); };
             clear0(velA_.img); clear0(velB_.img); clear0(denA_.img); clear0(denB_.img); clear0(pA_.img); clear0(pB_.img); clear0(div_.img);
             images_initialized_ = true; clear_pressure_ = true;
@@ -88,14 +123,6 @@ public:
         const float force = 50.0f;
         uint32_t W = sim_w_, H = sim_h_, D = sim_d_;
 
-        auto barrier_img = [&](VkImage img, VkImageAspectFlags aspect, VkPipelineStageFlags2 src, VkPipelineStageFlags2 dst, VkAccessFlags2 sa, VkAccessFlags2 da){
-            VkImageMemoryBarrier2 b{VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2};
-            b.srcStageMask=src; b.dstStageMask=dst; b.srcAccessMask=sa; b.dstAccessMask=da;
-            b.oldLayout = VK_IMAGE_LAYOUT_GENERAL; b.newLayout = VK_IMAGE_LAYOUT_GENERAL;
-            b.image=img; b.subresourceRange={aspect,0,1,0,1};
-            VkDependencyInfo di{VK_STRUCTURE_TYPE_DEPENDENCY_INFO}; di.imageMemoryBarrierCount=1; di.pImageMemoryBarriers=&b; vkCmdPipelineBarrier2(cmd, &di);
-        };
-
         auto bind_and_push8 = [&](VkPipeline p, VkPipelineLayout layout, VkDescriptorSet ds, float a,float b,float c,float d,float e,float g,float h,float k){
             vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, p);
             vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, layout, 0, 1, &ds, 0, nullptr);
@@ -105,34 +132,35 @@ public:
 
         // Inject source (velocity + density) near bottom-center of volume, upward (+Y)
         {
-            update_ds_inject_();
-            barrier_img(velA_.img, VK_IMAGE_ASPECT_COLOR_BIT, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_MEMORY_READ_BIT|VK_ACCESS_2_MEMORY_WRITE_BIT, VK_ACCESS_2_SHADER_READ_BIT|VK_ACCESS_2_SHADER_WRITE_BIT);
-            barrier_img(velB_.img, VK_IMAGE_ASPECT_COLOR_BIT, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_MEMORY_READ_BIT|VK_ACCESS_2_MEMORY_WRITE_BIT, VK_ACCESS_2_SHADER_READ_BIT|VK_ACCESS_2_SHADER_WRITE_BIT);
-            barrier_img(denA_.img, VK_IMAGE_ASPECT_COLOR_BIT, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_MEMORY_READ_BIT|VK_ACCESS_2_MEMORY_WRITE_BIT, VK_ACCESS_2_SHADER_READ_BIT|VK_ACCESS_2_SHADER_WRITE_BIT);
+            vv::gpu_zone zone(cmd, "inject");
+            const VkDescriptorSet ds_inject = frame_ds_inject_();
+            barrier_img_(cmd, velA_.img, VK_IMAGE_ASPECT_COLOR_BIT, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_MEMORY_READ_BIT|VK_ACCESS_2_MEMORY_WRITE_BIT, VK_ACCESS_2_SHADER_READ_BIT|VK_ACCESS_2_SHADER_WRITE_BIT);
+            barrier_img_(cmd, velB_.img, VK_IMAGE_ASPECT_COLOR_BIT, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_MEMORY_READ_BIT|VK_ACCESS_2_MEMORY_WRITE_BIT, VK_ACCESS_2_SHADER_READ_BIT|VK_ACCESS_2_SHADER_WRITE_BIT);
+            barrier_img_(cmd, denA_.img, VK_IMAGE_ASPECT_COLOR_BIT, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_MEMORY_READ_BIT|VK_ACCESS_2_MEMORY_WRITE_BIT, VK_ACCESS_2_SHADER_READ_BIT|VK_ACCESS_2_SHADER_WRITE_BIT);
             // push constants: dt, force, cx, cy, cz, radius, dirx, diry, dirz
             struct PCInject { float dt, force, cx, cy, cz, radius, dirx, diry, dirz; } pci{ dt, force, (float)(W*0.5f), 6.0f, (float)(D*0.5f), 12.0f, 0.0f, 1.0f, 0.0f };
             vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, p_inject_);
-            vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, pl_inject_, 0, 1, &ds_inject_, 0, nullptr);
+            vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, pl_inject_, 0, 1, &ds_inject, 0, nullptr);
             vkCmdPushConstants(cmd, pl_inject_, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(PCInject), &pci);
             uint32_t gx=(W+7)/8, gy=(H+7)/8, gz=(D+7)/8; vkCmdDispatch(cmd,gx,gy,gz);
         }
 
         // Advect velocity: velA -> velB
         {
-            update_ds_advect_vec_();
-            barrier_img(velA_.img, VK_IMAGE_ASPECT_COLOR_BIT, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_MEMORY_READ_BIT|VK_ACCESS_2_MEMORY_WRITE_BIT, VK_ACCESS_2_SHADER_READ_BIT);
-            barrier_img(velB_.img, VK_IMAGE_ASPECT_COLOR_BIT, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, 0, VK_ACCESS_2_SHADER_WRITE_BIT);
-            bind_and_push8(p_advect_vec_, pl_advect_vec_, ds_advect_vec_, dt, (float)W, (float)H, (float)D, diss_vel, 0,0,0);
+            vv::gpu_zone zone(cmd, "advect velocity");
+            barrier_img_(cmd, velA_.img, VK_IMAGE_ASPECT_COLOR_BIT, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_MEMORY_READ_BIT|VK_ACCESS_2_MEMORY_WRITE_BIT, VK_ACCESS_2_SHADER_READ_BIT);
+            barrier_img_(cmd, velB_.img, VK_IMAGE_ASPECT_COLOR_BIT, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, 0, VK_ACCESS_2_SHADER_WRITE_BIT);
+            bind_and_push8(p_advect_vec_, pl_advect_vec_, frame_ds_advect_vec_(), dt, (float)W, (float)H, (float)D, diss_vel, 0,0,0);
             uint32_t gx=(W+7)/8, gy=(H+7)/8, gz=(D+7)/8; vkCmdDispatch(cmd,gx,gy,gz);
             std::swap(velA_, velB_);
         }
 
         // Project: compute divergence of velA into div_
         {
-            update_ds_divergence_();
-            barrier_img(velA_.img, VK_IMAGE_ASPECT_COLOR_BIT, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_MEMORY_READ_BIT|VK_ACCESS_2_MEMORY_WRITE_BIT, VK_ACCESS_2_SHADER_READ_BIT);
-            barrier_img(div_.img, VK_IMAGE_ASPECT_COLOR_BIT, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, 0, VK_ACCESS_2_SHADER_WRITE_BIT);
-            bind_and_push8(p_divergence_, pl_divergence_, ds_divergence_, 0,(float)W,(float)H,(float)D,0,0,0,0);
+            vv::gpu_zone zone(cmd, "divergence");
+            barrier_img_(cmd, velA_.img, VK_IMAGE_ASPECT_COLOR_BIT, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_MEMORY_READ_BIT|VK_ACCESS_2_MEMORY_WRITE_BIT, VK_ACCESS_2_SHADER_READ_BIT);
+            barrier_img_(cmd, div_.img, VK_IMAGE_ASPECT_COLOR_BIT, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, 0, VK_ACCESS_2_SHADER_WRITE_BIT);
+            bind_and_push8(p_divergence_, pl_divergence_, frame_ds_divergence_(), 0,(float)W,(float)H,(float)D,0,0,0,0);
             uint32_t gx=(W+7)/8, gy=(H+7)/8, gz=(D+7)/8; vkCmdDispatch(cmd,gx,gy,gz);
         }
 
@@ -147,47 +175,59 @@ public:
 
         // Jacobi iterations to solve Poisson: pA <-> pB
         {
-            update_ds_jacobi_();
+            vv::gpu_zone zone(cmd, "jacobi");
             const int iters = 10;
             for(int i=0;i<iters;++i){
-                barrier_img(pA_.img, VK_IMAGE_ASPECT_COLOR_BIT, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_MEMORY_READ_BIT|VK_ACCESS_2_MEMORY_WRITE_BIT, VK_ACCESS_2_SHADER_READ_BIT);
-                barrier_img(div_.img, VK_IMAGE_ASPECT_COLOR_BIT, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_MEMORY_READ_BIT|VK_ACCESS_2_MEMORY_WRITE_BIT, VK_ACCESS_2_SHADER_READ_BIT);
-                barrier_img(pB_.img, VK_IMAGE_ASPECT_COLOR_BIT, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, 0, VK_ACCESS_2_SHADER_WRITE_BIT);
-                bind_and_push8(p_jacobi_, pl_jacobi_, ds_jacobi_, 0,(float)W,(float)H,(float)D,0,0,0,0);
+                barrier_img_(cmd, pA_.img, VK_IMAGE_ASPECT_COLOR_BIT, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_MEMORY_READ_BIT|VK_ACCESS_2_MEMORY_WRITE_BIT, VK_ACCESS_2_SHADER_READ_BIT);
+                barrier_img_(cmd, div_.img, VK_IMAGE_ASPECT_COLOR_BIT, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_MEMORY_READ_BIT|VK_ACCESS_2_MEMORY_WRITE_BIT, VK_ACCESS_2_SHADER_READ_BIT);
+                barrier_img_(cmd, pB_.img, VK_IMAGE_ASPECT_COLOR_BIT, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, 0, VK_ACCESS_2_SHADER_WRITE_BIT);
+                bind_and_push8(p_jacobi_, pl_jacobi_, frame_ds_jacobi_(), 0,(float)W,(float)H,(float)D,0,0,0,0);
                 uint32_t gx=(W+7)/8, gy=(H+7)/8, gz=(D+7)/8; vkCmdDispatch(cmd,gx,gy,gz);
                 std::swap(pA_, pB_);
-                update_ds_jacobi_();
             }
         }
 
         // Subtract gradient: velA - grad(pA) -> velB, then swap
         {
-            update_ds_gradient_();
-            barrier_img(pA_.img, VK_IMAGE_ASPECT_COLOR_BIT, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_MEMORY_READ_BIT|VK_ACCESS_2_MEMORY_WRITE_BIT, VK_ACCESS_2_SHADER_READ_BIT);
-            barrier_img(velA_.img, VK_IMAGE_ASPECT_COLOR_BIT, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_MEMORY_READ_BIT|VK_ACCESS_2_MEMORY_WRITE_BIT, VK_ACCESS_2_SHADER_READ_BIT);
-            barrier_img(velB_.img, VK_IMAGE_ASPECT_COLOR_BIT, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, 0, VK_ACCESS_2_SHADER_WRITE_BIT);
-            bind_and_push8(p_gradient_, pl_gradient_, ds_gradient_, 0,(float)W,(float)H,(float)D,0,0,0,0);
+            vv::gpu_zone zone(cmd, "gradient");
+            barrier_img_(cmd, pA_.img, VK_IMAGE_ASPECT_COLOR_BIT, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_MEMORY_READ_BIT|VK_ACCESS_2_MEMORY_WRITE_BIT, VK_ACCESS_2_SHADER_READ_BIT);
+            barrier_img_(cmd, velA_.img, VK_IMAGE_ASPECT_COLOR_BIT, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_MEMORY_READ_BIT|VK_ACCESS_2_MEMORY_WRITE_BIT, VK_ACCESS_2_SHADER_READ_BIT);
+            barrier_img_(cmd, velB_.img, VK_IMAGE_ASPECT_COLOR_BIT, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, 0, VK_ACCESS_2_SHADER_WRITE_BIT);
+            bind_and_push8(p_gradient_, pl_gradient_, frame_ds_gradient_(), 0,(float)W,(float)H,(float)D,0,0,0,0);
             uint32_t gx=(W+7)/8, gy=(H+7)/8, gz=(D+7)/8; vkCmdDispatch(cmd,gx,gy,gz);
             std::swap(velA_, velB_);
         }
 
         // Advect density: denA -> denB, using velA
         {
-            update_ds_advect_scalar_();
-            barrier_img(velA_.img, VK_IMAGE_ASPECT_COLOR_BIT, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_MEMORY_READ_BIT|VK_ACCESS_2_MEMORY_WRITE_BIT, VK_ACCESS_2_SHADER_READ_BIT);
-            barrier_img(denA_.img, VK_IMAGE_ASPECT_COLOR_BIT, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_MEMORY_READ_BIT|VK_ACCESS_2_MEMORY_WRITE_BIT, VK_ACCESS_2_SHADER_READ_BIT);
-            barrier_img(denB_.img, VK_IMAGE_ASPECT_COLOR_BIT, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, 0, VK_ACCESS_2_SHADER_WRITE_BIT);
-            bind_and_push8(p_advect_scalar_, pl_advect_scalar_, ds_advect_scalar_, dt,(float)W,(float)H,(float)D,diss_den,0,0,0);
+            vv::gpu_zone zone(cmd, "advect density");
+            barrier_img_(cmd, velA_.img, VK_IMAGE_ASPECT_COLOR_BIT, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_MEMORY_READ_BIT|VK_ACCESS_2_MEMORY_WRITE_BIT, VK_ACCESS_2_SHADER_READ_BIT);
+            barrier_img_(cmd, denA_.img, VK_IMAGE_ASPECT_COLOR_BIT, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_MEMORY_READ_BIT|VK_ACCESS_2_MEMORY_WRITE_BIT, VK_ACCESS_2_SHADER_READ_BIT);
+            barrier_img_(cmd, denB_.img, VK_IMAGE_ASPECT_COLOR_BIT, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, 0, VK_ACCESS_2_SHADER_WRITE_BIT);
+            bind_and_push8(p_advect_scalar_, pl_advect_scalar_, frame_ds_advect_scalar_(), dt,(float)W,(float)H,(float)D,diss_den,0,0,0);
             uint32_t gx=(W+7)/8, gy=(H+7)/8, gz=(D+7)/8; vkCmdDispatch(cmd,gx,gy,gz);
             std::swap(denA_, denB_);
         }
+    }
+
+    // Copy of the advected density for graphics; the engine hands it to the graphics queue family afterwards
+    void snapshot_density_(VkCommandBuffer cmd, const Image3D& dst){
+        barrier_img_(cmd, denA_.img, VK_IMAGE_ASPECT_COLOR_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_2_COPY_BIT, VK_ACCESS_2_SHADER_WRITE_BIT, VK_ACCESS_2_TRANSFER_READ_BIT);
+        barrier_img_(cmd, dst.img, VK_IMAGE_ASPECT_COLOR_BIT, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_2_COPY_BIT, 0, VK_ACCESS_2_TRANSFER_WRITE_BIT);
+        VkImageCopy region{}; region.srcSubresource = {VK_IMAGE_ASPECT_COLOR_BIT,0,0,1}; region.dstSubresource = region.srcSubresource; region.extent = dst.extent;
+        vkCmdCopyImage(cmd, denA_.img, VK_IMAGE_LAYOUT_GENERAL, dst.img, VK_IMAGE_LAYOUT_GENERAL, 1, &region);
+    }
 
-        // Render with camera raymarch
-        if (!f.color_attachments.empty()){
+    // Render with camera raymarch
+    void raymarch_(VkCommandBuffer cmd, const FrameContext& f, const Image3D& density, bool barrier_density){
+        if (f.color_attachments.empty()) return;
+        uint32_t W = sim_w_, H = sim_h_, D = sim_d_;
+        {
+            vv::gpu_zone zone(cmd, "raymarch", vv::ZoneFlags::PipelineStats);
             const auto& color = f.color_attachments.front();
-            update_ds_render_(color);
-            barrier_img(color.image, color.aspect, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT|VK_ACCESS_2_MEMORY_READ_BIT|VK_ACCESS_2_MEMORY_WRITE_BIT, VK_ACCESS_2_SHADER_WRITE_BIT);
-            barrier_img(denA_.img, VK_IMAGE_ASPECT_COLOR_BIT, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_MEMORY_READ_BIT|VK_ACCESS_2_MEMORY_WRITE_BIT, VK_ACCESS_2_SHADER_READ_BIT);
+            const VkDescriptorSet ds = frame_ds_render_(color, density);
+            barrier_img_(cmd, color.image, color.aspect, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT|VK_ACCESS_2_MEMORY_READ_BIT|VK_ACCESS_2_MEMORY_WRITE_BIT, VK_ACCESS_2_SHADER_WRITE_BIT);
+            if (barrier_density) barrier_img_(cmd, density.img, VK_IMAGE_ASPECT_COLOR_BIT, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_MEMORY_READ_BIT|VK_ACCESS_2_MEMORY_WRITE_BIT, VK_ACCESS_2_SHADER_READ_BIT);
             // Build camera params
             auto st = cam_.state();
             auto eye = cam_.eye_position();
@@ -205,22 +245,19 @@ public:
                 float camRight[3]; float aspect;
                 float camUp[3]; float steps;
                 float camFwd[3]; float W;
-                float H; float D; float pad0; float pad1;
+                float H; float D; float outW; float outH;
             } pc{};
             pc.camEye[0]=eye.x; pc.camEye[1]=eye.y; pc.camEye[2]=eye.z; pc.tanHalfFovY=tanHalfFovY;
             pc.camRight[0]=right.x; pc.camRight[1]=right.y; pc.camRight[2]=right.z; pc.aspect=aspect;
             pc.camUp[0]=up.x; pc.camUp[1]=up.y; pc.camUp[2]=up.z; pc.steps=(float)std::min<uint32_t>(D, 96);
-            pc.camFwd[0]=fwd.x; pc.camFwd[1]=fwd.y; pc.camFwd[2]=fwd.z; pc.W=(float)W; pc.H=(float)H; pc.D=(float)D; pc.pad0=0; pc.pad1=0;
+            pc.camFwd[0]=fwd.x; pc.camFwd[1]=fwd.y; pc.camFwd[2]=fwd.z; pc.W=(float)W; pc.H=(float)H; pc.D=(float)D; pc.outW=(float)f.extent.width; pc.outH=(float)f.extent.height;
             vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, p_render_);
-            vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, pl_render_, 0, 1, &ds_render_, 0, nullptr);
+            vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, pl_render_, 0, 1, &ds, 0, nullptr);
             vkCmdPushConstants(cmd, pl_render_, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(PCR), &pc);
             uint32_t gx=(f.extent.width+15)/16, gy=(f.extent.height+15)/16; vkCmdDispatch(cmd,gx,gy,1);
         }
     }
 
-    void record_graphics(VkCommandBuffer, const EngineContext&, const FrameContext&) override {}
-
-private:
     EngineContext eng_{}; VkDevice dev_{VK_NULL_HANDLE}; VmaAllocator alloc_{}; DescriptorAllocator* da_{};
     vv::CameraService cam_{};
 
@@ -231,13 +268,14 @@ private:
     Image3D denA_{}, denB_{}; // r32f
     Image3D pA_{}, pB_{};     // r32f
     Image3D div_{};           // r32f
+    std::array<Image3D, MAX_FRAMES_IN_FLIGHT> den_out_{}; // r32f density snapshots handed from the compute queue to the raymarch, one per frame slot
+    uint32_t frames_in_flight_{FRAME_OVERLAP};
 
     // pipelines
     VkShaderModule sm_advect_vec_{}, sm_advect_scalar_{}, sm_divergence_{}, sm_jacobi_{}, sm_gradient_{}, sm_inject_{}, sm_render_{};
     VkDescriptorSetLayout dsl_advect_vec_{}, dsl_advect_scalar_{}, dsl_divergence_{}, dsl_jacobi_{}, dsl_gradient_{}, dsl_inject_{}, dsl_render_{};
     VkPipelineLayout pl_advect_vec_{}, pl_advect_scalar_{}, pl_divergence_{}, pl_jacobi_{}, pl_gradient_{}, pl_inject_{}, pl_render_{};
     VkPipeline p_advect_vec_{}, p_advect_scalar_{}, p_divergence_{}, p_jacobi_{}, p_gradient_{}, p_inject_{}, p_render_{};
-    VkDescriptorSet ds_advect_vec_{}, ds_advect_scalar_{}, ds_divergence_{}, ds_jacobi_{}, ds_gradient_{}, ds_inject_{}, ds_render_{};
 
     void recreate_for_extent_(VkExtent2D e){ destroy_images_(); create_all(e); }
 
@@ -255,13 +293,17 @@ private:
         create_image3D_(sim_w_, sim_h_, sim_d_, VK_FORMAT_R32_SFLOAT, pA_);
         create_image3D_(sim_w_, sim_h_, sim_d_, VK_FORMAT_R32_SFLOAT, pB_);
         create_image3D_(sim_w_, sim_h_, sim_d_, VK_FORMAT_R32_SFLOAT, div_);
+        for (uint32_t i = 0; i < frames_in_flight_; ++i) create_image3D_(sim_w_, sim_h_, sim_d_, VK_FORMAT_R32_SFLOAT, den_out_[i]);
         images_ready_ = true; images_initialized_ = false; clear_pressure_ = true;
     }
 
     void destroy_images_(){
-        auto di=[&](Image3D& t){ if (!t.img) return; if (t.view) vkDestroyImageView(dev_, t.view, nullptr); vmaDestroyImage(alloc_, t.img, t.alloc); t = {}; };
+        // Retired rather than destroyed: resizes do not wait for the frames still simulating on the old grid
+        auto* rq = eng_.retire_queue;
+        auto di=[&](Image3D& t){ if (!t.img) return; rq->retire(t.view, rq->frame_value()); rq->retire(t.img, t.alloc, rq->frame_value()); t = {}; };
         di(velA_); di(velB_);
         di(denA_); di(denB_); di(pA_); di(pB_); di(div_);
+        for (auto& t : den_out_) di(t);
         images_ready_ = false; images_initialized_ = false; clear_pressure_ = true;
     }
 
@@ -275,65 +317,78 @@ private:
         out.extent = {w,h,d}; out.fmt = fmt;
     }
 
-    // Descriptor updates per pass (image3D) matching shader bindings
-    void update_ds_advect_vec_(){
+    // One descriptor set per pass and dispatch, allocated from the frame slot's pools: the engine resets those only after the
+    // slot's previous submission (and the async compute it waited for) completed, so no set is rewritten while in use
+    VkDescriptorSet frame_ds_advect_vec_(){
+        const VkDescriptorSet ds = da_->allocate_frame(dev_, dsl_advect_vec_);
         // advect_vec3_3d: binding 0 srcField (rgba32f), binding 1 dstField (rgba32f)
         VkWriteDescriptorSet w[2]{};
         VkDescriptorImageInfo src{.sampler=VK_NULL_HANDLE,.imageView=velA_.view,.imageLayout=VK_IMAGE_LAYOUT_GENERAL};
         VkDescriptorImageInfo dst{.sampler=VK_NULL_HANDLE,.imageView=velB_.view,.imageLayout=VK_IMAGE_LAYOUT_GENERAL};
-        for(int i=0;i<2;++i){ w[i].sType=VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET; w[i].dstSet=ds_advect_vec_; w[i].descriptorCount=1; w[i].descriptorType=VK_DESCRIPTOR_TYPE_STORAGE_IMAGE; }
+        for(int i=0;i<2;++i){ w[i].sType=VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET; w[i].dstSet=ds; w[i].descriptorCount=1; w[i].descriptorType=VK_DESCRIPTOR_TYPE_STORAGE_IMAGE; }
         w[0].dstBinding=0; w[0].pImageInfo=&src; w[1].dstBinding=1; w[1].pImageInfo=&dst;
         vkUpdateDescriptorSets(dev_,2,w,0,nullptr);
+        return ds;
     }
-    void update_ds_advect_scalar_(){
+    VkDescriptorSet frame_ds_advect_scalar_(){
+        const VkDescriptorSet ds = da_->allocate_frame(dev_, dsl_advect_scalar_);
         // advect_scalar_3d: binding 0 velField (rgba32f), 1 src (r32f), 2 dst (r32f)
         VkWriteDescriptorSet w[3]{};
         VkDescriptorImageInfo v{.sampler=VK_NULL_HANDLE,.imageView=velA_.view,.imageLayout=VK_IMAGE_LAYOUT_GENERAL};
         VkDescriptorImageInfo src{.sampler=VK_NULL_HANDLE,.imageView=denA_.view,.imageLayout=VK_IMAGE_LAYOUT_GENERAL};
         VkDescriptorImageInfo dst{.sampler=VK_NULL_HANDLE,.imageView=denB_.view,.imageLayout=VK_IMAGE_LAYOUT_GENERAL};
-        for(int i=0;i<3;++i){ w[i].sType=VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET; w[i].dstSet=ds_advect_scalar_; w[i].descriptorCount=1; w[i].descriptorType=VK_DESCRIPTOR_TYPE_STORAGE_IMAGE; }
+        for(int i=0;i<3;++i){ w[i].sType=VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET; w[i].dstSet=ds; w[i].descriptorCount=1; w[i].descriptorType=VK_DESCRIPTOR_TYPE_STORAGE_IMAGE; }
         w[0].dstBinding=0; w[0].pImageInfo=&v; w[1].dstBinding=1; w[1].pImageInfo=&src; w[2].dstBinding=2; w[2].pImageInfo=&dst;
         vkUpdateDescriptorSets(dev_,3,w,0,nullptr);
+        return ds;
     }
-    void update_ds_divergence_(){
+    VkDescriptorSet frame_ds_divergence_(){
+        const VkDescriptorSet ds = da_->allocate_frame(dev_, dsl_divergence_);
         // divergence_3d: binding 0 velField (rgba32f), 1 outDiv (r32f)
         VkWriteDescriptorSet w[2]{};
         VkDescriptorImageInfo v{.sampler=VK_NULL_HANDLE,.imageView=velA_.view,.imageLayout=VK_IMAGE_LAYOUT_GENERAL};
         VkDescriptorImageInfo out{.sampler=VK_NULL_HANDLE,.imageView=div_.view,.imageLayout=VK_IMAGE_LAYOUT_GENERAL};
-        for(int i=0;i<2;++i){ w[i].sType=VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET; w[i].dstSet=ds_divergence_; w[i].descriptorCount=1; w[i].descriptorType=VK_DESCRIPTOR_TYPE_STORAGE_IMAGE; }
+        for(int i=0;i<2;++i){ w[i].sType=VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET; w[i].dstSet=ds; w[i].descriptorCount=1; w[i].descriptorType=VK_DESCRIPTOR_TYPE_STORAGE_IMAGE; }
         w[0].dstBinding=0; w[0].pImageInfo=&v; w[1].dstBinding=1; w[1].pImageInfo=&out;
         vkUpdateDescriptorSets(dev_,2,w,0,nullptr);
+        return ds;
     }
-    void update_ds_jacobi_(){
+    VkDescriptorSet frame_ds_jacobi_(){
+        const VkDescriptorSet ds = da_->allocate_frame(dev_, dsl_jacobi_);
         // jacobi_3d: binding 0 pSrc (r32f), 1 divergence (r32f), 2 pDst (r32f)
         VkWriteDescriptorSet w[3]{};
         VkDescriptorImageInfo psrc{.sampler=VK_NULL_HANDLE,.imageView=pA_.view,.imageLayout=VK_IMAGE_LAYOUT_GENERAL};
         VkDescriptorImageInfo divi{.sampler=VK_NULL_HANDLE,.imageView=div_.view,.imageLayout=VK_IMAGE_LAYOUT_GENERAL};
         VkDescriptorImageInfo pdst{.sampler=VK_NULL_HANDLE,.imageView=pB_.view,.imageLayout=VK_IMAGE_LAYOUT_GENERAL};
-        for(int i=0;i<3;++i){ w[i].sType=VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET; w[i].dstSet=ds_jacobi_; w[i].descriptorCount=1; w[i].descriptorType=VK_DESCRIPTOR_TYPE_STORAGE_IMAGE; }
+        for(int i=0;i<3;++i){ w[i].sType=VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET; w[i].dstSet=ds; w[i].descriptorCount=1; w[i].descriptorType=VK_DESCRIPTOR_TYPE_STORAGE_IMAGE; }
         w[0].dstBinding=0; w[0].pImageInfo=&psrc; w[1].dstBinding=1; w[1].pImageInfo=&divi; w[2].dstBinding=2; w[2].pImageInfo=&pdst;
         vkUpdateDescriptorSets(dev_,3,w,0,nullptr);
+        return ds;
     }
-    void update_ds_gradient_(){
+    VkDescriptorSet frame_ds_gradient_(){
+        const VkDescriptorSet ds = da_->allocate_frame(dev_, dsl_gradient_);
         // gradient_3d: binding 0 pressure (r32f), 1 velSrc (rgba32f), 2 velDst (rgba32f)
         VkWriteDescriptorSet w[3]{};
         VkDescriptorImageInfo p{.sampler=VK_NULL_HANDLE,.imageView=pA_.view,.imageLayout=VK_IMAGE_LAYOUT_GENERAL};
         VkDescriptorImageInfo vs{.sampler=VK_NULL_HANDLE,.imageView=velA_.view,.imageLayout=VK_IMAGE_LAYOUT_GENERAL};
         VkDescriptorImageInfo vd{.sampler=VK_NULL_HANDLE,.imageView=velB_.view,.imageLayout=VK_IMAGE_LAYOUT_GENERAL};
-        for(int i=0;i<3;++i){ w[i].sType=VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET; w[i].dstSet=ds_gradient_; w[i].descriptorCount=1; w[i].descriptorType=VK_DESCRIPTOR_TYPE_STORAGE_IMAGE; }
+        for(int i=0;i<3;++i){ w[i].sType=VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET; w[i].dstSet=ds; w[i].descriptorCount=1; w[i].descriptorType=VK_DESCRIPTOR_TYPE_STORAGE_IMAGE; }
         w[0].dstBinding=0; w[0].pImageInfo=&p; w[1].dstBinding=1; w[1].pImageInfo=&vs; w[2].dstBinding=2; w[2].pImageInfo=&vd;
         vkUpdateDescriptorSets(dev_,3,w,0,nullptr);
+        return ds;
     }
-    void update_ds_inject_(){
+    VkDescriptorSet frame_ds_inject_(){
+        const VkDescriptorSet ds = da_->allocate_frame(dev_, dsl_inject_);
         // inject_3d: binding 0 velField (rgba32f), 1 denField (r32f)
         VkWriteDescriptorSet w[2]{};
         VkDescriptorImageInfo v{.sampler=VK_NULL_HANDLE,.imageView=velA_.view,.imageLayout=VK_IMAGE_LAYOUT_GENERAL};
         VkDescriptorImageInfo den{.sampler=VK_NULL_HANDLE,.imageView=denA_.view,.imageLayout=VK_IMAGE_LAYOUT_GENERAL};
-        for(int i=0;i<2;++i){ w[i].sType=VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET; w[i].dstSet=ds_inject_; w[i].descriptorCount=1; w[i].descriptorType=VK_DESCRIPTOR_TYPE_STORAGE_IMAGE; }
+        for(int i=0;i<2;++i){ w[i].sType=VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET; w[i].dstSet=ds; w[i].descriptorCount=1; w[i].descriptorType=VK_DESCRIPTOR_TYPE_STORAGE_IMAGE; }
         w[0].dstBinding=0; w[0].pImageInfo=&v; w[1].dstBinding=1; w[1].pImageInfo=&den;
         vkUpdateDescriptorSets(dev_,2,w,0,nullptr);
+        return ds;
     }
-    void update_ds_render_(const AttachmentView& color){ VkDescriptorImageInfo i0{.sampler=VK_NULL_HANDLE, .imageView=denA_.view, .imageLayout=VK_IMAGE_LAYOUT_GENERAL}; VkDescriptorImageInfo i1{.sampler=VK_NULL_HANDLE, .imageView=color.view, .imageLayout=VK_IMAGE_LAYOUT_GENERAL}; VkWriteDescriptorSet w[2]{{VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET},{VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET}}; w[0].dstSet=ds_render_; w[0].dstBinding=0; w[0].descriptorCount=1; w[0].descriptorType=VK_DESCRIPTOR_TYPE_STORAGE_IMAGE; w[0].pImageInfo=&i0; w[1]=w[0]; w[1].dstBinding=1; w[1].pImageInfo=&i1; vkUpdateDescriptorSets(dev_,2,w,0,nullptr);}
+    VkDescriptorSet frame_ds_render_(const AttachmentView& color, const Image3D& density){ const VkDescriptorSet ds = da_->allocate_frame(dev_, dsl_render_); VkDescriptorImageInfo i0{.sampler=VK_NULL_HANDLE, .imageView=density.view, .imageLayout=VK_IMAGE_LAYOUT_GENERAL}; VkDescriptorImageInfo i1{.sampler=VK_NULL_HANDLE, .imageView=color.view, .imageLayout=VK_IMAGE_LAYOUT_GENERAL}; VkWriteDescriptorSet w[2]{{VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET},{VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET}}; w[0].dstSet=ds; w[0].dstBinding=0; w[0].descriptorCount=1; w[0].descriptorType=VK_DESCRIPTOR_TYPE_STORAGE_IMAGE; w[0].pImageInfo=&i0; w[1]=w[0]; w[1].dstBinding=1; w[1].pImageInfo=&i1; vkUpdateDescriptorSets(dev_,2,w,0,nullptr); return ds; }
 
     void create_pipelines_(){
         std::string d(SHADER_OUTPUT_DIR);
@@ -367,7 +422,7 @@ private:
         pl_gradient_      = mkpl(dsl_gradient_,      32);
         pl_inject_        = mkpl(dsl_inject_,        48);
         pl_render_        = mkpl(dsl_render_,        80);
-        auto mkp = [&](VkShaderModule sm, VkPipelineLayout pl){ VkComputePipelineCreateInfo ci{VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO}; VkPipelineShaderStageCreateInfo st{VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO}; st.stage=VK_SHADER_STAGE_COMPUTE_BIT; st.module=sm; st.pName="main"; ci.stage=st; ci.layout=pl; VkPipeline p{}; VK_CHECK(vkCreateComputePipelines(dev_, VK_NULL_HANDLE, 1, &ci, nullptr, &p)); return p; };
+        auto mkp = [&](VkShaderModule sm, VkPipelineLayout pl){ VkComputePipelineCreateInfo ci{VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO}; VkPipelineShaderStageCreateInfo st{VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO}; st.stage=VK_SHADER_STAGE_COMPUTE_BIT; st.module=sm; st.pName="main"; ci.stage=st; ci.layout=pl; VkPipeline p{}; VK_CHECK(eng_.pipeline_cache->create(ci, &p)); return p; };
         p_advect_vec_    = mkp(sm_advect_vec_,    pl_advect_vec_);
         p_advect_scalar_ = mkp(sm_advect_scalar_, pl_advect_scalar_);
         p_divergence_    = mkp(sm_divergence_,    pl_divergence_);
@@ -375,13 +430,6 @@ private:
         p_gradient_      = mkp(sm_gradient_,      pl_gradient_);
         p_inject_        = mkp(sm_inject_,        pl_inject_);
         p_render_        = mkp(sm_render_,        pl_render_);
-        ds_advect_vec_    = da_->allocate(dev_, dsl_advect_vec_);
-        ds_advect_scalar_ = da_->allocate(dev_, dsl_advect_scalar_);
-        ds_divergence_    = da_->allocate(dev_, dsl_divergence_);
-        ds_jacobi_        = da_->allocate(dev_, dsl_jacobi_);
-        ds_gradient_      = da_->allocate(dev_, dsl_gradient_);
-        ds_inject_        = da_->allocate(dev_, dsl_inject_);
-        ds_render_        = da_->allocate(dev_, dsl_render_);
     }
 
     void destroy_pipelines_(){
@@ -396,4 +444,4 @@ private:
     }
 };
 
-int main(){ try{ VulkanEngine e; e.configure_window(1280, 720, "ex11_stable_fluids_3d"); e.set_renderer(std::make_unique<StableFluids>()); e.init(); e.run(); e.cleanup(); } catch(const std::exception& ex){ std::fprintf(stderr, "Fatal: %s\n", ex.what()); return 1; } return 0; }
+int main(){ try{ VulkanEngine e; e.configure_window(1280, 720, "ex11_stable_fluids_3d"); e.configure_dynamic_resolution(12.0, 0.5f, 1.0f); e.set_renderer(std::make_unique<StableFluids>()); e.init(); e.run(); e.cleanup(); } catch(const std::exception& ex){ std::fprintf(stderr, "Fatal: %s\n", ex.what()); return 1; } return 0; }
@@ -1,9 +1,9 @@
 #version 460
-layout(location=0) in vec3 inPos;
+#include "vv_pull.glsl"
 layout(location=0) out vec4 vColor;
-layout(push_constant) uniform PC { mat4 mvp; vec4 color; float pointSize; } pc;
+layout(push_constant) uniform PC { mat4 mvp; vec4 color; float pointSize; float pad; VvFloat3s positions; } pc;
 void main(){
-    gl_Position = pc.mvp * vec4(inPos, 1.0);
+    gl_Position = pc.mvp * vec4(vv_load(pc.positions, gl_VertexIndex), 1.0);
     vColor = pc.color;
     gl_PointSize = pc.pointSize;
 }
@@ -0,0 +1,9 @@
+#version 460
+
+// vkCmdDraw(cmd, 3, 1, 0, 0) without vertex input: one triangle covering the viewport, uv 0..1 over it
+layout(location = 0) out vec2 vv_uv;
+
+void main() {
+    vv_uv       = vec2((gl_VertexIndex << 1) & 2, gl_VertexIndex & 2);
+    gl_Position = vec4(vv_uv * 2.0 - 1.0, 0.0, 1.0);
+}
@@ -0,0 +1,33 @@
+// Vertex pulling through buffer device addresses (vv::DeviceBuffer::address, UploadService::Buffer::address).
+// Declare stream references in the push constant block and read them with gl_VertexIndex; bound index buffers still
+// work (gl_VertexIndex is then the fetched index). Streams are tightly packed arrays as the CPU holds them.
+// Include it right after #version: it enables extensions.
+#ifndef VV_PULL_GLSL
+#define VV_PULL_GLSL
+
+#extension GL_EXT_buffer_reference : require
+#extension GL_EXT_buffer_reference_uvec2 : require
+
+layout(buffer_reference, std430, buffer_reference_align = 4) readonly buffer VvFloats { float v[]; };  // 1 float per element
+layout(buffer_reference, std430, buffer_reference_align = 4) readonly buffer VvFloat3s { float v[]; }; // 3 floats, 12-byte stride
+layout(buffer_reference, std430, buffer_reference_align = 16) readonly buffer VvFloat4s { vec4 v[]; };
+layout(buffer_reference, std430, buffer_reference_align = 4) readonly buffer VvUints { uint v[]; };
+
+bool vv_present(VvFloats s) { return uvec2(s) != uvec2(0); }
+bool vv_present(VvFloat3s s) { return uvec2(s) != uvec2(0); }
+bool vv_present(VvFloat4s s) { return uvec2(s) != uvec2(0); }
+bool vv_present(VvUints s) { return uvec2(s) != uvec2(0); }
+
+float vv_load(VvFloats s, uint i) { return s.v[i]; }
+vec3 vv_load(VvFloat3s s, uint i) { return vec3(s.v[3u * i], s.v[3u * i + 1u], s.v[3u * i + 2u]); }
+vec4 vv_load(VvFloat4s s, uint i) { return s.v[i]; }
+uint vv_load(VvUints s, uint i) { return s.v[i]; }
+
+// Optional streams: `fallback` when the address is 0
+vec3 vv_load_or(VvFloat3s s, uint i, vec3 fallback) { return vv_present(s) ? vv_load(s, i) : fallback; }
+vec4 vv_load_or(VvFloat4s s, uint i, vec4 fallback) { return vv_present(s) ? vv_load(s, i) : fallback; }
+
+// Non-indexed draws over an index stream: vkCmdDraw(index_count) and fetch the vertex here
+uint vv_vertex(VvUints indices, uint vertex_index) { return vv_present(indices) ? indices.v[vertex_index] : vertex_index; }
+
+#endif // VV_PULL_GLSL
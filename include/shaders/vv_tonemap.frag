@@ -0,0 +1,32 @@
+#version 460
+#include "vv_tonemap.glsl"
+
+layout(location = 0) in vec2 vv_uv;
+layout(location = 0) out vec4 vv_out;
+
+vec3 reinhard(vec3 x) { return x / (1.0 + vv_luminance(x)); }
+
+// Narkowicz' fit of the ACES filmic reference curve
+vec3 aces(vec3 x) { return clamp((x * (2.51 * x + 0.03)) / (x * (2.43 * x + 0.59) + 0.14), 0.0, 1.0); }
+
+vec3 linear_to_srgb(vec3 c) { return mix(c * 12.92, 1.055 * pow(c, vec3(1.0 / 2.4)) - 0.055, greaterThan(c, vec3(0.0031308))); }
+vec3 srgb_to_linear(vec3 c) { return mix(c / 12.92, pow((c + 0.055) / 1.055, vec3(2.4)), greaterThan(c, vec3(0.04045))); }
+
+float interleaved_gradient_noise(vec2 p) { return fract(52.9829189 * fract(dot(p, vec2(0.06711056, 0.00583715)))); }
+
+void main() {
+    // Linear filtering doubles as the dynamic resolution upscale
+    const vec3 hdr = textureLod(vv_source, min(vv_uv * vv_pc.uv_scale, vv_pc.uv_max), 0.0).rgb;
+    const float exposure = exp2(vv_pc.exposure_ev) * ((vv_pc.flags & VV_TONEMAP_AUTO) != 0u ? vv_exposure.exposure : 1.0);
+
+    vec3 c = max(hdr * exposure, vec3(0.0));
+    const uint curve = vv_pc.flags & VV_TONEMAP_CURVE_MASK;
+    if (curve == 1u) c = reinhard(c);
+    else if (curve == 2u) c = aces(c);
+
+    // Dither in the 8-bit encoded domain, where the banding is; the hardware re-encodes _SRGB targets
+    vec3 e = linear_to_srgb(clamp(c, 0.0, 1.0));
+    if ((vv_pc.flags & VV_TONEMAP_DITHER) != 0u) e += (interleaved_gradient_noise(gl_FragCoord.xy + 5.588238 * float(vv_pc.frame & 63u)) - 0.5) / 255.0;
+    e = clamp(e, 0.0, 1.0);
+    vv_out = vec4((vv_pc.flags & VV_TONEMAP_ENCODE_SRGB) != 0u ? e : srgb_to_linear(e), 1.0);
+}
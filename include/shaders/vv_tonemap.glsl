@@ -0,0 +1,32 @@
+// Shared by the engine's present passes (vv::ToneMapper): one descriptor set and one push constant block for the
+// luminance histogram, the exposure reduction and the fullscreen tonemap.
+#ifndef VV_TONEMAP_GLSL
+#define VV_TONEMAP_GLSL
+
+#define VV_TONEMAP_CURVE_MASK  3u // 0 none, 1 Reinhard, 2 ACES
+#define VV_TONEMAP_AUTO        4u
+#define VV_TONEMAP_DITHER      8u
+#define VV_TONEMAP_ENCODE_SRGB 16u // target is UNORM: encode in the shader instead of the _SRGB format
+
+#define VV_TONEMAP_BINS 256u // bin 0: (near) black, never counted in the average
+
+layout(set = 0, binding = 0) uniform sampler2D vv_source;
+layout(set = 0, binding = 1, std430) buffer VvHistogram { uint bins[VV_TONEMAP_BINS]; } vv_histogram;
+layout(set = 0, binding = 2, std430) buffer VvExposure { float avg_log2; float exposure; uint valid; } vv_exposure;
+
+layout(push_constant, std430) uniform VvTonemapPush {
+    uvec2 extent;      // rendered area of vv_source
+    float min_log2;    // histogram range
+    float log2_range;
+    float dt;
+    float adaptation;  // 1/s
+    float exposure_ev; // manual exposure, or compensation on top of auto exposure
+    uint flags;
+    vec2 uv_scale;     // rendered area / vv_source size
+    vec2 uv_max;       // last rendered texel centre: linear filtering never reads past the rendered area
+    uint frame;
+} vv_pc;
+
+float vv_luminance(vec3 c) { return dot(c, vec3(0.2126, 0.7152, 0.0722)); }
+
+#endif // VV_TONEMAP_GLSL
@@ -4,13 +4,32 @@
 #include <SDL3/SDL.h>
 #include <vulkan/vulkan.h>
 
+#include "vv_bindless.h"
+#include "vv_buffer.h"
+#include "vv_file_watch.h"
+#include "vv_log.h"
+#include "vv_metrics.h"
+#include "vv_pipeline_cache.h"
+#include "vv_profiler.h"
+#include "vv_render_graph.h"
+#include "vv_retire.h"
+#include "vv_shader.h"
+#include "vv_tonemap.h"
+#include "vv_upload.h"
+
+#include <array>
+#include <chrono>
 #include <cstdint>
+#include <cstdio>
+#include <filesystem>
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <span>
 #include <string>
 #include <string_view>
+#include <unordered_map>
 #include <vector>
 
 // Minimal UI tabs host interface exposed via EngineContext.services (if ImGui is enabled)
@@ -28,26 +47,54 @@ struct TabsHost {
 struct VmaAllocator_T; using VmaAllocator = VmaAllocator_T*;
 struct VmaAllocation_T; using VmaAllocation = VmaAllocation_T*;
 
-#ifdef VV_ENABLE_LOGGING
-#include <cstdio>
-#define VV_LOG_INFO(fmt, ...)  do { std::fprintf(stderr, "[INFO] " fmt "\n", ##__VA_ARGS__); } while(0)
-#define VV_LOG_WARN(fmt, ...)  do { std::fprintf(stderr, "[WARN] " fmt "\n", ##__VA_ARGS__); } while(0)
-#define VV_LOG_ERROR(fmt, ...) do { std::fprintf(stderr, "[ERROR] " fmt "\n", ##__VA_ARGS__); } while(0)
-#else
-#define VV_LOG_INFO(...)  do {} while(0)
-#define VV_LOG_WARN(...)  do {} while(0)
-#define VV_LOG_ERROR(...) do {} while(0)
-#endif
-
-inline constexpr unsigned int FRAME_OVERLAP = 2;
+// Default frames in flight; renderers may request 1..MAX_FRAMES_IN_FLIGHT through RendererCaps::frames_in_flight
+inline constexpr unsigned int FRAME_OVERLAP        = 2;
+inline constexpr unsigned int MAX_FRAMES_IN_FLIGHT = 4;
 
-struct DescriptorAllocator {
+// Pool-of-pools descriptor allocator; thread-safe, so graphics jobs may allocate while recording. allocate() hands out sets
+// that live until freed (retire(), or free() once no submission uses them) or clear_descriptors(); allocate_frame()
+// hands out sets that are only valid for the frame being recorded, since the engine resets that frame slot's pools once
+// its previous submission has completed. Either way a pool that runs out is followed by a larger one instead of failing.
+class DescriptorAllocator {
+public:
     struct PoolSizeRatio { VkDescriptorType type; float ratio; };
-    VkDescriptorPool pool{};
+    struct Stats {
+        uint32_t pools{0};       // persistent pools
+        uint32_t frame_pools{0}; // across every frame slot
+        uint64_t sets{0};        // live allocate() sets: allocated minus freed since the last clear_descriptors()
+        uint64_t frame_sets{0};  // allocate_frame() calls for the frame being recorded
+        uint32_t grows{0};       // pools opened because the previous one ran out
+        uint32_t next_pool_sets{0};
+    };
+
     void init_pool(VkDevice device, uint32_t maxSets, std::span<const PoolSizeRatio> ratios);
-    void clear_descriptors(VkDevice device) const;
-    void destroy_pool(VkDevice device) const;
-    VkDescriptorSet allocate(VkDevice device, VkDescriptorSetLayout layout) const;
+    void clear_descriptors(VkDevice device);
+    void destroy_pool(VkDevice device);
+    VkDescriptorSet allocate(VkDevice device, VkDescriptorSetLayout layout, VkDescriptorPool* pool_out = nullptr);
+    void free(VkDevice device, VkDescriptorPool pool, VkDescriptorSet set); // a pool that was full takes allocations again
+    void retire(vv::RetireQueue& queue, VkDevice device, VkDescriptorPool pool, VkDescriptorSet set, uint64_t value); // free() at value
+    VkDescriptorSet allocate_frame(VkDevice device, VkDescriptorSetLayout layout);
+    void begin_frame(VkDevice device, uint32_t frame_slot); // engine: the slot's previous submission is complete; recycles freed pools
+
+    [[nodiscard]] Stats stats() const { std::scoped_lock lock(mutex_); return stats_; }
+    void imgui_panel_contents() const; // ImGui (Stats tab)
+
+private:
+    static constexpr uint32_t kMaxSetsPerPool = 4096;
+    struct FrameSlot { std::vector<VkDescriptorPool> pools; size_t active{0}; };
+
+    VkDescriptorPool create_pool(VkDevice device, VkDescriptorPoolCreateFlags flags) const; // sets_per_pool_ sets
+    void grow(); // a pool ran out: the next one is twice as large, up to kMaxSetsPerPool
+
+    mutable std::mutex mutex_{};
+    std::vector<PoolSizeRatio> ratios_{};
+    std::vector<VkDescriptorPool> ready_{}; // persistent pools with room left; back() is tried first
+    std::vector<VkDescriptorPool> full_{};
+    std::vector<VkDescriptorPool> freed_{}; // full_ pools a set was freed from since the last begin_frame()
+    std::array<FrameSlot, MAX_FRAMES_IN_FLIGHT> frames_{};
+    uint32_t slot_{0};
+    uint32_t sets_per_pool_{0};
+    Stats stats_{};
 };
 
 enum class PresentationMode : uint8_t { EngineBlit, RendererComposite, DirectToSwapchain };
@@ -59,6 +106,12 @@ struct AttachmentRequest {
     VkSampleCountFlagBits samples{VK_SAMPLE_COUNT_1_BIT};
     VkImageAspectFlags aspect{VK_IMAGE_ASPECT_COLOR_BIT};
     VkImageLayout initial_layout{VK_IMAGE_LAYOUT_GENERAL};
+    // Contents are not kept across frames and the attachment is only touched by render graph passes: it may share memory
+    // with other transient attachments whose pass lifetimes (observed from the graph) do not overlap
+    bool transient{false};
+    // Multisampled only: the engine adds a single-sample "<name>_resolve" attachment (AttachmentView::resolve_view) that
+    // rendering_info() resolves into with this mode. SAMPLE_ZERO for integer formats, NONE for no resolve target.
+    VkResolveModeFlagBits resolve_mode{VK_RESOLVE_MODE_AVERAGE_BIT};
 };
 
 struct AttachmentView {
@@ -70,7 +123,17 @@ struct AttachmentView {
     VkSampleCountFlagBits samples{VK_SAMPLE_COUNT_1_BIT};
     VkImageUsageFlags usage{0};
     VkImageAspectFlags aspect{VK_IMAGE_ASPECT_COLOR_BIT};
-    VkImageLayout current_layout{VK_IMAGE_LAYOUT_UNDEFINED};
+    VkImageLayout current_layout{VK_IMAGE_LAYOUT_UNDEFINED}; // at frame start, as tracked by the render graph
+    VkImage resolve_image{VK_NULL_HANDLE}; // the "<name>_resolve" attachment of a multisampled view, also in color_attachments
+    VkImageView resolve_view{VK_NULL_HANDLE};
+    VkResolveModeFlagBits resolve_mode{VK_RESOLVE_MODE_NONE};
+
+    // For vkCmdBeginRendering: a multisampled view resolves into resolve_view at the end of the rendering, after which its
+    // own samples are usually not needed again (store = DONT_CARE keeps them in tile memory on tilers)
+    [[nodiscard]] VkRenderingAttachmentInfo rendering_info(VkAttachmentLoadOp load, VkClearValue clear = {}, VkAttachmentStoreOp store = VK_ATTACHMENT_STORE_OP_STORE, VkImageLayout layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL) const {
+        return VkRenderingAttachmentInfo{.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO, .pNext = nullptr, .imageView = view, .imageLayout = layout,
+            .resolveMode = resolve_view ? resolve_mode : VK_RESOLVE_MODE_NONE, .resolveImageView = resolve_view, .resolveImageLayout = layout, .loadOp = load, .storeOp = store, .clearValue = clear};
+    }
 };
 
 struct EngineContext {
@@ -89,12 +152,23 @@ struct EngineContext {
     uint32_t transfer_queue_family{};
     uint32_t present_queue_family{};
     void* services{}; // if ImGui enabled: points to vv_ui::TabsHost, otherwise nullptr
+    vv::GpuProfiler* gpu_profiler{}; // GPU timestamp zones (graphics queue); nullptr if timestamps are disabled or unsupported
+    vv::RenderGraph* render_graph{}; // forget_image()/forget_buffer() before destroying resources imported into it
+    vv::RetireQueue* retire_queue{}; // retire(handle, retire_queue->frame_value()) instead of destroying resources in-flight frames may use
+    bool async_compute{}; // record_async_compute() is called every frame and submitted to a dedicated compute queue
+    vv::UploadService* uploads{}; // transfer-queue uploads; nullptr unless RendererCaps::allow_async_transfer
+    vv::PipelineCache* pipeline_cache{}; // create(info, &pipeline) or pass handle() to vkCreate*Pipelines; persisted across runs
+    vv::ShaderService* shaders{}; // GLSL -> VkShaderModule on worker threads, SPIR-V cached on disk; modules are owned by the service
+    vv::BindlessHeap* bindless{}; // global storage image / sampled image / storage buffer tables; nullptr unless RendererCaps::descriptor_indexing
+    vv::MetricsRegistry* metrics{}; // register gauges/counters once, set()/add() from any thread; sampled once per frame (Metrics tab, HUD)
 };
 
 struct FrameContext {
     uint64_t frame_index{};
     uint32_t image_index{};
-    VkExtent2D extent{};
+    VkExtent2D extent{}; // render area: swapchain_extent x render_scale, anchored at the attachments' top-left corner
+    VkExtent2D swapchain_extent{};
+    float render_scale{1.0f}; // attachments are sized for the largest scale, so they may be bigger than `extent`
     VkFormat swapchain_format{};
     double dt_sec{};
     double time_sec{};
@@ -118,9 +192,9 @@ struct RendererCaps {
     VkBool32 buffer_device_address{VK_TRUE};
     VkBool32 uses_depth{VK_FALSE};
     VkBool32 uses_offscreen{VK_TRUE};
-    VkSampleCountFlagBits color_samples{VK_SAMPLE_COUNT_1_BIT};
+    VkSampleCountFlagBits color_samples{VK_SAMPLE_COUNT_1_BIT}; // default for attachments left at 1 sample; lowered to what the device supports
     PresentationMode presentation_mode{PresentationMode::EngineBlit};
-    std::string presentation_attachment{"hdr_color"};
+    std::string presentation_attachment{"hdr_color"}; // a multisampled attachment is presented through its "<name>_resolve"
     std::vector<AttachmentRequest> color_attachments{AttachmentRequest{.name = "hdr_color"}};
     std::optional<AttachmentRequest> depth_attachment{};
     VkFormat preferred_swapchain_format{VK_FORMAT_B8G8R8A8_UNORM};
@@ -129,7 +203,9 @@ struct RendererCaps {
     VkPresentModeKHR present_mode{VK_PRESENT_MODE_FIFO_KHR};
     bool enable_imgui{true};
     bool allow_async_compute{false};
-    bool allow_async_transfer{false};
+    bool allow_async_transfer{false}; // creates EngineContext::uploads on the transfer queue
+    VkDeviceSize upload_ring_bytes{32ull << 20}; // staging ring for EngineContext::uploads
+    vv::BindlessHeap::Capacity bindless_capacity{}; // EngineContext::bindless table sizes, clamped to device limits
     bool need_ray_tracing_pipeline{false};
     bool need_acceleration_structure{false};
     bool need_ray_query{false};
@@ -140,7 +216,27 @@ struct RendererCaps {
     std::vector<const char*> extra_device_extensions{};
 };
 
-struct RendererStats { uint64_t draw_calls{}; uint64_t dispatches{}; uint64_t triangles{}; double cpu_ms{}; double gpu_ms{}; };
+// `pipeline` left zero is filled by the engine from the last resolved frame's vv::ZoneFlags::PipelineStats zones.
+struct RendererStats { uint64_t draw_calls{}; uint64_t dispatches{}; uint64_t triangles{}; double cpu_ms{}; double gpu_ms{}; vv::PipelineCounters pipeline{}; };
+
+// Parallel graphics recording plan. `count` secondaries are recorded concurrently by record_graphics_job() and executed in
+// job order right after record_graphics(). With `rendering` set, secondaries inherit that dynamic rendering scope (begin it in
+// record_graphics() with VK_RENDERING_CONTENTS_SECONDARY_COMMAND_BUFFERS_BIT, end it in finish_graphics_jobs()); the pointed-to
+// formats must stay valid for the frame. Without it, each job records self-contained work, including its own rendering scopes.
+struct GraphicsJobs { uint32_t count{0}; const VkCommandBufferInheritanceRenderingInfo* rendering{nullptr}; };
+
+// Image or buffer written by record_async_compute() and read by graphics in the same frame (VK_SHARING_MODE_EXCLUSIVE).
+// The engine records the queue family release/acquire pairs in both directions and orders them with timeline waits; images
+// stay in `layout`. The next compute submission only waits for the graphics frame that last read the same resource, so a
+// renderer alternating between copies (by frame_index) simulates frame N+1 while frame N is still being drawn.
+struct AsyncComputeOutput {
+    VkImage image{};
+    VkImageSubresourceRange range{VK_IMAGE_ASPECT_COLOR_BIT, 0u, VK_REMAINING_MIP_LEVELS, 0u, VK_REMAINING_ARRAY_LAYERS};
+    VkImageLayout layout{VK_IMAGE_LAYOUT_GENERAL};
+    VkBuffer buffer{};
+    VkPipelineStageFlags2 graphics_stages{VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT};
+    VkAccessFlags2 graphics_access{VK_ACCESS_2_SHADER_READ_BIT};
+};
 
 class IRenderer {
 public:
@@ -150,16 +246,25 @@ public:
     virtual void initialize(const EngineContext& eng, const RendererCaps& caps, const FrameContext& initial_frame) = 0;
     virtual void destroy(const EngineContext& eng, const RendererCaps& caps) = 0;
     virtual void on_swapchain_ready(const EngineContext& eng, const FrameContext& frm) { (void)eng; (void)frm; }
-    virtual void on_swapchain_destroy(const EngineContext& eng) { (void)eng; }
+    virtual void on_swapchain_destroy(const EngineContext& eng) { (void)eng; } // no device wait: retire size-dependent resources
     virtual void simulate(const EngineContext& eng, const FrameContext& frm) { (void)eng; (void)frm; }
     virtual void update(const EngineContext& eng, const FrameContext& frm) { (void)eng; (void)frm; }
     virtual void record_compute(VkCommandBuffer, const EngineContext&, const FrameContext&) {}
     virtual bool record_async_compute(VkCommandBuffer, const EngineContext&, const FrameContext&) { return false; }
+    virtual void get_async_compute_outputs(const EngineContext&, const FrameContext&, std::vector<AsyncComputeOutput>&) {} // before record_async_compute()
     virtual void record_graphics(VkCommandBuffer cmd, const EngineContext& eng, const FrameContext& frm) = 0;
     virtual void compose(VkCommandBuffer, const EngineContext&, const FrameContext&) {}
+    // Add passes after the attachments were imported (graph.find(name)); they run after record_graphics(). A renderer that
+    // adds passes owns attachment layouts through the graph; otherwise attachments are returned to their initial layout.
+    virtual void build_render_graph(vv::RenderGraph&, const EngineContext&, const FrameContext&) {}
+    virtual GraphicsJobs plan_graphics_jobs(const EngineContext&, const FrameContext&) { return {}; }
+    virtual void record_graphics_job(VkCommandBuffer, uint32_t, const EngineContext&, const FrameContext&) {} // called on worker threads
+    virtual void finish_graphics_jobs(VkCommandBuffer, const EngineContext&, const FrameContext&) {}
     virtual void on_event(const SDL_Event&, const EngineContext&, const FrameContext*) {}
     virtual void on_imgui(const EngineContext&, const FrameContext&) {}
-    virtual void reload_assets(const EngineContext&) {}
+    virtual void reload_assets(const EngineContext&) {} // any watched path changed
+    // One debounced batch of watched paths; the default forwards to reload_assets(eng) so renderers written against that keep working
+    virtual void reload_assets(const EngineContext& eng, std::span<const std::filesystem::path> changed) { (void)changed; reload_assets(eng); }
     virtual void request_screenshot(const char*) {}
     [[nodiscard]] virtual RendererStats get_stats() const { return {}; }
     virtual void set_option_int(const char*, int) {}
@@ -180,16 +285,30 @@ public:
     VulkanEngine& operator=(VulkanEngine&&) noexcept = default;
     void init();
     void run();
+    void run_frames(uint64_t count); // drive `count` frames and return once the last one is submitted (works headless)
     void cleanup();
     void set_renderer(std::unique_ptr<IRenderer> r);
     void configure_window(uint32_t w, uint32_t h, std::string_view title);
+    void configure_headless(bool enabled) { state_.headless = enabled; } // before init(): no window/surface/swapchain, attachments only
+    [[nodiscard]] bool headless() const { return state_.headless; }
+    // Trade throughput for latency: cap the CPU frame rate (0 = off) and the frames queued ahead of the display (0 = off)
+    void configure_frame_pacing(double target_fps, uint32_t max_queued_frames) { pacing_.target_fps = target_fps; pacing_.max_queued_frames = max_queued_frames; }
+    // Before init(): where the pipeline cache is kept (default: SDL_GetPrefPath("vulkan-visualizer", <window title>))
+    void configure_pipeline_cache(std::string_view directory) { pipeline_cache_dir_ = directory; }
+    // EngineBlit only: attachments are allocated at max_scale x the swapchain extent, renderers draw FrameContext::extent and
+    // the blit upscales it. The scale follows the engine GPU time towards target_gpu_ms (0 = keep set_render_scale()).
+    void configure_dynamic_resolution(double target_gpu_ms, float min_scale = 0.5f, float max_scale = 1.0f);
+    void set_render_scale(float scale); // clamped to the configured range
+    [[nodiscard]] float render_scale() const { return resolution_.scale; }
     [[nodiscard]] uint32_t width() const { return state_.width; }
     [[nodiscard]] uint32_t height() const { return state_.height; }
 #ifdef VV_ENABLE_HOTRELOAD
     void add_hot_reload_watch_path(const std::string& path);
 #endif
 #ifdef VV_ENABLE_LOGGING
-    void log_line(const std::string& s);
+    // Before init(): also write the log to this file (the sink thread starts in init() and stops in cleanup())
+    void configure_log_file(std::string_view path) { log_file_ = path; }
+    void log_line(const std::string& s) { VV_LOG_INFO("%s", s.c_str()); }
 #endif
 
 private:
@@ -198,7 +317,14 @@ private:
     void destroy_context();
     [[nodiscard]] EngineContext make_engine_context() const;
     FrameContext make_frame_context(uint64_t frame_index, uint32_t image_index, VkExtent2D extent);
-    void blit_offscreen_to_swapchain(VkCommandBuffer cmd, uint32_t imageIndex, VkExtent2D extent);
+    void blit_offscreen_to_swapchain(VkCommandBuffer cmd, uint32_t imageIndex, VkExtent2D src_extent, VkExtent2D dst_extent);
+    void build_frame_graph(const EngineContext& eng, const FrameContext& frm, uint32_t imageIndex);
+    void poll_events(const EngineContext& eng, const FrameContext& last_frm);
+    bool draw_frame(const EngineContext& eng, FrameContext& last_frm);
+    // State run() and run_frames() carry between iterations; both drive the loop through step_frame()
+    struct FrameLoop { std::chrono::steady_clock::time_point t_prev; EngineContext eng; FrameContext last_frm; };
+    FrameLoop begin_frame_loop();
+    bool step_frame(FrameLoop& loop); // events, timing, hot reload, resize, draw; true when a frame was submitted
 
     struct DeviceContext {
         VkInstance instance{};
@@ -216,7 +342,10 @@ private:
         uint32_t transfer_queue_family{};
         uint32_t present_queue_family{};
         VmaAllocator allocator{};
-        DescriptorAllocator descriptor_allocator;
+        std::unique_ptr<DescriptorAllocator> descriptor_allocator;
+        bool calibrated_timestamps{false}; // VK_EXT_calibrated_timestamps enabled (GPU zones in CPU traces)
+        bool pipeline_statistics{false};   // pipelineStatisticsQuery enabled (vv::ZoneFlags::PipelineStats)
+        bool storage_image_nonuniform{false}; // shaderStorageImageArrayNonUniformIndexing enabled (bindless storage images)
     } ctx_{};
 
     void create_swapchain(uint32_t width, uint32_t height);
@@ -224,17 +353,31 @@ private:
     void recreate_swapchain();
     void create_renderer_targets(VkExtent2D extent);
     void destroy_renderer_targets();
+    void rebuild_renderer_targets();
+    void observe_attachment_lifetimes();
 
     struct AllocatedImage { VkImage image{}; VkImageView imageView{}; VmaAllocation allocation{}; VkExtent3D imageExtent{}; VkFormat imageFormat{}; };
-    struct AttachmentResource { std::string name; VkImageUsageFlags usage{}; VkImageAspectFlags aspect{}; VkSampleCountFlagBits samples{VK_SAMPLE_COUNT_1_BIT}; VkImageLayout initial_layout{VK_IMAGE_LAYOUT_GENERAL}; AllocatedImage image; };
+    struct AttachmentResource { std::string name; VkImageUsageFlags usage{}; VkImageAspectFlags aspect{}; VkSampleCountFlagBits samples{VK_SAMPLE_COUNT_1_BIT}; VkImageLayout initial_layout{VK_IMAGE_LAYOUT_GENERAL}; bool transient{false}; uint32_t alias_block{UINT32_MAX}; VkResolveModeFlagBits resolve_mode{VK_RESOLVE_MODE_NONE}; int resolve_index{-1}; AllocatedImage image; };
     struct SwapchainSystem { VkSwapchainKHR swapchain{}; VkFormat swapchain_image_format{}; VkExtent2D swapchain_extent{}; std::vector<VkImage> swapchain_images; std::vector<VkImageView> swapchain_image_views; std::vector<AttachmentResource> color_attachments; std::optional<AttachmentResource> depth_attachment; } swapchain_{};
 
+    std::unique_ptr<vv::RenderGraph> render_graph_;
+    struct AttachmentAliasing {
+        std::vector<std::pair<std::string, vv::RenderGraph::Lifetime>> lifetimes; // union over observed frames, by attachment name
+        bool observed{false};
+        std::vector<VmaAllocation> blocks;  // shared allocations, indexed by AttachmentResource::alias_block
+        VkDeviceSize dedicated_bytes{0};    // what the aliased attachments would take on their own
+        VkDeviceSize aliased_bytes{0};
+    } aliasing_{};
+    vv::RenderGraph::ResourceId swapchain_resource_{vv::RenderGraph::invalid};
     std::vector<AttachmentView> frame_attachment_views_;
     AttachmentView depth_attachment_view_{};
     int presentation_attachment_index_{0};
 
     void create_command_buffers();
     void destroy_command_buffers();
+    struct ParallelRecorder; // per-thread secondary command pools, implemented privately
+    std::unique_ptr<ParallelRecorder> recorder_;
+    void pace_frame();
     void begin_frame(uint32_t& imageIndex, VkCommandBuffer& cmd);
     void end_frame(uint32_t imageIndex, VkCommandBuffer cmd);
 
@@ -246,13 +389,65 @@ private:
         uint64_t submitted_timeline_value{0};
         std::vector<std::function<void()>> dq;
         VkCommandBuffer asyncComputeCommandBuffer{};
-        VkSemaphore asyncComputeFinished{};
         bool asyncComputeSubmitted{false};
+        VkPipelineStageFlags2 asyncComputeWaitStages{}; // graphics stages that wait for compute_timeline_
         VkCommandPool computeCommandPool{};
-    } frames_[FRAME_OVERLAP]{};
+    };
+    std::vector<FrameData> frames_{}; // sized from renderer_caps_.frames_in_flight at init()
+    uint32_t frames_in_flight_{FRAME_OVERLAP};
+    [[nodiscard]] uint32_t frame_slot() const { return static_cast<uint32_t>(state_.frame_number % frames_in_flight_); }
+    FrameData& current_frame() { return frames_[frame_slot()]; }
 
     VkSemaphore render_timeline_{};
     uint64_t timeline_value_{0};
+    std::unique_ptr<vv::RetireQueue> retire_queue_;
+    std::unique_ptr<vv::PipelineCache> pipeline_cache_;
+    std::string pipeline_cache_dir_{};
+    std::unique_ptr<vv::ShaderService> shaders_;
+    std::unique_ptr<vv::UploadService> uploads_; // null unless renderer_caps_.allow_async_transfer
+    std::unique_ptr<vv::BindlessHeap> bindless_; // null unless renderer_caps_.descriptor_indexing
+    std::unique_ptr<vv::MetricsRegistry> metrics_;
+    struct EngineMetrics { vv::MetricsRegistry::MetricId frame_ms, cpu_ms, gpu_ms, vram_mb; } engine_metrics_{};
+    void sample_engine_metrics(double cpu_ms);
+
+    // Async compute: one compute_timeline_ value per submission. Outputs are tracked by handle across frames: who owns them
+    // and which graphics timeline value last read them (the next compute submission waits for it).
+    VkSemaphore compute_timeline_{};
+    uint64_t compute_value_{0};
+    struct AsyncOutputState { bool graphics_owned{false}; uint64_t graphics_value{0}; uint64_t last_frame{0}; };
+    std::unordered_map<uint64_t, AsyncOutputState> async_outputs_{};
+    std::vector<AsyncComputeOutput> async_frame_outputs_{}; // declared for the frame being recorded
+    struct AsyncComputeStats { uint64_t submissions{0}; uint64_t overlapped{0}; } async_stats_{}; // overlapped: did not wait for the previous graphics frame
+    void submit_async_compute(const EngineContext& eng, const FrameContext& frm, VkCommandBuffer graphics_cmd);
+    void release_async_outputs(VkCommandBuffer graphics_cmd);
+
+    struct FramePacing {
+        PFN_vkWaitForPresentKHR wait_for_present{nullptr}; // set when VK_KHR_present_id + VK_KHR_present_wait are enabled
+        double target_fps{0.0};
+        uint32_t max_queued_frames{0};
+        uint64_t present_id{0};   // last id handed to vkQueuePresentKHR
+        uint64_t displayed_id{0}; // newest id known to be on screen
+        double last_frame_start{0.0};
+        std::array<double, 16> frame_start_sec{}; // indexed by present id
+        double display_latency_ms{0.0};           // smoothed frame start -> on screen
+        double limiter_wait_ms{0.0};
+        uint32_t queue_depth{0};
+    } pacing_{};
+
+    // GPU time scales roughly with the pixel count, so the controller steps the scale by sqrt(target / measured), a few
+    // frames apart: the time read now belongs to a frame recorded frames_in_flight_ ago
+    struct DynamicResolution {
+        double target_gpu_ms{0.0};
+        float min_scale{1.0f};
+        float max_scale{1.0f}; // attachment size
+        float scale{1.0f};
+        double filtered_ms{0.0};
+        uint32_t cooldown{0}; // frames whose GPU time still reflects the previous scale
+        uint32_t samples{0};
+        uint64_t changes{0};
+    } resolution_{};
+    void update_render_scale();
+    [[nodiscard]] static VkExtent2D scaled_extent(VkExtent2D extent, float scale);
 
     void create_renderer();
     void destroy_renderer();
@@ -265,36 +460,37 @@ private:
     std::unique_ptr<UiSystem> ui_;
     VkFormat imgui_format_{VK_FORMAT_UNDEFINED};
 #ifdef VV_ENABLE_LOGGING
-    std::vector<std::string> log_lines_;
+    std::string log_file_{};
 #endif
     std::vector<std::function<void()>> mdq_;
 
+    std::unique_ptr<vv::GpuProfiler> gpu_profiler_; // stays null without VV_ENABLE_GPU_TIMESTAMPS; zones then compile to no-ops
 #ifdef VV_ENABLE_GPU_TIMESTAMPS
-    VkQueryPool ts_query_pool_{};
-    double ts_period_ns_{1.0};
-    double last_gpu_ms_{0.0};
-    void create_timestamp_pool();
-    void destroy_timestamp_pool();
+    void create_gpu_profiler();
+    void destroy_gpu_profiler();
 #endif
 
 #ifdef VV_ENABLE_SCREENSHOT
     struct PendingScreenshot { bool request{false}; std::string path; } screenshot_{};
+    struct ScreenshotSystem; // readback ring + PNG encoder thread, implemented privately
+    std::unique_ptr<ScreenshotSystem> screenshots_;
     void queue_swapchain_screenshot(VkCommandBuffer cmd, uint32_t imageIndex);
 #endif
 
 #ifdef VV_ENABLE_HOTRELOAD
-    struct WatchItem { std::string path; uint64_t stamp{}; };
-    std::vector<WatchItem> watch_list_;
-    double watch_accum_{0.0};
+    std::unique_ptr<vv::FileWatcher> file_watcher_; // inotify thread (polling thread elsewhere); the frame loop only takes settled batches
     void poll_file_watches(const EngineContext& eng);
 #endif
 
 #ifdef VV_ENABLE_TONEMAP
-    bool use_srgb_swapchain_{false};
-    bool tonemap_enabled_{false};
+    bool srgb_swapchain_{false};  // Controls tab; applied on the next swapchain recreation
+    bool tonemap_enabled_{true};  // per frame: tonemap pass, or the plain blit
+    std::unique_ptr<vv::ToneMapper> tonemapper_; // EngineBlit with a floating-point presented attachment only
+    void create_tonemapper();
+    void destroy_tonemapper();
 #endif
 
-    struct EngineState { uint32_t width{1280}; uint32_t height{720}; std::string name{"Vulkan Visualizer"}; bool running{false}; bool initialized{false}; bool should_rendering{false}; bool resize_requested{false}; bool minimized{false}; bool focused{true}; uint64_t frame_number{0}; double time_sec{0.0}; double dt_sec{0.0}; } state_;
+    struct EngineState { uint32_t width{1280}; uint32_t height{720}; std::string name{"Vulkan Visualizer"}; bool running{false}; bool initialized{false}; bool should_rendering{false}; bool resize_requested{false}; bool headless{false}; bool minimized{false}; bool focused{true}; bool targets_dirty{false}; uint64_t frame_number{0}; double time_sec{0.0}; double dt_sec{0.0}; } state_;
 };
 
 #endif // VULKAN_VISUALIZER_VK_ENGINE_H
@@ -0,0 +1,88 @@
+#ifndef VULKAN_VISUALIZER_VV_BINDLESS_H
+#define VULKAN_VISUALIZER_VV_BINDLESS_H
+
+#include <vulkan/vulkan.h>
+
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace vv {
+
+// One engine-owned descriptor set holding every registered resource, indexed from shaders through push constants.
+// Resources are written once when added; the set is UPDATE_AFTER_BIND and PARTIALLY_BOUND, so adding entries never
+// touches sets already bound by frames in flight. Shader side (set 0, GL_EXT_nonuniform_qualifier):
+//   layout(set = 0, binding = 0, rgba8) uniform image2D   vv_storage_images[];  // format per declaration
+//   layout(set = 0, binding = 1)        uniform sampler2D vv_sampled_images[];
+//   layout(set = 0, binding = 2)        buffer VvBuffer { uint data[]; } vv_storage_buffers[];
+// Sampled image and storage buffer indices may be nonuniformEXT(...). Storage image ones only when
+// storage_image_nonuniform() (shaderStorageImageArrayNonUniformIndexing is optional); otherwise they must be dynamically
+// uniform, e.g. taken from push constants. Released indices are reused only once the render timeline passed the value
+// given to release().
+class BindlessHeap {
+public:
+    enum class Table : uint32_t { StorageImage = 0, SampledImage = 1, StorageBuffer = 2 }; // value = binding
+    static constexpr uint32_t invalid = UINT32_MAX;
+    static constexpr uint32_t push_constant_bytes = 128; // guaranteed minimum maxPushConstantsSize
+
+    struct Capacity {
+        uint32_t storage_images{1024};
+        uint32_t sampled_images{4096};
+        uint32_t storage_buffers{4096};
+    };
+
+    struct Stats {
+        std::array<uint32_t, 3> used{};     // live entries per table
+        std::array<uint32_t, 3> capacity{}; // after clamping to device limits
+        uint64_t writes{0};                 // descriptor writes since init
+        uint32_t pending_release{0};
+    };
+
+    // `storage_image_nonuniform`: the device was created with shaderStorageImageArrayNonUniformIndexing
+    bool init(VkDevice device, VkPhysicalDevice physical, VkSemaphore timeline, const Capacity& capacity, bool storage_image_nonuniform);
+    void shutdown(); // device must be idle
+
+    // Each returns the array index to hand to shaders, or invalid when the table is full
+    uint32_t add_storage_image(VkImageView view, VkImageLayout layout = VK_IMAGE_LAYOUT_GENERAL);
+    uint32_t add_sampled_image(VkImageView view, VkSampler sampler, VkImageLayout layout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+    uint32_t add_storage_buffer(VkBuffer buffer, VkDeviceSize offset = 0, VkDeviceSize range = VK_WHOLE_SIZE);
+    // `value`: render timeline value after which no frame reads the entry (RetireQueue::frame_value() while recording).
+    // Entries are never rewritten in place: to point at a new view after a resize, release the old index and add again.
+    void release(Table table, uint32_t index, uint64_t value);
+    void collect(); // engine, once per frame: recycles indices whose release value the timeline has reached
+
+    // Set 0 + push_constant_bytes of push constants for all stages. Pipelines built on it share the binding: bind() once
+    // per command buffer and bind point, then switch pipelines freely.
+    [[nodiscard]] VkPipelineLayout pipeline_layout() const { return pipeline_layout_; }
+    [[nodiscard]] VkDescriptorSetLayout set_layout() const { return set_layout_; } // for renderer layouts with more sets
+    [[nodiscard]] VkDescriptorSet set() const { return set_; }
+    void bind(VkCommandBuffer cmd, VkPipelineBindPoint bind_point, VkPipelineLayout layout = VK_NULL_HANDLE) const;
+
+    [[nodiscard]] const Stats& stats() const { return stats_; }
+    [[nodiscard]] bool storage_image_nonuniform() const { return storage_image_nonuniform_; }
+
+    // ImGui (Stats tab): table occupancy
+    void imgui_panel_contents() const;
+
+private:
+    struct Slots { uint32_t next{0}; std::vector<uint32_t> free; };
+    struct Release { uint64_t value; Table table; uint32_t index; };
+
+    uint32_t acquire(Table table);
+    void write(Table table, uint32_t index, const VkDescriptorImageInfo* image, const VkDescriptorBufferInfo* buffer);
+
+    VkDevice device_{VK_NULL_HANDLE};
+    VkSemaphore timeline_{VK_NULL_HANDLE};
+    VkDescriptorSetLayout set_layout_{VK_NULL_HANDLE};
+    VkPipelineLayout pipeline_layout_{VK_NULL_HANDLE};
+    VkDescriptorPool pool_{VK_NULL_HANDLE};
+    VkDescriptorSet set_{VK_NULL_HANDLE};
+    std::array<Slots, 3> slots_{};
+    std::vector<Release> releases_{};
+    Stats stats_{};
+    bool storage_image_nonuniform_{false};
+};
+
+} // namespace vv
+
+#endif // VULKAN_VISUALIZER_VV_BINDLESS_H
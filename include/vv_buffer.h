@@ -0,0 +1,41 @@
+#ifndef VULKAN_VISUALIZER_VV_BUFFER_H
+#define VULKAN_VISUALIZER_VV_BUFFER_H
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+
+struct VmaAllocator_T; using VmaAllocator = VmaAllocator_T*;
+struct VmaAllocation_T; using VmaAllocation = VmaAllocation_T*;
+
+namespace vv {
+
+class RetireQueue;
+
+// Buffer read from shaders by address (GL_EXT_buffer_reference, see include/shaders/vv_pull.glsl): no descriptor set and
+// no vertex input state. Pass `address` through push constants; attribute streams can stay in their CPU layout (SoA).
+struct DeviceBuffer {
+    VkBuffer buffer{VK_NULL_HANDLE};
+    VmaAllocation allocation{nullptr};
+    VkDeviceAddress address{0};
+    VkDeviceSize size{0};
+    void* mapped{nullptr}; // HostWrite only; persistently mapped by VMA, never vmaUnmapMemory it
+};
+
+enum class BufferAccess : uint8_t {
+    DeviceLocal, // filled through EngineContext::uploads or GPU writes
+    HostWrite,   // rewritten by the CPU (e.g. every frame): device-local when ReBAR/UMA memory exists, host memory otherwise
+};
+
+// SHADER_DEVICE_ADDRESS and STORAGE_BUFFER are added to `usage`. Needs RendererCaps::buffer_device_address (default on).
+[[nodiscard]] DeviceBuffer create_device_buffer(VkDevice device, VmaAllocator allocator, VkDeviceSize size, VkBufferUsageFlags usage, BufferAccess access);
+[[nodiscard]] VkDeviceAddress buffer_address(VkDevice device, VkBuffer buffer);
+void retire_device_buffer(RetireQueue& queue, DeviceBuffer& buffer, uint64_t value); // resets `buffer`
+
+// Pipelines that pull their vertices: no bindings, no attributes. Point, line and triangle pipelines over the same
+// streams then differ only in topology and can share one pipeline layout.
+inline constexpr VkPipelineVertexInputStateCreateInfo no_vertex_input{.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO, .pNext = nullptr, .flags = 0u, .vertexBindingDescriptionCount = 0u, .pVertexBindingDescriptions = nullptr, .vertexAttributeDescriptionCount = 0u, .pVertexAttributeDescriptions = nullptr};
+
+} // namespace vv
+
+#endif // VULKAN_VISUALIZER_VV_BUFFER_H
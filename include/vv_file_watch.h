@@ -0,0 +1,77 @@
+#ifndef VULKAN_VISUALIZER_VV_FILE_WATCH_H
+#define VULKAN_VISUALIZER_VV_FILE_WATCH_H
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace vv {
+
+// Watches files and directory trees on a background thread and hands out debounced batches of changed paths. On Linux
+// the thread blocks on inotify (new subdirectories are picked up as they appear); elsewhere it rescans the trees off the
+// render thread and diffs modification times. A batch is published once no event arrived for `debounce`, so an editor's
+// write-rename-chmod burst turns into one reload.
+class FileWatcher {
+public:
+    struct Stats {
+        uint64_t events{0};  // raw notifications (or detected differences when polling)
+        uint64_t batches{0}; // batches published
+        uint32_t watches{0}; // directories (and files) registered with the OS
+        uint32_t overflows{0};
+    };
+
+    FileWatcher() = default;
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+    ~FileWatcher() { shutdown(); }
+
+    bool start(std::chrono::milliseconds debounce = std::chrono::milliseconds(100));
+    void shutdown();
+
+    bool add(const std::filesystem::path& path); // file or directory (recursive); may be called before or after start()
+
+    // Non-blocking: the paths changed since the last call, deduplicated and sorted; empty when nothing settled yet
+    [[nodiscard]] std::vector<std::filesystem::path> take_changes();
+
+    [[nodiscard]] Stats stats() const { std::scoped_lock lock(mutex_); return stats_; }
+
+    // ImGui (Stats tab): backend, watch count, last batch
+    void imgui_panel_contents() const;
+
+private:
+    void thread_main();
+    void publish(std::set<std::filesystem::path>& pending);
+#ifdef __linux__
+    void watch_tree(const std::filesystem::path& root);
+    int inotify_fd_{-1};
+    int wake_fd_{-1};
+    std::unordered_map<int, std::filesystem::path> dirs_{}; // watch descriptor -> watched path
+#else
+    void scan(std::unordered_map<std::string, std::filesystem::file_time_type>& into) const;
+    std::condition_variable cv_{};
+#endif
+
+    struct Root {
+        std::filesystem::path path;
+        bool directory{false}; // recorded by add(): event matching never touches the filesystem
+    };
+    std::vector<Root> roots_{};
+    std::chrono::milliseconds debounce_{100};
+    mutable std::mutex mutex_{};
+    std::vector<std::filesystem::path> ready_{};
+    std::vector<std::filesystem::path> last_batch_{};
+    std::thread thread_{};
+    bool stop_{false};
+    Stats stats_{};
+};
+
+} // namespace vv
+
+#endif // VULKAN_VISUALIZER_VV_FILE_WATCH_H
@@ -0,0 +1,65 @@
+#ifndef VULKAN_VISUALIZER_VV_LOG_H
+#define VULKAN_VISUALIZER_VV_LOG_H
+
+#include <atomic>
+#include <cstdarg>
+#include <cstdint>
+#include <string_view>
+
+namespace vv {
+
+enum class LogLevel : uint8_t { Debug = 0, Info = 1, Warn = 2, Error = 3 };
+
+// Process-wide logger. write() formats into a slot of a fixed lock-free multi-producer ring and returns: no lock, no
+// allocation, no I/O on the calling thread. A sink thread (start()) moves records to stderr, an optional file and the
+// fixed history the Log tab shows. A full ring drops the record and counts it rather than block the producer.
+class Log {
+public:
+    static constexpr uint32_t ring_records    = 1u << 12; // power of two
+    static constexpr uint32_t history_records = 1u << 12; // kept for the panel
+    static constexpr uint32_t record_chars    = 232;      // longer messages are truncated
+
+    struct Record {
+        uint64_t time_ns;  // since the first record
+        uint32_t thread;   // small per-thread index, 1 = first thread that logged
+        LogLevel level;
+        uint16_t length;
+        char text[record_chars];
+    };
+
+#if defined(__GNUC__) || defined(__clang__)
+    __attribute__((format(printf, 2, 3)))
+#endif
+    static void write(LogLevel level, const char* fmt, ...);
+    static void writev(LogLevel level, const char* fmt, va_list args);
+
+    [[nodiscard]] static bool enabled(LogLevel level) { return static_cast<uint8_t>(level) >= min_level_.load(std::memory_order_relaxed); }
+    static void set_min_level(LogLevel level) { min_level_.store(static_cast<uint8_t>(level), std::memory_order_relaxed); }
+
+    // Starts the sink thread (idempotent); records written before it wait in the ring. An empty path logs to stderr only.
+    static void start(std::string_view file_path = {});
+    static void stop(); // drains the ring, flushes and joins the sink
+    [[nodiscard]] static uint64_t dropped();
+
+    // ImGui (Log tab): level and text filters over the history, drawn through ImGuiListClipper
+    static void imgui_panel_contents();
+
+private:
+    static inline std::atomic<uint8_t> min_level_{static_cast<uint8_t>(LogLevel::Info)};
+};
+
+} // namespace vv
+
+#ifdef VV_ENABLE_LOGGING
+#define VV_LOG_DEBUG(fmt, ...) do { if (::vv::Log::enabled(::vv::LogLevel::Debug)) ::vv::Log::write(::vv::LogLevel::Debug, fmt, ##__VA_ARGS__); } while(0)
+#define VV_LOG_INFO(fmt, ...)  do { if (::vv::Log::enabled(::vv::LogLevel::Info))  ::vv::Log::write(::vv::LogLevel::Info, fmt, ##__VA_ARGS__); } while(0)
+#define VV_LOG_WARN(fmt, ...)  do { if (::vv::Log::enabled(::vv::LogLevel::Warn))  ::vv::Log::write(::vv::LogLevel::Warn, fmt, ##__VA_ARGS__); } while(0)
+#define VV_LOG_ERROR(fmt, ...) do { if (::vv::Log::enabled(::vv::LogLevel::Error)) ::vv::Log::write(::vv::LogLevel::Error, fmt, ##__VA_ARGS__); } while(0)
+#else
+#define VV_LOG_DEBUG(...) do {} while(0)
+#define VV_LOG_INFO(...)  do {} while(0)
+#define VV_LOG_WARN(...)  do {} while(0)
+#define VV_LOG_ERROR(...) do {} while(0)
+#endif
+
+#endif // VULKAN_VISUALIZER_VV_LOG_H
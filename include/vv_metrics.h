@@ -0,0 +1,97 @@
+#ifndef VULKAN_VISUALIZER_VV_METRICS_H
+#define VULKAN_VISUALIZER_VV_METRICS_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace vv {
+
+// Named per-frame time series (EngineContext::metrics). Registration allocates a fixed ring of `history` samples; after
+// that set()/add() are one relaxed atomic store/add from any thread and end_frame() (engine, once per frame) appends one
+// sample per metric. The Metrics tab plots every series with p50/p95/p99, pinned series also go to a HUD overlay, and
+// frames whose hitch metric (default "frame_ms") exceeds hitch_factor x the median of its window are flagged and logged.
+class MetricsRegistry {
+public:
+    static constexpr uint32_t history      = 600; // samples (frames) per series
+    static constexpr uint32_t hitch_events = 64;  // most recent hitches kept
+    static constexpr uint32_t max_metrics  = 64;
+
+    using MetricId = uint32_t;
+    static constexpr MetricId invalid = UINT32_MAX;
+
+    enum class Kind : uint8_t {
+        Gauge,   // sample = last set() value (kept until set again)
+        Counter, // sample = sum of add() since the previous sample
+    };
+    struct Summary { float last{}; float min{}; float max{}; float mean{}; float p50{}; float p95{}; float p99{}; uint32_t count{}; };
+    struct Hitch { uint64_t frame; float value; float median; };
+
+    MetricsRegistry();
+
+    // Returns the existing id when `name` is already registered (kinds must match, otherwise `invalid`; also when full)
+    MetricId gauge(std::string_view name, std::string_view unit = {}, bool hud = false);
+    MetricId counter(std::string_view name, std::string_view unit = {}, bool hud = false);
+    [[nodiscard]] MetricId find(std::string_view name) const;
+
+    void set(MetricId id, double value);
+    void add(MetricId id, double delta = 1.0);
+
+    // Engine, main thread: closes the frame
+    void end_frame(uint64_t frame_index);
+
+    [[nodiscard]] Summary summary(MetricId id) const; // over the retained window; main thread
+    [[nodiscard]] uint64_t hitch_count() const { return hitch_total_; }
+    void set_hitch_metric(MetricId id) { hitch_metric_ = id; }
+    void set_hitch_factor(float k) { hitch_factor_ = k; } // k x median; <= 1 disables
+
+    // One row per retained frame, one column per metric plus a hitch flag. Empty path: metrics_<date>_<time>.csv
+    bool export_csv(std::string path = {}) const;
+
+    // ImGui: Metrics tab contents, and the HUD drawn as an overlay
+    void imgui_panel_contents();
+    void imgui_hud();
+
+private:
+    struct Metric {
+        std::string name;
+        std::string unit;
+        Kind kind{Kind::Gauge};
+        bool hud{false};
+        std::atomic<double> current{0.0};
+        std::array<float, history> samples{};
+    };
+
+    MetricId add_metric(std::string_view name, std::string_view unit, Kind kind, bool hud);
+    [[nodiscard]] std::span<Metric> registered() const { return {metrics_->data(), count_metrics_.load(std::memory_order_acquire)}; }
+    bool write_csv(const std::string& path) const; // mutex_ held
+    [[nodiscard]] Summary summarize(const Metric& m) const;
+    [[nodiscard]] uint32_t oldest() const { return (head_ + history - count_) % history; }
+    void plot(const Metric& m, const Summary& s, float width, float height) const;
+    void sparkline(const Metric& m, float x, float y, float width, float height, float scale_max) const; // HUD, foreground draw list
+
+    mutable std::mutex mutex_{}; // registration vs the frame; never taken by set()/add()
+    std::unique_ptr<std::array<Metric, max_metrics>> metrics_; // preallocated: set()/add() index it without a lock
+    std::atomic<uint32_t> count_metrics_{0};                  // published after the metric is filled in
+    mutable std::vector<float> scratch_{};  // percentile selection, sized once
+    std::array<uint64_t, history> frames_{}; // frame index of each sample slot
+    std::array<uint8_t, history> hitch_{};   // per sample slot: the frame was flagged
+    uint32_t head_{0};  // next slot
+    uint32_t count_{0}; // retained samples (<= history)
+    MetricId hitch_metric_{invalid};
+    float hitch_factor_{3.0f};
+    uint32_t hitch_warmup_{60}; // samples before the median is trusted
+    std::array<Hitch, hitch_events> hitches_{};
+    uint64_t hitch_total_{0};
+    bool hud_{true};
+};
+
+} // namespace vv
+
+#endif // VULKAN_VISUALIZER_VV_METRICS_H
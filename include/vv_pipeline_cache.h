@@ -0,0 +1,57 @@
+#ifndef VULKAN_VISUALIZER_VV_PIPELINE_CACHE_H
+#define VULKAN_VISUALIZER_VV_PIPELINE_CACHE_H
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <string>
+
+namespace vv {
+
+// Engine-owned VkPipelineCache persisted between runs. The file is keyed by vendor/device id and only loaded when its
+// header matches the running driver (version and pipelineCacheUUID) and its payload checksum is intact; anything else
+// starts cold. create() chains VkPipelineCreationFeedback into the create info to count cache hits and misses.
+class PipelineCache {
+public:
+    struct Stats {
+        uint32_t hits{0};
+        uint32_t misses{0};
+        uint32_t unreported{0}; // driver left the feedback invalid
+        double create_ms{0.0};  // CPU time spent in vkCreate*Pipelines through create()
+        size_t loaded_bytes{0};
+        size_t saved_bytes{0};
+    };
+
+    bool init(VkDevice device, VkPhysicalDevice physical, const std::filesystem::path& directory);
+    void shutdown(); // saves when pipelines were compiled since the load
+
+    bool save();
+    [[nodiscard]] VkPipelineCache handle() const { return cache_; }
+
+    VkResult create(const VkGraphicsPipelineCreateInfo& info, VkPipeline* pipeline);
+    VkResult create(const VkComputePipelineCreateInfo& info, VkPipeline* pipeline);
+
+    [[nodiscard]] Stats stats() const { std::scoped_lock lock(mutex_); return stats_; }
+    [[nodiscard]] const std::string& load_status() const { return load_status_; }
+    [[nodiscard]] const std::filesystem::path& path() const { return path_; }
+
+    // ImGui (Stats tab): load result, hit/miss counts, compile time, save button
+    void imgui_panel_contents();
+
+private:
+    void record(const VkPipelineCreationFeedback& feedback, double ms);
+
+    VkDevice device_{VK_NULL_HANDLE};
+    VkPipelineCache cache_{VK_NULL_HANDLE};
+    VkPhysicalDeviceProperties props_{};
+    std::filesystem::path path_{};
+    std::string load_status_{};
+    mutable std::mutex mutex_{}; // create() may run on worker threads; the cache itself is internally synchronized
+    Stats stats_{};
+};
+
+} // namespace vv
+
+#endif // VULKAN_VISUALIZER_VV_PIPELINE_CACHE_H
@@ -0,0 +1,195 @@
+#ifndef VULKAN_VISUALIZER_VV_PROFILER_H
+#define VULKAN_VISUALIZER_VV_PROFILER_H
+
+#include <vulkan/vulkan.h>
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace vv {
+
+// VK_QUERY_TYPE_PIPELINE_STATISTICS counters of one zone (or the sum of a frame's zones)
+struct PipelineCounters {
+    uint64_t input_vertices{};       // input assembly vertices
+    uint64_t input_primitives{};     // input assembly primitives
+    uint64_t vertex_invocations{};
+    uint64_t clipping_invocations{}; // primitives reaching the clipper
+    uint64_t clipping_primitives{};  // primitives leaving it (rasterized)
+    uint64_t fragment_invocations{};
+    uint64_t compute_invocations{};
+    PipelineCounters& operator+=(const PipelineCounters& o);
+};
+
+enum class ZoneFlags : uint32_t {
+    None          = 0,
+    // Also collect pipeline statistics; ignored while another statistics zone is open on the thread. Such a zone must not
+    // span vkCmdExecuteCommands (inheritedQueries is not enabled).
+    PipelineStats = 1u << 0,
+};
+
+// GPU timestamp zones. One growable query pool per frame in flight; results of a slot are read back (without waiting)
+// once the engine has waited that slot's render timeline value, and kept as a ring of the last `history_frames` frames.
+class GpuProfiler {
+public:
+    static constexpr uint32_t history_frames = 120;
+
+    struct ZoneStats {
+        std::string path;   // "compute/jacobi"
+        std::string name;   // "jacobi"
+        uint32_t depth{0};  // 0 = frame root
+        double last_ms{0.0};
+        double min_ms{0.0};
+        double avg_ms{0.0};
+        double p99_ms{0.0};
+        bool has_pipeline{false};
+        PipelineCounters pipeline{}; // last resolved frame
+    };
+
+    // Returns false when the queue family cannot write timestamps (timestampValidBits == 0).
+    bool init(VkPhysicalDevice physical, VkDevice device, uint32_t queue_family, uint32_t frames_in_flight);
+    void shutdown();
+    // Needs VK_EXT_calibrated_timestamps enabled on the device; lets resolved zones be merged into CpuTracer captures.
+    bool enable_calibration(VkInstance instance, VkPhysicalDevice physical);
+    [[nodiscard]] bool calibrated() const { return get_calibrated_ != nullptr; }
+    // Needs VkPhysicalDeviceFeatures::pipelineStatisticsQuery; enables ZoneFlags::PipelineStats.
+    void enable_pipeline_statistics();
+    [[nodiscard]] bool pipeline_statistics() const { return stats_enabled_; }
+
+    // Called by the engine right after the slot's timeline wait and vkBeginCommandBuffer / before vkEndCommandBuffer.
+    void begin_frame(VkCommandBuffer cmd, uint32_t frame_slot);
+    void end_frame(VkCommandBuffer cmd);
+
+    // Thread-safe: zones may be opened from worker threads recording secondary command buffers.
+    // Pipeline statistics queries cannot nest and must begin/end on the same side of a rendering scope.
+    [[nodiscard]] uint32_t begin_zone(VkCommandBuffer cmd, std::string_view name, ZoneFlags flags = ZoneFlags::None);
+    void end_zone(VkCommandBuffer cmd, uint32_t zone);
+
+    [[nodiscard]] double frame_ms() const { return frame_ms_; }
+    [[nodiscard]] double zone_ms(std::string_view path) const;
+    [[nodiscard]] std::vector<ZoneStats> stats() const; // depth-first, in last resolved frame order
+    [[nodiscard]] PipelineCounters pipeline_totals() const; // sum over the last resolved frame's statistics zones
+    [[nodiscard]] double period_ns() const { return period_ns_; }
+
+    // ImGui (Stats tab): indented zone tree with last/min/avg/p99, then the pipeline statistics zones
+    void imgui_panel_contents() const;
+
+    // Profiler that `gpu_zone(cmd, name)` records into; set by the engine while it owns one.
+    static GpuProfiler* active() { return active_.load(std::memory_order_acquire); }
+    static void set_active(GpuProfiler* p) { active_.store(p, std::memory_order_release); }
+
+private:
+    struct Zone { std::string name; uint32_t parent{UINT32_MAX}; uint32_t depth{0}; uint32_t stats_query{UINT32_MAX}; }; // timestamps 2*i / 2*i+1
+    struct Slot {
+        VkQueryPool pool{VK_NULL_HANDLE};
+        uint32_t capacity{0};
+        uint32_t used{0};
+        bool overflow{false};
+        VkQueryPool stats_pool{VK_NULL_HANDLE};
+        uint32_t stats_capacity{0};
+        uint32_t stats_used{0};
+        bool stats_overflow{false};
+        std::vector<Zone> zones;
+    };
+    struct History {
+        std::array<float, history_frames> samples{};
+        uint32_t count{0};
+        uint32_t head{0};
+        uint32_t depth{0};
+        std::string name;
+        bool has_pipeline{false};
+        PipelineCounters pipeline{};
+        void push(float v) { samples[head] = v; head = (head + 1) % history_frames; count = count < history_frames ? count + 1 : count; }
+    };
+
+    void create_pool(Slot& slot, uint32_t capacity);
+    void create_stats_pool(Slot& slot, uint32_t capacity);
+    void resolve(Slot& slot);
+    bool calibrate(uint64_t& gpu_ticks, uint64_t& host_ns) const;
+
+    VkDevice device_{VK_NULL_HANDLE};
+    double period_ns_{1.0};
+    uint64_t valid_mask_{~0ull};
+    std::vector<Slot> slots_{};
+    Slot* current_{nullptr};
+    mutable std::mutex mutex_{};
+    double frame_ms_{0.0};
+    std::unordered_map<std::string, History> history_{};
+    std::vector<std::string> order_{}; // paths of the last resolved frame, depth-first
+    PFN_vkGetCalibratedTimestampsEXT get_calibrated_{nullptr};
+    VkTimeDomainEXT host_domain_{VK_TIME_DOMAIN_DEVICE_EXT};
+    double host_tick_ns_{1.0};
+    bool stats_enabled_{false};
+
+    static inline std::atomic<GpuProfiler*> active_{nullptr};
+};
+
+// RAII GPU zone:  vv::gpu_zone z(cmd, "jacobi");  vv::gpu_zone z(cmd, "raymarch", vv::ZoneFlags::PipelineStats);
+class gpu_zone {
+public:
+    gpu_zone(VkCommandBuffer cmd, std::string_view name, ZoneFlags flags = ZoneFlags::None) : gpu_zone(GpuProfiler::active(), cmd, name, flags) {}
+    gpu_zone(GpuProfiler* profiler, VkCommandBuffer cmd, std::string_view name, ZoneFlags flags = ZoneFlags::None) : profiler_(profiler), cmd_(cmd) { if (profiler_) zone_ = profiler_->begin_zone(cmd_, name, flags); }
+    ~gpu_zone() { if (profiler_) profiler_->end_zone(cmd_, zone_); }
+    gpu_zone(const gpu_zone&)            = delete;
+    gpu_zone& operator=(const gpu_zone&) = delete;
+
+private:
+    GpuProfiler* profiler_{nullptr};
+    VkCommandBuffer cmd_{VK_NULL_HANDLE};
+    uint32_t zone_{UINT32_MAX};
+};
+
+// CPU trace zones. Each thread records into its own ring (registered once under a lock); the hot path is two clock
+// reads and a release store, and zones cost a single relaxed load unless a capture is running. Captures are written as
+// Chrome trace JSON (chrome://tracing, ui.perfetto.dev), with GPU zones on the same timeline when calibrated.
+class CpuTracer {
+public:
+    static constexpr uint32_t ring_events  = 1u << 15; // per thread
+    static constexpr uint32_t drain_frames = 5u;       // frames after the capture window for GPU zones to resolve
+
+    struct Event { const char* name; uint64_t begin_ns; uint64_t end_ns; uint32_t depth; };
+
+    [[nodiscard]] static uint64_t now_ns(); // steady_clock; the host time domain GPU zones are calibrated against
+    [[nodiscard]] static bool recording() { return recording_.load(std::memory_order_relaxed); }
+    static uint32_t enter();                                            // returns the depth of the opened zone
+    static void leave(const char* name, uint64_t begin_ns, uint32_t depth); // `name` must outlive the capture
+    static void set_thread_name(std::string_view name);
+
+    // Capture the next `frames` frames; an empty path picks trace_<date>_<time>.json. Frame boundaries come from
+    // frame_mark(), which the engine calls once per loop iteration on the main thread.
+    static void request_capture(uint32_t frames, std::string path = {});
+    static void frame_mark();
+    [[nodiscard]] static bool capture_busy();
+    [[nodiscard]] static bool accepts_gpu_events();
+    static void add_gpu_event(std::string_view name, uint64_t begin_ns, uint64_t end_ns, uint32_t depth);
+    [[nodiscard]] static std::vector<std::string> drain_messages();
+
+    // ImGui (Stats tab): frame count + capture button
+    static void imgui_panel_contents();
+
+private:
+    static inline std::atomic<bool> recording_{false};
+};
+
+// RAII CPU zone:  vv::cpu_zone z("simulate");  (string literal or other storage that outlives the capture)
+class cpu_zone {
+public:
+    explicit cpu_zone(const char* name) : name_(CpuTracer::recording() ? name : nullptr) { if (name_) { begin_ = CpuTracer::now_ns(); depth_ = CpuTracer::enter(); } }
+    ~cpu_zone() { if (name_) CpuTracer::leave(name_, begin_, depth_); }
+    cpu_zone(const cpu_zone&)            = delete;
+    cpu_zone& operator=(const cpu_zone&) = delete;
+
+private:
+    const char* name_{nullptr};
+    uint64_t begin_{0};
+    uint32_t depth_{0};
+};
+
+} // namespace vv
+
+#endif // VULKAN_VISUALIZER_VV_PROFILER_H
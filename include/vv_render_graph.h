@@ -0,0 +1,166 @@
+#ifndef VULKAN_VISUALIZER_VV_RENDER_GRAPH_H
+#define VULKAN_VISUALIZER_VV_RENDER_GRAPH_H
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+namespace vv {
+
+// How a pass touches a resource. `layout` is ignored for buffers.
+struct ResourceUse {
+    VkPipelineStageFlags2 stages{VK_PIPELINE_STAGE_2_NONE};
+    VkAccessFlags2 access{VK_ACCESS_2_NONE};
+    VkImageLayout layout{VK_IMAGE_LAYOUT_UNDEFINED};
+};
+
+// Common uses; combine several on one resource in the same pass with repeated PassBuilder::use() calls.
+namespace use {
+    inline constexpr ResourceUse color_attachment{VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_2_COLOR_ATTACHMENT_READ_BIT | VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL};
+    inline constexpr ResourceUse color_attachment_write{VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT, VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL}; // loadOp CLEAR / DONT_CARE
+    inline constexpr ResourceUse depth_attachment{VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT, VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT | VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT, VK_IMAGE_LAYOUT_DEPTH_STENCIL_ATTACHMENT_OPTIMAL};
+    inline constexpr ResourceUse depth_read{VK_PIPELINE_STAGE_2_EARLY_FRAGMENT_TESTS_BIT | VK_PIPELINE_STAGE_2_LATE_FRAGMENT_TESTS_BIT, VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_READ_BIT, VK_IMAGE_LAYOUT_DEPTH_STENCIL_READ_ONLY_OPTIMAL};
+    inline constexpr ResourceUse sampled_fragment{VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT, VK_ACCESS_2_SHADER_SAMPLED_READ_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL};
+    inline constexpr ResourceUse sampled_compute{VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_SAMPLED_READ_BIT, VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL};
+    // Storage images (GENERAL) and storage buffers
+    inline constexpr ResourceUse storage_read_compute{VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_READ_BIT, VK_IMAGE_LAYOUT_GENERAL};
+    inline constexpr ResourceUse storage_write_compute{VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT, VK_IMAGE_LAYOUT_GENERAL};
+    inline constexpr ResourceUse storage_rw_compute{VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT, VK_IMAGE_LAYOUT_GENERAL};
+    inline constexpr ResourceUse storage_read_vertex{VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_READ_BIT, VK_IMAGE_LAYOUT_GENERAL};
+    inline constexpr ResourceUse storage_read_fragment{VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT, VK_ACCESS_2_SHADER_STORAGE_READ_BIT, VK_IMAGE_LAYOUT_GENERAL};
+    inline constexpr ResourceUse transfer_src{VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_READ_BIT, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL};
+    inline constexpr ResourceUse transfer_dst{VK_PIPELINE_STAGE_2_TRANSFER_BIT, VK_ACCESS_2_TRANSFER_WRITE_BIT, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL};
+    inline constexpr ResourceUse present{VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, VK_ACCESS_2_NONE, VK_IMAGE_LAYOUT_PRESENT_SRC_KHR};
+    // Buffers only
+    inline constexpr ResourceUse vertex_input{VK_PIPELINE_STAGE_2_VERTEX_ATTRIBUTE_INPUT_BIT, VK_ACCESS_2_VERTEX_ATTRIBUTE_READ_BIT};
+    inline constexpr ResourceUse index_input{VK_PIPELINE_STAGE_2_INDEX_INPUT_BIT, VK_ACCESS_2_INDEX_READ_BIT};
+    inline constexpr ResourceUse indirect_args{VK_PIPELINE_STAGE_2_DRAW_INDIRECT_BIT, VK_ACCESS_2_INDIRECT_COMMAND_READ_BIT};
+    inline constexpr ResourceUse uniform_read{VK_PIPELINE_STAGE_2_VERTEX_SHADER_BIT | VK_PIPELINE_STAGE_2_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, VK_ACCESS_2_UNIFORM_READ_BIT};
+} // namespace use
+
+// Per-frame render graph. Passes declare how they use imported images and buffers; execute() culls passes that contribute
+// to no output, then records each remaining pass behind a single vkCmdPipelineBarrier2 carrying only the barriers its uses
+// need (RAW/WAR/WAW hazards and layout changes against the tracked state), and a GPU zone named after the pass.
+// Image and buffer state is tracked per handle and carried over to the next frame, so layouts persist across frames.
+class RenderGraph {
+public:
+    using ResourceId = uint32_t;
+    static constexpr ResourceId invalid = UINT32_MAX;
+
+    class PassBuilder {
+    public:
+        PassBuilder& use(ResourceId id, const ResourceUse& u); // uses of one resource are merged; their layouts must agree
+        PassBuilder& side_effect();                             // never culled (readbacks, host-visible results)
+
+    private:
+        friend class RenderGraph;
+        PassBuilder(RenderGraph& graph, uint32_t pass) : graph_(graph), pass_(pass) {}
+        RenderGraph& graph_;
+        uint32_t pass_;
+    };
+
+    // Range of pass indices (in add_pass order) that use a resource in the last execute(); empty if no kept pass does
+    struct Lifetime {
+        uint32_t first{UINT32_MAX};
+        uint32_t last{0};
+        [[nodiscard]] bool empty() const { return first > last; }
+        [[nodiscard]] bool overlaps(const Lifetime& o) const { return !empty() && !o.empty() && first <= o.last && o.first <= last; }
+        bool operator==(const Lifetime&) const = default;
+    };
+
+    struct Stats {
+        uint32_t passes{0};          // executed
+        uint32_t culled{0};
+        uint32_t barrier_batches{0}; // vkCmdPipelineBarrier2 calls
+        uint32_t image_barriers{0};
+        uint32_t buffer_barriers{0};
+    };
+
+    // `initial` is the state of a handle the graph has not seen yet (the last use before the graph, treated as a write).
+    // Non-persistent images (swapchain images) start from `initial` every frame and keep no state.
+    ResourceId import_image(std::string_view name, VkImage image, VkImageAspectFlags aspect, const ResourceUse& initial, bool persistent = true);
+    // Image sharing memory `memory` with other transient images: its contents start undefined every frame, and its first use
+    // waits for everything done to that memory before (by any alias, in this frame or the previous one)
+    ResourceId import_transient_image(std::string_view name, VkImage image, VkImageAspectFlags aspect, uint32_t memory);
+    ResourceId import_buffer(std::string_view name, VkBuffer buffer, const ResourceUse& initial = {VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, VK_ACCESS_2_MEMORY_WRITE_BIT});
+    [[nodiscard]] ResourceId find(std::string_view name) const;
+
+    PassBuilder add_pass(std::string_view name, std::function<void(VkCommandBuffer)> record);
+    void mark_output(ResourceId id);                       // passes contributing to it are kept
+    void set_final_use(ResourceId id, const ResourceUse& u); // transitioned after the last pass; also marks it as an output
+
+    void execute(VkCommandBuffer cmd);
+    void reset(); // drops passes and imports of the frame; tracked handle state is kept
+
+    // Layout of a resource after the passes executed so far (or its imported layout before execute())
+    [[nodiscard]] VkImageLayout layout(ResourceId id) const;
+    [[nodiscard]] VkImageLayout tracked_layout(VkImage image, VkImageLayout fallback) const; // between frames
+    [[nodiscard]] uint32_t pass_count() const { return static_cast<uint32_t>(passes_.size()); }
+    [[nodiscard]] Lifetime lifetime(ResourceId id) const { return id < resources_.size() ? resources_[id].lifetime : Lifetime{}; }
+    // Call before destroying a handle that was imported, or when its contents/layout change outside the graph
+    void forget_image(VkImage image);
+    void forget_buffer(VkBuffer buffer);
+    void forget_memory(uint32_t memory);
+    void forget_all();
+
+    [[nodiscard]] const Stats& stats() const { return stats_; }
+    // ImGui (Stats tab): barrier counts and the last frame's passes
+    void imgui_panel_contents() const;
+
+private:
+    struct State {
+        VkImageLayout layout{VK_IMAGE_LAYOUT_UNDEFINED};
+        VkPipelineStageFlags2 write_stages{0}; // last write (or layout transition)
+        VkAccessFlags2 write_access{0};
+        VkPipelineStageFlags2 read_stages{0};  // reads since the last write
+        VkPipelineStageFlags2 visible_stages{0}; // stages/accesses the last write is already visible to
+        VkAccessFlags2 visible_access{0};
+    };
+    struct Resource {
+        std::string name;
+        VkImage image{VK_NULL_HANDLE};
+        VkBuffer buffer{VK_NULL_HANDLE};
+        VkImageAspectFlags aspect{0};
+        bool persistent{true};
+        uint32_t memory{UINT32_MAX}; // alias group of transient images
+        bool entered{false};         // first use this frame recorded
+        bool output{false};
+        bool has_final{false};
+        ResourceUse final_use{};
+        State state{};
+        Lifetime lifetime{};
+    };
+    struct Memory { VkPipelineStageFlags2 stages{0}; VkAccessFlags2 write_access{0}; }; // accesses since the last alias switch
+    struct Use { ResourceId id; ResourceUse use; };
+    struct Pass {
+        std::string name;
+        std::function<void(VkCommandBuffer)> record;
+        std::vector<Use> uses;
+        bool side_effect{false};
+    };
+    struct PassInfo { std::string name; bool culled{false}; uint32_t image_barriers{0}; uint32_t buffer_barriers{0}; };
+
+    ResourceId import(Resource&& r, const ResourceUse& initial);
+    void sync(Resource& r, const ResourceUse& u);
+    void flush(VkCommandBuffer cmd);
+    std::unordered_map<uint64_t, State>& tracked(const Resource& r) { return r.image ? tracked_images_ : tracked_buffers_; }
+
+    std::vector<Resource> resources_{};
+    std::vector<Pass> passes_{};
+    std::unordered_map<uint64_t, State> tracked_images_{}; // keyed by handle
+    std::unordered_map<uint64_t, State> tracked_buffers_{};
+    std::unordered_map<uint32_t, Memory> memory_{};
+    std::vector<VkImageMemoryBarrier2> image_barriers_{};   // pending batch
+    std::vector<VkBufferMemoryBarrier2> buffer_barriers_{};
+    Stats stats_{};
+    std::vector<PassInfo> last_passes_{};
+};
+
+} // namespace vv
+
+#endif // VULKAN_VISUALIZER_VV_RENDER_GRAPH_H
@@ -0,0 +1,60 @@
+#ifndef VULKAN_VISUALIZER_VV_RETIRE_H
+#define VULKAN_VISUALIZER_VV_RETIRE_H
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <functional>
+#include <variant>
+#include <vector>
+
+struct VmaAllocator_T; using VmaAllocator = VmaAllocator_T*;
+struct VmaAllocation_T; using VmaAllocation = VmaAllocation_T*;
+
+namespace vv {
+
+// Deferred destruction keyed on render timeline values. A resource referenced by anything submitted so far, or by the
+// frame being recorded, may be retired at frame_value(); it is destroyed once the render timeline reaches that value,
+// checked without blocking at the start of each frame. Replaces destroy-after-vkDeviceWaitIdle for resizes and rebuilds.
+class RetireQueue {
+public:
+    void init(VkDevice device, VmaAllocator allocator, VkSemaphore timeline);
+    void shutdown(); // device must be idle: destroys everything still pending
+
+    // Value the frame being recorded (or, between frames, the next one submitted) signals
+    [[nodiscard]] uint64_t frame_value() const { return submitted_ + 1; }
+    void set_submitted(uint64_t value) { submitted_ = value; } // engine, after each render timeline submission
+
+    void retire(VkBuffer buffer, VmaAllocation allocation, uint64_t value); // unmap persistently mapped buffers first
+    void retire(VkImage image, VmaAllocation allocation, uint64_t value);
+    void retire(VkImageView view, uint64_t value);
+    void retire(VkPipeline pipeline, uint64_t value);
+    void retire(std::function<void()> fn, uint64_t value); // anything else; descriptor sets: DescriptorAllocator::retire()
+
+    void collect(); // runs every entry whose value the timeline has reached
+    [[nodiscard]] size_t pending() const { return entries_.size(); }
+
+    // ImGui (Stats tab): pending / destroyed counts
+    void imgui_panel_contents() const;
+
+private:
+    struct Buffer { VkBuffer buffer; VmaAllocation allocation; };
+    struct Image { VkImage image; VmaAllocation allocation; };
+    struct View { VkImageView view; };
+    struct Pipeline { VkPipeline pipeline; };
+    using Handle = std::variant<Buffer, Image, View, Pipeline, std::function<void()>>;
+    struct Entry { uint64_t value{0}; Handle handle; };
+
+    void destroy(Handle& h);
+
+    VkDevice device_{VK_NULL_HANDLE};
+    VmaAllocator allocator_{nullptr};
+    VkSemaphore timeline_{VK_NULL_HANDLE};
+    uint64_t submitted_{0};
+    uint64_t destroyed_{0};
+    std::vector<Entry> entries_{};
+};
+
+} // namespace vv
+
+#endif // VULKAN_VISUALIZER_VV_RETIRE_H
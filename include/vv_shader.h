@@ -0,0 +1,97 @@
+#ifndef VULKAN_VISUALIZER_VV_SHADER_H
+#define VULKAN_VISUALIZER_VV_SHADER_H
+
+#include <vulkan/vulkan.h>
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <span>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace vv {
+
+struct ShaderRequest {
+    std::filesystem::path path{};                               // GLSL source
+    VkShaderStageFlagBits stage{};                              // 0: from the extension (.vert, .frag, .comp, ...)
+    std::vector<std::pair<std::string, std::string>> defines{}; // #define name value
+    std::string entry{"main"};
+};
+
+struct CompiledShader {
+    VkShaderModule module{VK_NULL_HANDLE}; // owned by the service and shared by every request producing the same SPIR-V;
+                                           // each result holds one reference, handed back with ShaderService::release()
+    bool cached{false};                    // SPIR-V came from the disk cache
+    std::string log{};                     // compiler diagnostics; module is null on failure
+};
+
+using ShaderFuture = std::shared_future<CompiledShader>;
+
+// GLSL -> SPIR-V on a worker pool, in-process through shaderc when the build found it (VV_HAVE_SHADERC), otherwise by
+// running glslc. The glslc path is a fallback, not an error: with VV_WITH_SHADERC on and no shaderc_combined in the SDK,
+// CMake reports it and every compile spawns a glslc process (the Stats tab names the backend in use). SPIR-V is cached on
+// disk under a hash of the source, every file it includes, the defines, stage and entry point, so an unchanged shader
+// never reaches the compiler twice. Modules are deduplicated by SPIR-V content and reference counted: pipelines do not
+// need their modules once created, so release() right after building them and an edited shader's old module goes away.
+class ShaderService {
+public:
+    bool init(VkDevice device, const std::filesystem::path& cache_dir, uint32_t workers);
+    void shutdown(); // finishes queued compiles, destroys every module
+
+    void add_include_dir(const std::filesystem::path& dir);
+
+    // Never blocks: reading, hashing and compiling all happen on the workers
+    [[nodiscard]] ShaderFuture compile(ShaderRequest request);
+    [[nodiscard]] CompiledShader compile_now(ShaderRequest request) { return compile(std::move(request)).get(); }
+    [[nodiscard]] static bool ready(const ShaderFuture& f) { return f.valid() && f.wait_for(std::chrono::seconds(0)) == std::future_status::ready; }
+    // Precompiled SPIR-V (e.g. embedded at build time): no compiler, no disk cache, same module sharing and release()
+    [[nodiscard]] CompiledShader load(std::span<const uint32_t> spirv);
+
+    // Drops one reference taken by a compile result; the last one destroys the module. Unreleased modules live until shutdown().
+    void release(VkShaderModule module);
+
+    struct Stats {
+        uint64_t requests{0};
+        uint64_t disk_hits{0};
+        uint64_t compiles{0};
+        uint64_t failures{0};
+        uint64_t modules{0};   // distinct VkShaderModules alive
+        double compile_ms{0.0}; // total time spent in the compiler
+    };
+    [[nodiscard]] Stats stats() const { std::scoped_lock lock(mutex_); return stats_; }
+
+    // ImGui (Stats tab): compiler backend, cache hits, compile time
+    void imgui_panel_contents() const;
+
+private:
+    CompiledShader run(const ShaderRequest& request);
+    VkShaderModule module_for(std::span<const uint32_t> spirv);
+    void worker_main(uint32_t index);
+
+    VkDevice device_{VK_NULL_HANDLE};
+    std::filesystem::path cache_dir_{};
+    std::vector<std::filesystem::path> include_dirs_{};
+    struct Module { VkShaderModule module{VK_NULL_HANDLE}; uint32_t refs{0}; };
+    std::unordered_map<uint64_t, Module> modules_{};             // by SPIR-V hash
+    std::unordered_map<VkShaderModule, uint64_t> module_hashes_{}; // release() -> modules_ key
+
+    mutable std::mutex mutex_{};
+    std::condition_variable cv_{};
+    std::deque<std::function<void()>> jobs_{};
+    std::vector<std::thread> threads_{};
+    bool stop_{false};
+    Stats stats_{};
+};
+
+} // namespace vv
+
+#endif // VULKAN_VISUALIZER_VV_SHADER_H
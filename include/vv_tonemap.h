@@ -0,0 +1,94 @@
+#ifndef VULKAN_VISUALIZER_VV_TONEMAP_H
+#define VULKAN_VISUALIZER_VV_TONEMAP_H
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+struct VmaAllocator_T; using VmaAllocator = VmaAllocator_T*;
+struct VmaAllocation_T; using VmaAllocation = VmaAllocation_T*;
+
+namespace vv {
+
+class PipelineCache;
+class ShaderService;
+
+enum class ToneCurve : uint32_t { None = 0, Reinhard = 1, Aces = 2 }; // value = VV_TONEMAP_CURVE_MASK bits
+
+// Presents an HDR attachment in one read and one write: a fullscreen triangle samples it through a linear sampler (which
+// also upscales a dynamic-resolution render extent) and writes the swapchain image with exposure, curve and dither applied.
+// Auto exposure adds two small compute passes before it: a 256-bin log2 luminance histogram of the rendered area and a
+// one-workgroup reduction to an adapted average that the fragment shader reads from a buffer, so nothing is read back.
+// Shaders: include/shaders/vv_tonemap*.{glsl,comp,frag} and vv_fullscreen.vert, compiled to SPIR-V at build time and
+// embedded in the library (VV_HAVE_BUILTIN_SHADERS); the GLSL sources are only read again by reload().
+class ToneMapper {
+public:
+    struct Settings {
+        ToneCurve curve{ToneCurve::Aces};
+        bool auto_exposure{true};
+        float exposure_ev{0.0f};          // manual exposure, or compensation on top of auto exposure
+        float min_log2_luminance{-10.0f}; // histogram range; luminance outside it is clamped
+        float max_log2_luminance{6.0f};
+        float adaptation_rate{1.5f};      // 1/s, eye adaptation speed
+        bool dither{true};
+    };
+
+    // `target_format`: swapchain format; _SRGB targets are encoded by the hardware, UNORM ones in the shader.
+    // `shader_dir`: empty uses the embedded SPIR-V, otherwise the GLSL there is compiled at runtime.
+    bool init(VkDevice device, VmaAllocator allocator, ShaderService& shaders, PipelineCache& cache, const std::filesystem::path& shader_dir, VkFormat target_format, uint32_t frames_in_flight);
+    void shutdown(); // device must be idle
+    // Hot reload: rebuilds the pipelines from the GLSL in `shader_dir`, keeping the current ones on failure. Device must be idle.
+    bool reload(ShaderService& shaders, PipelineCache& cache, const std::filesystem::path& shader_dir);
+
+    // Once per frame before recording the passes: points the slot's descriptor set at `source` (SHADER_READ_ONLY_OPTIMAL)
+    void prepare(uint32_t slot, VkImageView source, VkExtent3D source_size, VkExtent2D render_extent, double dt_sec);
+    // Compute, auto exposure only: histogram reads source, reduction reads+clears histogram and writes exposure
+    void record_histogram(VkCommandBuffer cmd);
+    void record_exposure(VkCommandBuffer cmd) const;
+    // Graphics: target in COLOR_ATTACHMENT_OPTIMAL, fully overwritten
+    void record_present(VkCommandBuffer cmd, VkImageView target, VkExtent2D target_extent) const;
+
+    [[nodiscard]] VkBuffer histogram_buffer() const { return histogram_; }
+    [[nodiscard]] VkBuffer exposure_buffer() const { return exposure_; }
+    [[nodiscard]] Settings& settings() { return settings_; }
+    [[nodiscard]] VkFormat target_format() const { return target_format_; }
+
+    // ImGui (Controls tab): curve, exposure, adaptation, dither, adapted luminance
+    void imgui_panel_contents();
+
+private:
+    struct Push;
+    [[nodiscard]] Push push() const;
+    bool build_pipelines(ShaderService& shaders, PipelineCache& cache, const std::filesystem::path& shader_dir);
+
+    VkDevice device_{VK_NULL_HANDLE};
+    VmaAllocator allocator_{nullptr};
+    VkFormat target_format_{VK_FORMAT_UNDEFINED};
+    VkSampler sampler_{VK_NULL_HANDLE};
+    VkDescriptorSetLayout set_layout_{VK_NULL_HANDLE};
+    VkPipelineLayout layout_{VK_NULL_HANDLE};
+    VkDescriptorPool pool_{VK_NULL_HANDLE};
+    std::vector<VkDescriptorSet> sets_{}; // one per frame slot
+    VkPipeline histogram_pipeline_{VK_NULL_HANDLE};
+    VkPipeline exposure_pipeline_{VK_NULL_HANDLE};
+    VkPipeline present_pipeline_{VK_NULL_HANDLE};
+    VkBuffer histogram_{VK_NULL_HANDLE};
+    VmaAllocation histogram_alloc_{nullptr};
+    VkBuffer exposure_{VK_NULL_HANDLE}; // host-visible so the panel can show the adapted luminance
+    VmaAllocation exposure_alloc_{nullptr};
+    void* exposure_mapped_{nullptr};
+
+    Settings settings_{};
+    uint32_t slot_{0};
+    VkExtent3D source_size_{};
+    VkExtent2D render_extent_{};
+    float dt_{0.0f};
+    uint32_t frame_{0};
+    bool histogram_cleared_{false};
+};
+
+} // namespace vv
+
+#endif // VULKAN_VISUALIZER_VV_TONEMAP_H
@@ -0,0 +1,105 @@
+#ifndef VULKAN_VISUALIZER_VV_UPLOAD_H
+#define VULKAN_VISUALIZER_VV_UPLOAD_H
+
+#include <vulkan/vulkan.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+struct VmaAllocator_T; using VmaAllocator = VmaAllocator_T*;
+struct VmaAllocation_T; using VmaAllocation = VmaAllocation_T*;
+
+namespace vv {
+
+// Host -> device uploads on the transfer queue. Data is copied into a persistently mapped staging ring; copies are
+// batched per frame into one command buffer and submitted with flush(), which signals the service's upload timeline.
+// The engine acquires completed batches at the start of each graphics frame and makes that frame wait on the timeline.
+// Buffers from create_buffer() that land in host-visible device-local memory (ReBAR, UMA) skip staging entirely.
+class UploadService {
+public:
+    using Ticket = uint64_t; // upload timeline value; 0 means the data is already in place
+
+    struct Buffer {
+        VkBuffer buffer{VK_NULL_HANDLE};
+        VmaAllocation allocation{nullptr};
+        VkDeviceSize size{0};
+        void* mapped{nullptr}; // set when the memory is device-local and host-visible: upload() writes directly
+        VkDeviceAddress address{0}; // set when usage includes SHADER_DEVICE_ADDRESS (vertex pulling, see vv_buffer.h)
+    };
+
+    struct Stats {
+        uint64_t bytes_staged{0};   // this frame, through the ring
+        uint64_t bytes_direct{0};   // this frame, written in place
+        uint32_t copies{0};         // this frame
+        uint32_t batches_in_flight{0};
+        uint32_t ring_stalls{0};    // total: reserve() had to wait for the transfer queue
+    };
+
+    bool init(VkDevice device, VmaAllocator allocator, VkQueue queue, uint32_t queue_family, uint32_t graphics_family, VkDeviceSize ring_bytes);
+    void shutdown(); // device must be idle
+
+    // Device-local buffer, TRANSFER_DST added to usage. Shared concurrently by the graphics and transfer families, so
+    // buffer uploads need no ownership transfer. Destroy with vmaDestroyBuffer (or the retire queue).
+    [[nodiscard]] Buffer create_buffer(VkDeviceSize size, VkBufferUsageFlags usage) const;
+
+    // The destination must not be read by frames still in flight: double-buffer it or upload before first use.
+    Ticket upload(const Buffer& dst, VkDeviceSize offset, const void* data, VkDeviceSize size);
+    // Whole-subresource upload (previous contents discarded). region.bufferOffset is ignored. The image is left in
+    // final_layout, owned by the graphics family once the ticket is ready. data must fit in the ring.
+    Ticket upload(VkImage dst, const VkBufferImageCopy& region, VkImageLayout final_layout, const void* data, VkDeviceSize size);
+    [[nodiscard]] bool ready(Ticket t) const { return t <= acquired_; }
+
+    // Engine, once per frame: acquire() on the graphics command buffer after begin_frame, flush() after the renderer
+    // update, and wait on timeline() at wait_value() in the graphics submission when the latter is non-zero.
+    void acquire(VkCommandBuffer graphics_cmd);
+    void flush();
+    [[nodiscard]] VkSemaphore timeline() const { return timeline_; }
+    [[nodiscard]] uint64_t wait_value() const { return wait_value_; }
+
+    [[nodiscard]] bool rebar() const { return rebar_; }
+    [[nodiscard]] const Stats& stats() const { return stats_; }
+
+    // ImGui (Stats tab): ring usage, per-frame traffic, direct-write availability
+    void imgui_panel_contents() const;
+
+private:
+    struct BufferCopy { VkBuffer dst; VkBufferCopy region; };
+    struct ImageCopy { VkImage dst; VkBufferImageCopy region; VkImageLayout final_layout; };
+    struct ImageAcquire { VkImage image; VkImageSubresourceRange range; VkImageLayout layout; };
+    struct Batch { VkCommandBuffer cmd; uint64_t value; uint64_t ring_end; std::vector<ImageAcquire> acquires; };
+
+    VkDeviceSize reserve(VkDeviceSize size, VkDeviceSize align); // returns the ring offset; may flush and wait
+    void retire_completed(uint64_t completed, VkCommandBuffer graphics_cmd);
+    VkCommandBuffer next_cmd();
+
+    VkDevice device_{VK_NULL_HANDLE};
+    VmaAllocator allocator_{nullptr};
+    VkQueue queue_{VK_NULL_HANDLE};
+    uint32_t queue_family_{0};
+    uint32_t graphics_family_{0};
+    VkCommandPool pool_{VK_NULL_HANDLE};
+    VkSemaphore timeline_{VK_NULL_HANDLE};
+    uint64_t submitted_{0};  // last value signalled by a flush()
+    uint64_t acquired_{0};   // last value acquired on the graphics side
+    uint64_t wait_value_{0}; // non-zero when the current frame acquired something
+    uint64_t reclaimed_{0};  // last value whose ring space is back
+
+    VkBuffer ring_{VK_NULL_HANDLE};
+    VmaAllocation ring_alloc_{nullptr};
+    std::byte* ring_mapped_{nullptr};
+    VkDeviceSize ring_size_{0};
+    uint64_t head_{0}, tail_{0}; // monotonic byte positions; in use = head_ - tail_
+    bool rebar_{false};
+
+    std::vector<BufferCopy> buffer_copies_{};
+    std::vector<ImageCopy> image_copies_{};
+    std::vector<Batch> in_flight_{};
+    std::vector<VkCommandBuffer> free_cmds_{};
+    Stats stats_{};
+    Stats last_frame_{};
+};
+
+} // namespace vv
+
+#endif // VULKAN_VISUALIZER_VV_UPLOAD_H
@@ -36,14 +36,22 @@
 #include <chrono>
 #include <stdexcept>
 #include <algorithm>
+#include <cmath>
 #include <filesystem>
+#include <iterator>
 #include <sstream>
 #include <iomanip>
 #include <ctime>
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <mutex>
+#include <thread>
 
 #ifdef VV_ENABLE_SCREENSHOT
 #define STB_IMAGE_WRITE_IMPLEMENTATION_DISABLED
 #include <stb_image_write.h>
+#include <deque>
 #endif
 
 #ifndef VK_CHECK
@@ -329,25 +337,380 @@ private:
     std::vector<PanelFn> frame_overlays_{};
 };
 
+#ifdef VV_ENABLE_SCREENSHOT
+// Persistent readback ring: host-visible buffers are reused across captures, completion is observed on
+// render_timeline_ and the swizzle + PNG encode run on a worker thread, so capturing never stalls the frame loop.
+struct VulkanEngine::ScreenshotSystem {
+    enum class SlotState : uint8_t { Free, InFlight, Encoding };
+    struct Slot {
+        VkBuffer buffer{VK_NULL_HANDLE};
+        VmaAllocation allocation{};
+        const void* mapped{nullptr};
+        VkDeviceSize capacity{0};
+        uint32_t width{0};
+        uint32_t height{0};
+        bool swizzle{false};
+        uint64_t timeline_value{0};
+        std::string path;
+        std::atomic<SlotState> state{SlotState::Free};
+    };
+
+    void start() { worker_ = std::thread([this] { worker_main(); }); }
+
+    void shutdown(VmaAllocator allocator) {
+        { std::lock_guard lock(mutex_); stop_ = true; }
+        cv_.notify_all();
+        if (worker_.joinable()) worker_.join();
+        for (auto& slot : slots_) {
+            if (slot.buffer) vmaDestroyBuffer(allocator, slot.buffer, slot.allocation);
+            slot.buffer = VK_NULL_HANDLE; slot.allocation = {}; slot.mapped = nullptr; slot.capacity = 0;
+            slot.state.store(SlotState::Free);
+        }
+    }
+
+    // Returns a free slot with at least `size` bytes, or nullptr when every slot is still busy.
+    Slot* acquire(VmaAllocator allocator, VkDeviceSize size) {
+        for (auto& slot : slots_) {
+            if (slot.state.load(std::memory_order_acquire) != SlotState::Free) continue;
+            if (slot.capacity < size) {
+                if (slot.buffer) vmaDestroyBuffer(allocator, slot.buffer, slot.allocation);
+                VkBufferCreateInfo bci{.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO, .pNext = nullptr, .flags = 0u, .size = size, .usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT, .sharingMode = VK_SHARING_MODE_EXCLUSIVE, .queueFamilyIndexCount = 0u, .pQueueFamilyIndices = nullptr};
+                VmaAllocationCreateInfo ainfo{.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT, .usage = VMA_MEMORY_USAGE_AUTO, .requiredFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT};
+                VmaAllocationInfo aout{};
+                VK_CHECK(vmaCreateBuffer(allocator, &bci, &ainfo, &slot.buffer, &slot.allocation, &aout));
+                slot.mapped   = aout.pMappedData;
+                slot.capacity = size;
+            }
+            return &slot;
+        }
+        return nullptr;
+    }
+
+    // Hands every in-flight slot whose copy has completed on the GPU to the encoder thread.
+    void collect(uint64_t completed_timeline) {
+        bool queued = false;
+        for (auto& slot : slots_) {
+            if (slot.state.load(std::memory_order_acquire) != SlotState::InFlight || slot.timeline_value > completed_timeline) continue;
+            slot.state.store(SlotState::Encoding, std::memory_order_release);
+            { std::lock_guard lock(mutex_); jobs_.push_back(&slot); }
+            queued = true;
+        }
+        if (queued) cv_.notify_one();
+    }
+
+    std::vector<std::string> drain_messages() {
+        std::lock_guard lock(mutex_);
+        std::vector<std::string> out; out.swap(messages_);
+        return out;
+    }
+
+private:
+    // BGRA8 -> RGBA8 on 32-bit words; branch-free so the compiler vectorizes it (AVX2 in Release builds).
+    static void swizzle_bgra_to_rgba(const uint32_t* src, uint32_t* dst, size_t count) {
+        for (size_t i = 0; i < count; ++i) {
+            const uint32_t p = src[i];
+            dst[i]           = (p & 0xFF00FF00u) | ((p >> 16) & 0x000000FFu) | ((p & 0x000000FFu) << 16);
+        }
+    }
+
+    void worker_main() {
+        vv::CpuTracer::set_thread_name("screenshot encoder");
+        std::vector<uint32_t> rgba;
+        for (;;) {
+            Slot* slot = nullptr;
+            {
+                std::unique_lock lock(mutex_);
+                cv_.wait(lock, [this] { return stop_ || !jobs_.empty(); });
+                if (jobs_.empty()) return; // stop requested and nothing left to encode
+                slot = jobs_.front(); jobs_.pop_front();
+            }
+            vv::cpu_zone z("encode_png");
+            const size_t count = static_cast<size_t>(slot->width) * static_cast<size_t>(slot->height);
+            rgba.resize(count);
+            const auto* src = static_cast<const uint32_t*>(slot->mapped);
+            if (slot->swizzle) swizzle_bgra_to_rgba(src, rgba.data(), count);
+            else std::copy_n(src, count, rgba.data());
+            const std::string path = slot->path;
+            const uint32_t w = slot->width; const uint32_t h = slot->height;
+            slot->state.store(SlotState::Free, std::memory_order_release); // staging copy done; slot reusable while encoding
+            const int ok = stbi_write_png(path.c_str(), static_cast<int>(w), static_cast<int>(h), 4, rgba.data(), static_cast<int>(w * 4));
+            std::lock_guard lock(mutex_);
+            messages_.push_back((ok ? std::string("Saved screenshot: ") : std::string("Failed to write screenshot: ")) + path);
+        }
+    }
+
+    std::array<Slot, 3> slots_{};
+    std::thread worker_{};
+    std::mutex mutex_{};
+    std::condition_variable cv_{};
+    std::deque<Slot*> jobs_{};
+    std::vector<std::string> messages_{};
+    bool stop_{false};
+};
+#endif
+
+// Worker pool for IRenderer::record_graphics_job. Each worker owns one VkCommandPool per frame in flight, so
+// pools are reset without locks once begin_frame() has waited for that slot; outputs are kept in job order.
+struct VulkanEngine::ParallelRecorder {
+    using JobFn = std::function<void(VkCommandBuffer, uint32_t)>;
+
+    void init(VkDevice device, uint32_t queue_family, uint32_t frames_in_flight) {
+        device_ = device; queue_family_ = queue_family; frames_in_flight_ = std::max(1u, frames_in_flight);
+    }
+
+    void shutdown() {
+        { std::lock_guard lock(mutex_); stop_ = true; }
+        start_cv_.notify_all();
+        for (auto& t : threads_) if (t.joinable()) t.join();
+        threads_.clear();
+        for (auto& w : workers_) for (auto& f : w.frames) if (f.pool) vkDestroyCommandPool(device_, f.pool, nullptr);
+        workers_.clear();
+    }
+
+    void launch(uint32_t frame_slot, uint32_t count, const VkCommandBufferInheritanceRenderingInfo* rendering, JobFn fn) {
+        ensure_workers();
+        for (auto& w : workers_) {
+            auto& f = w.frames[frame_slot];
+            if (f.pool) VK_CHECK(vkResetCommandPool(device_, f.pool, 0));
+            f.used = 0;
+        }
+        if (rendering) { rendering_ = *rendering; rendering_.pNext = nullptr; }
+        has_rendering_ = rendering != nullptr;
+        results_.assign(count, VK_NULL_HANDLE);
+        {
+            std::lock_guard lock(mutex_);
+            fn_ = std::move(fn); slot_ = frame_slot; job_count_ = count; next_job_.store(0); finished_ = 0; error_ = nullptr;
+            ++generation_;
+        }
+        start_cv_.notify_all();
+    }
+
+    std::span<const VkCommandBuffer> wait() {
+        std::unique_lock lock(mutex_);
+        done_cv_.wait(lock, [this] { return finished_ == threads_.size(); });
+        fn_ = nullptr;
+        if (error_) std::rethrow_exception(error_);
+        return results_;
+    }
+
+    // Unwinding path: hands out no further jobs and waits for the running ones, which still reference the caller's frame
+    void abandon() {
+        next_job_.store(job_count_);
+        std::unique_lock lock(mutex_);
+        done_cv_.wait(lock, [this] { return finished_ == threads_.size(); });
+        fn_ = nullptr;
+    }
+
+private:
+    struct WorkerFrame { VkCommandPool pool{VK_NULL_HANDLE}; std::vector<VkCommandBuffer> buffers; uint32_t used{0}; };
+    struct Worker { std::vector<WorkerFrame> frames; };
+
+    void ensure_workers() {
+        if (!threads_.empty()) return;
+        const uint32_t hw    = std::max(2u, std::thread::hardware_concurrency());
+        const uint32_t count = std::clamp(hw - 1u, 1u, 8u);
+        workers_.resize(count);
+        for (auto& w : workers_) w.frames.resize(frames_in_flight_);
+        for (uint32_t i = 0; i < count; ++i) threads_.emplace_back([this, i] { worker_main(i); });
+    }
+
+    VkCommandBuffer next_buffer(WorkerFrame& f) {
+        if (!f.pool) {
+            VkCommandPoolCreateInfo pci{.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO, .pNext = nullptr, .flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT, .queueFamilyIndex = queue_family_};
+            VK_CHECK(vkCreateCommandPool(device_, &pci, nullptr, &f.pool));
+        }
+        if (f.used == f.buffers.size()) {
+            VkCommandBufferAllocateInfo ai{.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO, .pNext = nullptr, .commandPool = f.pool, .level = VK_COMMAND_BUFFER_LEVEL_SECONDARY, .commandBufferCount = 1u};
+            VkCommandBuffer cb{}; VK_CHECK(vkAllocateCommandBuffers(device_, &ai, &cb)); f.buffers.push_back(cb);
+        }
+        return f.buffers[f.used++];
+    }
+
+    void worker_main(uint32_t index) {
+        vv::CpuTracer::set_thread_name("record worker " + std::to_string(index));
+        uint64_t seen = 0;
+        for (;;) {
+            {
+                std::unique_lock lock(mutex_);
+                start_cv_.wait(lock, [&] { return stop_ || generation_ != seen; });
+                if (stop_) return;
+                seen = generation_;
+            }
+            try {
+                for (uint32_t job = next_job_.fetch_add(1); job < job_count_; job = next_job_.fetch_add(1)) {
+                    VkCommandBuffer cb = next_buffer(workers_[index].frames[slot_]);
+                    VkCommandBufferInheritanceInfo inherit{.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO, .pNext = has_rendering_ ? &rendering_ : nullptr};
+                    VkCommandBufferBeginInfo bi{.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO, .pNext = nullptr, .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT | (has_rendering_ ? VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT : 0u), .pInheritanceInfo = &inherit};
+                    VK_CHECK(vkBeginCommandBuffer(cb, &bi));
+                    fn_(cb, job);
+                    VK_CHECK(vkEndCommandBuffer(cb));
+                    results_[job] = cb;
+                }
+            } catch (...) {
+                std::lock_guard lock(mutex_);
+                if (!error_) error_ = std::current_exception();
+                next_job_.store(job_count_); // drain remaining jobs
+            }
+            std::lock_guard lock(mutex_);
+            if (++finished_ == threads_.size()) done_cv_.notify_all();
+        }
+    }
+
+    VkDevice device_{VK_NULL_HANDLE};
+    uint32_t queue_family_{0};
+    uint32_t frames_in_flight_{1};
+    std::vector<Worker> workers_{};
+    std::vector<std::thread> threads_{};
+    std::vector<VkCommandBuffer> results_{};
+    VkCommandBufferInheritanceRenderingInfo rendering_{};
+    bool has_rendering_{false};
+    JobFn fn_{};
+    uint32_t slot_{0};
+    uint32_t job_count_{0};
+    std::atomic<uint32_t> next_job_{0};
+    size_t finished_{0};
+    uint64_t generation_{0};
+    bool stop_{false};
+    std::exception_ptr error_{};
+    std::mutex mutex_{};
+    std::condition_variable start_cv_{};
+    std::condition_variable done_cv_{};
+};
+
 void DescriptorAllocator::init_pool(VkDevice device, uint32_t maxSets, std::span<const PoolSizeRatio> ratios) {
-    maxSets = std::max(1u, maxSets);
-    std::vector<VkDescriptorPoolSize> sizes; sizes.reserve(ratios.size());
-    for (const auto& [type, ratio] : ratios) {
-        const uint32_t count = std::max(1u, static_cast<uint32_t>(ratio * static_cast<float>(maxSets)));
+    std::scoped_lock lock(mutex_);
+    ratios_.assign(ratios.begin(), ratios.end());
+    sets_per_pool_ = std::clamp(maxSets, 1u, kMaxSetsPerPool);
+    ready_.push_back(create_pool(device, VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT));
+    stats_ = Stats{.pools = 1u, .next_pool_sets = sets_per_pool_};
+}
+
+VkDescriptorPool DescriptorAllocator::create_pool(VkDevice device, VkDescriptorPoolCreateFlags flags) const {
+    std::vector<VkDescriptorPoolSize> sizes; sizes.reserve(ratios_.size());
+    for (const auto& [type, ratio] : ratios_) {
+        const uint32_t count = std::max(1u, static_cast<uint32_t>(ratio * static_cast<float>(sets_per_pool_)));
         sizes.push_back(VkDescriptorPoolSize{.type = type, .descriptorCount = count});
     }
-    const VkDescriptorPoolCreateInfo info{.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO, .pNext = nullptr, .flags = 0u, .maxSets = maxSets, .poolSizeCount = static_cast<uint32_t>(sizes.size()), .pPoolSizes = sizes.data()};
+    const VkDescriptorPoolCreateInfo info{.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO, .pNext = nullptr, .flags = flags, .maxSets = sets_per_pool_, .poolSizeCount = static_cast<uint32_t>(sizes.size()), .pPoolSizes = sizes.data()};
+    VkDescriptorPool pool{};
     VK_CHECK(vkCreateDescriptorPool(device, &info, nullptr, &pool));
+    return pool;
+}
+
+void DescriptorAllocator::grow() {
+    sets_per_pool_        = std::min(sets_per_pool_ * 2u, kMaxSetsPerPool);
+    stats_.next_pool_sets = sets_per_pool_;
+    stats_.grows++;
+}
+
+void DescriptorAllocator::clear_descriptors(VkDevice device) {
+    std::scoped_lock lock(mutex_);
+    ready_.insert(ready_.end(), full_.begin(), full_.end());
+    full_.clear();
+    freed_.clear();
+    for (VkDescriptorPool pool : ready_) vkResetDescriptorPool(device, pool, 0);
+    stats_.sets = 0;
+}
+
+void DescriptorAllocator::destroy_pool(VkDevice device) {
+    std::scoped_lock lock(mutex_);
+    for (VkDescriptorPool pool : ready_) vkDestroyDescriptorPool(device, pool, nullptr);
+    for (VkDescriptorPool pool : full_) vkDestroyDescriptorPool(device, pool, nullptr);
+    for (FrameSlot& f : frames_) { for (VkDescriptorPool pool : f.pools) vkDestroyDescriptorPool(device, pool, nullptr); f = FrameSlot{}; }
+    ready_.clear();
+    full_.clear();
+    freed_.clear();
+    stats_ = Stats{};
+}
+
+// Out of pool memory and fragmentation both mean "try the next pool"; a pool created for this very call that still fails
+// cannot hold the layout at all (a descriptor type missing from the ratios), which is reported like any other error.
+static bool descriptor_pool_exhausted(VkResult r) { return r == VK_ERROR_OUT_OF_POOL_MEMORY || r == VK_ERROR_FRAGMENTED_POOL; }
+
+VkDescriptorSet DescriptorAllocator::allocate(VkDevice device, VkDescriptorSetLayout layout, VkDescriptorPool* pool_out) {
+    std::scoped_lock lock(mutex_);
+    for (;;) {
+        const bool fresh = ready_.empty();
+        if (fresh) { ready_.push_back(create_pool(device, VK_DESCRIPTOR_POOL_CREATE_FREE_DESCRIPTOR_SET_BIT)); stats_.pools++; }
+        const VkDescriptorSetAllocateInfo ai{.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO, .pNext = nullptr, .descriptorPool = ready_.back(), .descriptorSetCount = 1u, .pSetLayouts = &layout};
+        VkDescriptorSet ds{};
+        const VkResult r = vkAllocateDescriptorSets(device, &ai, &ds);
+        if (descriptor_pool_exhausted(r) && !fresh) {
+            full_.push_back(ready_.back());
+            ready_.pop_back();
+            if (ready_.empty()) grow();
+            continue;
+        }
+        VK_CHECK(r);
+        if (pool_out) *pool_out = ready_.back();
+        stats_.sets++;
+        return ds;
+    }
+}
+
+VkDescriptorSet DescriptorAllocator::allocate_frame(VkDevice device, VkDescriptorSetLayout layout) {
+    std::scoped_lock lock(mutex_);
+    FrameSlot& f = frames_[slot_];
+    for (;;) {
+        const bool fresh = f.active == f.pools.size();
+        if (fresh) { f.pools.push_back(create_pool(device, 0u)); stats_.frame_pools++; }
+        const VkDescriptorSetAllocateInfo ai{.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO, .pNext = nullptr, .descriptorPool = f.pools[f.active], .descriptorSetCount = 1u, .pSetLayouts = &layout};
+        VkDescriptorSet ds{};
+        const VkResult r = vkAllocateDescriptorSets(device, &ai, &ds);
+        if (descriptor_pool_exhausted(r) && !fresh) {
+            if (++f.active == f.pools.size()) grow();
+            continue;
+        }
+        VK_CHECK(r);
+        stats_.frame_sets++;
+        return ds;
+    }
+}
+
+void DescriptorAllocator::free(VkDevice device, VkDescriptorPool pool, VkDescriptorSet set) {
+    std::scoped_lock lock(mutex_);
+    VK_CHECK(vkFreeDescriptorSets(device, pool, 1u, &set));
+    if (stats_.sets > 0) stats_.sets--;
+    if (std::ranges::find(full_, pool) != full_.end() && std::ranges::find(freed_, pool) == freed_.end()) freed_.push_back(pool);
+}
+
+void DescriptorAllocator::retire(vv::RetireQueue& queue, VkDevice device, VkDescriptorPool pool, VkDescriptorSet set, uint64_t value) {
+    if (pool && set) queue.retire([this, device, pool, set] { free(device, pool, set); }, value);
+}
+
+// The slot keeps its pools: after the first frames the per-frame path allocates without creating anything. Persistent pools
+// that had sets freed since the last frame leave full_ and go to the front of ready_, so they are tried after the newest one.
+void DescriptorAllocator::begin_frame(VkDevice device, uint32_t frame_slot) {
+    std::scoped_lock lock(mutex_);
+    for (VkDescriptorPool pool : freed_) {
+        std::erase(full_, pool);
+        ready_.insert(ready_.begin(), pool);
+    }
+    freed_.clear();
+    slot_      = frame_slot % MAX_FRAMES_IN_FLIGHT;
+    FrameSlot& f = frames_[slot_];
+    for (size_t i = 0; i < f.pools.size() && i <= f.active; ++i) vkResetDescriptorPool(device, f.pools[i], 0);
+    f.active          = 0;
+    stats_.frame_sets = 0;
+}
+
+void DescriptorAllocator::imgui_panel_contents() const {
+    const Stats s = stats();
+    ImGui::Text("Descriptor pools: %u persistent, %u per-frame; next pool %u sets", s.pools, s.frame_pools, s.next_pool_sets);
+    ImGui::Text("Descriptor sets: %llu live, %llu this frame, grew %u times", static_cast<unsigned long long>(s.sets), static_cast<unsigned long long>(s.frame_sets), s.grows);
 }
-void DescriptorAllocator::clear_descriptors(VkDevice device) const { if (pool) vkResetDescriptorPool(device, pool, 0); }
-void DescriptorAllocator::destroy_pool(VkDevice device) const { if (pool) vkDestroyDescriptorPool(device, pool, nullptr); }
-VkDescriptorSet DescriptorAllocator::allocate(VkDevice device, VkDescriptorSetLayout layout) const { const VkDescriptorSetAllocateInfo ai{.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO, .pNext = nullptr, .descriptorPool = pool, .descriptorSetCount = 1u, .pSetLayouts = &layout}; VkDescriptorSet ds{}; VK_CHECK(vkAllocateDescriptorSets(device, &ai, &ds)); return ds; }
 
 VulkanEngine::VulkanEngine()  = default;
 VulkanEngine::~VulkanEngine() = default;
 
 void VulkanEngine::init() {
     if (!renderer_) throw std::runtime_error("Renderer not set");
+#ifdef VV_ENABLE_LOGGING
+    vv::Log::start(log_file_);
+#endif
+    metrics_        = std::make_unique<vv::MetricsRegistry>();
+    engine_metrics_ = {.frame_ms = metrics_->gauge("frame_ms", "ms", true), .cpu_ms = metrics_->gauge("cpu_ms", "ms"), .gpu_ms = metrics_->gauge("gpu_ms", "ms"), .vram_mb = metrics_->gauge("vram_mb", "MB")};
+    metrics_->set_hitch_metric(engine_metrics_.frame_ms);
 
     renderer_caps_ = RendererCaps{};
     renderer_->query_required_device_caps(renderer_caps_);
@@ -363,21 +726,52 @@ void VulkanEngine::init() {
 
     create_context(state_.width, state_.height, state_.name.c_str());
 
-#ifdef VV_ENABLE_GPU_TIMESTAMPS
-    create_timestamp_pool();
-#endif
-
     EngineContext engPost = make_engine_context();
     renderer_->get_capabilities(engPost, renderer_caps_);
     sanitize_renderer_caps(renderer_caps_);
+    frames_in_flight_ = renderer_caps_.frames_in_flight;
+    render_graph_     = std::make_unique<vv::RenderGraph>();
+    if (renderer_caps_.presentation_mode != PresentationMode::EngineBlit && (resolution_.min_scale != 1.0f || resolution_.max_scale != 1.0f)) {
+        VV_LOG_WARN("Dynamic resolution needs PresentationMode::EngineBlit; rendering at the swapchain extent");
+        resolution_ = DynamicResolution{};
+    }
+
+#ifdef VV_ENABLE_GPU_TIMESTAMPS
+    create_gpu_profiler();
+#endif
 
     create_swapchain(state_.width, state_.height);
     create_renderer_targets(swapchain_.swapchain_extent);
+#ifdef VV_ENABLE_TONEMAP
+    create_tonemapper();
+    if (tonemapper_) mdq_.emplace_back([&] { destroy_tonemapper(); });
+#endif
 
     create_command_buffers();
 
+    if (renderer_caps_.allow_async_transfer && ctx_.transfer_queue) {
+        uploads_ = std::make_unique<vv::UploadService>();
+        if (uploads_->init(ctx_.device, ctx_.allocator, ctx_.transfer_queue, ctx_.transfer_queue_family, ctx_.graphics_queue_family, renderer_caps_.upload_ring_bytes)) mdq_.emplace_back([&] { uploads_->shutdown(); uploads_.reset(); });
+        else { uploads_->shutdown(); uploads_.reset(); }
+    }
+
+    if (renderer_caps_.descriptor_indexing) {
+        bindless_ = std::make_unique<vv::BindlessHeap>();
+        if (bindless_->init(ctx_.device, ctx_.physical, render_timeline_, renderer_caps_.bindless_capacity, ctx_.storage_image_nonuniform)) mdq_.emplace_back([&] { bindless_->shutdown(); bindless_.reset(); });
+        else { bindless_->shutdown(); bindless_.reset(); }
+    }
+
+#ifdef VV_ENABLE_SCREENSHOT
+    screenshots_ = std::make_unique<ScreenshotSystem>();
+    screenshots_->start();
+#endif
+
     create_renderer();
 
+#ifdef VV_ENABLE_HOTRELOAD
+    if (file_watcher_ && file_watcher_->start()) mdq_.emplace_back([&] { file_watcher_->shutdown(); });
+#endif
+
     if (renderer_caps_.enable_imgui) create_imgui();
 
     if (renderer_) {
@@ -395,151 +789,210 @@ void VulkanEngine::init() {
 }
 
 void VulkanEngine::run() {
-    if (!state_.running) state_.running = true;
-    if (!state_.should_rendering) state_.should_rendering = true;
-    using clock = std::chrono::steady_clock;
-    auto t0     = clock::now();
-    auto t_prev = t0;
-    SDL_Event e{};
+    REQUIRE_TRUE(!state_.headless, "run() needs a window; use run_frames() in headless mode");
+    state_.running          = true;
+    state_.should_rendering = true;
+    FrameLoop loop = begin_frame_loop();
+    while (state_.running) step_frame(loop);
+}
 
-    EngineContext eng             = make_engine_context();
-    FrameContext last_frm         = make_frame_context(state_.frame_number, 0u, swapchain_.swapchain_extent);
-    last_frm.swapchain_image      = VK_NULL_HANDLE;
-    last_frm.swapchain_image_view = VK_NULL_HANDLE;
-
-    while (state_.running) {
-        while (SDL_PollEvent(&e)) {
-            if (renderer_) { renderer_->on_event(e, eng, state_.initialized ? &last_frm : nullptr); }
-            if (ui_) { ui_->process_event(&e); }
-            switch (e.type) {
-            case SDL_EVENT_QUIT:
-            case SDL_EVENT_WINDOW_CLOSE_REQUESTED: state_.running = false; break;
-            case SDL_EVENT_WINDOW_MINIMIZED: state_.minimized = true; state_.should_rendering = false; break;
-            case SDL_EVENT_WINDOW_RESTORED:
-            case SDL_EVENT_WINDOW_MAXIMIZED: state_.minimized = false; state_.should_rendering = true; break;
-            case SDL_EVENT_WINDOW_FOCUS_GAINED: state_.focused = true; break;
-            case SDL_EVENT_WINDOW_FOCUS_LOST: state_.focused = false; break;
-            case SDL_EVENT_WINDOW_RESIZED:
-            case SDL_EVENT_WINDOW_PIXEL_SIZE_CHANGED: state_.resize_requested = true; break;
-#ifdef VV_ENABLE_SCREENSHOT
-#if defined(SDL_EVENT_KEY_DOWN)
-            case SDL_EVENT_KEY_DOWN:
-                if (e.key.keysym.sym == SDLK_PRINTSCREEN) { screenshot_.request = true; screenshot_.path.clear(); }
-                break;
-#endif
+void VulkanEngine::run_frames(uint64_t count) {
+    REQUIRE_TRUE(state_.initialized, "run_frames() called before init()");
+    state_.running          = true;
+    state_.should_rendering = true;
+    FrameLoop loop = begin_frame_loop();
+    for (uint64_t submitted = 0; submitted < count && state_.running;) if (step_frame(loop)) ++submitted;
+}
+
+VulkanEngine::FrameLoop VulkanEngine::begin_frame_loop() {
+    FrameLoop loop{.t_prev = std::chrono::steady_clock::now(), .eng = make_engine_context(), .last_frm = make_frame_context(state_.frame_number, 0u, swapchain_.swapchain_extent)};
+    loop.last_frm.swapchain_image      = VK_NULL_HANDLE;
+    loop.last_frm.swapchain_image_view = VK_NULL_HANDLE;
+    vv::CpuTracer::set_thread_name("main");
+    return loop;
+}
+
+bool VulkanEngine::step_frame(FrameLoop& loop) {
+    vv::CpuTracer::frame_mark();
+#ifdef VV_ENABLE_LOGGING
+    for (auto& msg : vv::CpuTracer::drain_messages()) log_line(msg);
 #endif
-            default: break;
-            }
-        }
+    if (ctx_.window) { vv::cpu_zone z("poll_events"); poll_events(loop.eng, loop.last_frm); }
 
-        auto t_now      = clock::now();
-        state_.dt_sec   = std::chrono::duration<double>(t_now - t_prev).count();
-        state_.time_sec = std::chrono::duration<double>(t_now - t0).count();
-        t_prev          = t_now;
+    const auto t_now = std::chrono::steady_clock::now();
+    state_.dt_sec    = std::chrono::duration<double>(t_now - loop.t_prev).count();
+    state_.time_sec += state_.dt_sec;
+    loop.t_prev      = t_now;
 
 #ifdef VV_ENABLE_HOTRELOAD
-        watch_accum_ += state_.dt_sec;
-        if (watch_accum_ > 0.5) { poll_file_watches(eng); watch_accum_ = 0.0; }
+    poll_file_watches(loop.eng);
 #endif
 
-        if (!state_.should_rendering) { SDL_WaitEventTimeout(nullptr, 100); continue; }
+    if (!state_.should_rendering) { SDL_WaitEventTimeout(nullptr, 100); return false; }
 
-        if (state_.resize_requested) {
-            recreate_swapchain();
-            eng                           = make_engine_context();
-            last_frm                      = make_frame_context(state_.frame_number, 0u, swapchain_.swapchain_extent);
-            last_frm.swapchain_image      = VK_NULL_HANDLE;
-            last_frm.swapchain_image_view = VK_NULL_HANDLE;
-            continue;
-        }
+    if (!state_.resize_requested && draw_frame(loop.eng, loop.last_frm)) return true;
+    if (state_.resize_requested) {
+        recreate_swapchain();
+        loop.eng                           = make_engine_context();
+        loop.last_frm                      = make_frame_context(state_.frame_number, 0u, swapchain_.swapchain_extent);
+        loop.last_frm.swapchain_image      = VK_NULL_HANDLE;
+        loop.last_frm.swapchain_image_view = VK_NULL_HANDLE;
+    }
+    return false;
+}
 
-        uint32_t imageIndex = 0; VkCommandBuffer cmd = VK_NULL_HANDLE;
-        begin_frame(imageIndex, cmd);
-        if (cmd == VK_NULL_HANDLE) {
-            if (state_.resize_requested) {
-                recreate_swapchain();
-                eng                           = make_engine_context();
-                last_frm                      = make_frame_context(state_.frame_number, 0u, swapchain_.swapchain_extent);
-                last_frm.swapchain_image      = VK_NULL_HANDLE;
-                last_frm.swapchain_image_view = VK_NULL_HANDLE;
-            }
-            continue;
+void VulkanEngine::poll_events(const EngineContext& eng, const FrameContext& last_frm) {
+    SDL_Event e{};
+    while (SDL_PollEvent(&e)) {
+        if (renderer_) { renderer_->on_event(e, eng, state_.initialized ? &last_frm : nullptr); }
+        if (ui_) { ui_->process_event(&e); }
+        switch (e.type) {
+        case SDL_EVENT_QUIT:
+        case SDL_EVENT_WINDOW_CLOSE_REQUESTED: state_.running = false; break;
+        case SDL_EVENT_WINDOW_MINIMIZED: state_.minimized = true; state_.should_rendering = false; break;
+        case SDL_EVENT_WINDOW_RESTORED:
+        case SDL_EVENT_WINDOW_MAXIMIZED: state_.minimized = false; state_.should_rendering = true; break;
+        case SDL_EVENT_WINDOW_FOCUS_GAINED: state_.focused = true; break;
+        case SDL_EVENT_WINDOW_FOCUS_LOST: state_.focused = false; break;
+        case SDL_EVENT_WINDOW_RESIZED:
+        case SDL_EVENT_WINDOW_PIXEL_SIZE_CHANGED: state_.resize_requested = true; break;
+#ifdef VV_ENABLE_SCREENSHOT
+#if defined(SDL_EVENT_KEY_DOWN)
+        case SDL_EVENT_KEY_DOWN:
+            if (e.key.keysym.sym == SDLK_PRINTSCREEN) { screenshot_.request = true; screenshot_.path.clear(); }
+            break;
+#endif
+#endif
+        default: break;
         }
+    }
+}
 
-        FrameContext frm = make_frame_context(state_.frame_number, imageIndex, swapchain_.swapchain_extent);
-        last_frm         = frm;
-
-        if (renderer_) { renderer_->simulate(eng, frm); }
-
-        FrameData& frData = frames_[state_.frame_number % FRAME_OVERLAP];
-        frData.asyncComputeSubmitted = false;
-        const bool can_async = renderer_caps_.allow_async_compute && ctx_.compute_queue && ctx_.compute_queue != ctx_.graphics_queue && frData.asyncComputeCommandBuffer != VK_NULL_HANDLE;
-        if (can_async && renderer_) {
-            VK_CHECK(vkResetCommandBuffer(frData.asyncComputeCommandBuffer, 0));
-            VkCommandBufferBeginInfo cbi{.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO, .pNext = nullptr, .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT, .pInheritanceInfo = nullptr};
-            VK_CHECK(vkBeginCommandBuffer(frData.asyncComputeCommandBuffer, &cbi));
-            const bool recorded = renderer_->record_async_compute(frData.asyncComputeCommandBuffer, eng, frm);
-            if (recorded) {
-                VK_CHECK(vkEndCommandBuffer(frData.asyncComputeCommandBuffer));
-                VkCommandBufferSubmitInfo cbsi{.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO, .pNext = nullptr, .commandBuffer = frData.asyncComputeCommandBuffer, .deviceMask = 0};
-                VkSemaphoreSubmitInfo signal{.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO, .pNext = nullptr, .semaphore = frData.asyncComputeFinished, .value = 0u, .stageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, .deviceIndex = 0};
-                VkSubmitInfo2 submit{.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2, .pNext = nullptr, .waitSemaphoreInfoCount = 0, .pWaitSemaphoreInfos = nullptr, .commandBufferInfoCount = 1, .pCommandBufferInfos = &cbsi, .signalSemaphoreInfoCount = 1, .pSignalSemaphoreInfos = &signal};
-                VK_CHECK(vkQueueSubmit2(ctx_.compute_queue, 1, &submit, VK_NULL_HANDLE));
-                frData.asyncComputeSubmitted = true;
-            } else {
-                VK_CHECK(vkEndCommandBuffer(frData.asyncComputeCommandBuffer));
-            }
-        }
+bool VulkanEngine::draw_frame(const EngineContext& eng, FrameContext& last_frm) {
+    vv::cpu_zone frame_zone("draw_frame");
+    if (state_.targets_dirty) rebuild_renderer_targets();
+    uint32_t imageIndex = 0; VkCommandBuffer cmd = VK_NULL_HANDLE;
+    begin_frame(imageIndex, cmd);
+    if (cmd == VK_NULL_HANDLE) return false;
+    const auto cpu_begin = std::chrono::steady_clock::now(); // after the fence and acquire waits: CPU work only
+    update_render_scale();
+    if (uploads_) uploads_->acquire(cmd); // batches the transfer queue finished: ring space back, image ownership to graphics
 
-        if (renderer_) { renderer_->update(eng, frm); }
-        if (renderer_) { renderer_->record_compute(cmd, eng, frm); }
-        if (renderer_) { renderer_->record_graphics(cmd, eng, frm); }
+    FrameContext frm = make_frame_context(state_.frame_number, imageIndex, swapchain_.swapchain_extent);
+    last_frm         = frm;
 
-        switch (renderer_caps_.presentation_mode) {
-        case PresentationMode::EngineBlit: blit_offscreen_to_swapchain(cmd, imageIndex, frm.extent); break;
-        case PresentationMode::RendererComposite: if (renderer_) renderer_->compose(cmd, eng, frm); break;
-        case PresentationMode::DirectToSwapchain: default: break; }
+    if (renderer_) { vv::cpu_zone z("simulate"); renderer_->simulate(eng, frm); }
 
-#ifdef VV_ENABLE_SCREENSHOT
-        if (screenshot_.request) { queue_swapchain_screenshot(cmd, imageIndex); }
-#endif
+    if (renderer_ && current_frame().asyncComputeCommandBuffer) submit_async_compute(eng, frm, cmd);
 
-        if (ui_) {
-            ui_->new_frame();
-            if (renderer_) { renderer_->on_imgui(eng, frm); }
-            ui_->render_overlay(cmd, frm.swapchain_image, frm.swapchain_image_view, frm.extent, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL);
-        }
+    if (renderer_) { vv::cpu_zone z("update"); renderer_->update(eng, frm); }
+    if (uploads_) { vv::cpu_zone z("upload_flush"); uploads_->flush(); } // copies overlap this frame's recording; later uploads go with the next batch
 
-        end_frame(imageIndex, cmd);
+    // Secondary jobs record on worker threads while this thread records the primary command buffer
+    const GraphicsJobs jobs = renderer_ ? renderer_->plan_graphics_jobs(eng, frm) : GraphicsJobs{};
+    if (jobs.count > 0) recorder_->launch(frame_slot(), jobs.count, jobs.rendering, [&](VkCommandBuffer secondary, uint32_t job) { vv::cpu_zone z("record_graphics_job"); renderer_->record_graphics_job(secondary, job, eng, frm); });
+    // If the renderer throws before wait(), the jobs must not outlive eng and frm
+    struct JobsGuard { ParallelRecorder* recorder; ~JobsGuard() { if (recorder) recorder->abandon(); } } jobs_guard{jobs.count > 0 ? recorder_.get() : nullptr};
 
-#ifdef VV_ENABLE_SCREENSHOT
-        if (screenshot_.request) {
-            // Clear request only after a copy was actually queued (dq non-empty)
-            if (!frData.dq.empty()) {
-                vkQueueWaitIdle(ctx_.graphics_queue);
-                for (auto& fn : frData.dq) fn();
-                frData.dq.clear();
-                screenshot_.request = false;
-            }
+    if (renderer_) { vv::cpu_zone c("record_compute"); vv::gpu_zone z(gpu_profiler_.get(), cmd, "compute"); renderer_->record_compute(cmd, eng, frm); }
+    if (renderer_) {
+        // One zone around the whole graphics span: no timestamps may be written between record_graphics' vkCmdBeginRendering
+        // (secondary contents) and finish_graphics_jobs' vkCmdEndRendering
+        vv::gpu_zone z(gpu_profiler_.get(), cmd, "graphics");
+        { vv::cpu_zone c("record_graphics"); renderer_->record_graphics(cmd, eng, frm); }
+        if (jobs.count > 0) {
+            std::span<const VkCommandBuffer> secondaries;
+            { vv::cpu_zone c("wait_graphics_jobs"); secondaries = recorder_->wait(); }
+            vkCmdExecuteCommands(cmd, static_cast<uint32_t>(secondaries.size()), secondaries.data());
+            renderer_->finish_graphics_jobs(cmd, eng, frm);
         }
+    }
+
+#ifdef VV_ENABLE_SCREENSHOT
+    if (screenshots_) {
+        uint64_t completed = 0; VK_CHECK(vkGetSemaphoreCounterValue(ctx_.device, render_timeline_, &completed));
+        screenshots_->collect(completed);
+#ifdef VV_ENABLE_LOGGING
+        for (auto& msg : screenshots_->drain_messages()) log_line(msg);
+#endif
+    }
 #endif
 
-        state_.frame_number++;
+    { vv::cpu_zone c("render_graph"); build_frame_graph(eng, frm, imageIndex); render_graph_->execute(cmd); observe_attachment_lifetimes(); }
+
+    if (ui_) {
+        vv::cpu_zone c("imgui");
+        ui_->new_frame();
+        ui_->add_overlay([this] { metrics_->imgui_hud(); });
+        if (renderer_) { renderer_->on_imgui(eng, frm); }
+        vv::gpu_zone z(gpu_profiler_.get(), cmd, "imgui");
+        ui_->render_overlay(cmd, frm.swapchain_image, frm.swapchain_image_view, frm.swapchain_extent, render_graph_->layout(swapchain_resource_));
     }
+
+    if (current_frame().asyncComputeSubmitted) release_async_outputs(cmd);
+    end_frame(imageIndex, cmd);
+
+    sample_engine_metrics(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - cpu_begin).count());
+    state_.frame_number++;
+    return true;
 }
 
 void VulkanEngine::cleanup() {
     if (ctx_.device) { vkDeviceWaitIdle(ctx_.device); destroy_imgui(); }
+#ifdef VV_ENABLE_SCREENSHOT
+    if (screenshots_) {
+        screenshots_->collect(UINT64_MAX); // device is idle: every queued readback is complete
+        screenshots_->shutdown(ctx_.allocator);
+#ifdef VV_ENABLE_LOGGING
+        for (auto& msg : screenshots_->drain_messages()) log_line(msg);
+#endif
+        screenshots_.reset();
+    }
+#endif
     if (renderer_) { renderer_->on_swapchain_destroy(make_engine_context()); }
     destroy_command_buffers();
     for (auto& f : std::ranges::reverse_view(mdq_)) { f(); }
     mdq_.clear();
     destroy_context();
+#ifdef VV_ENABLE_LOGGING
+    vv::Log::stop(); // flushes what the shutdown logged
+#endif
 }
 
 void VulkanEngine::set_renderer(std::unique_ptr<IRenderer> r) { renderer_ = std::move(r); }
 void VulkanEngine::configure_window(uint32_t w, uint32_t h, std::string_view title) { state_.width = w; state_.height = h; state_.name = std::string(title); }
+void VulkanEngine::configure_dynamic_resolution(double target_gpu_ms, float min_scale, float max_scale) {
+    if (state_.initialized && renderer_caps_.presentation_mode != PresentationMode::EngineBlit) { VV_LOG_WARN("Dynamic resolution needs PresentationMode::EngineBlit"); return; }
+    max_scale = std::clamp(max_scale, 0.25f, 2.0f);
+    min_scale = std::clamp(min_scale, 0.25f, max_scale);
+    state_.targets_dirty |= state_.initialized && max_scale != resolution_.max_scale; // attachments are sized for max_scale
+    resolution_ = DynamicResolution{.target_gpu_ms = std::max(0.0, target_gpu_ms), .min_scale = min_scale, .max_scale = max_scale, .scale = std::clamp(1.0f, min_scale, max_scale)};
+}
+void VulkanEngine::set_render_scale(float scale) {
+    resolution_.scale       = std::clamp(scale, resolution_.min_scale, resolution_.max_scale);
+    resolution_.cooldown    = frames_in_flight_;
+    resolution_.samples     = 0;
+    resolution_.filtered_ms = 0.0;
+}
+static std::string resolve_attachment_name(std::string_view name) { return std::string(name) + "_resolve"; }
+
+#ifdef VV_ENABLE_TONEMAP
+static bool is_float_format(VkFormat f) {
+    switch (f) {
+    case VK_FORMAT_R16G16B16A16_SFLOAT: case VK_FORMAT_R32G32B32A32_SFLOAT: case VK_FORMAT_B10G11R11_UFLOAT_PACK32: case VK_FORMAT_E5B9G9R9_UFLOAT_PACK32:
+    case VK_FORMAT_R16G16B16_SFLOAT: case VK_FORMAT_R32G32B32_SFLOAT: return true;
+    default: return false;
+    }
+}
+#endif
+
 void VulkanEngine::sanitize_renderer_caps(RendererCaps& caps) const {
+    if (state_.headless) {
+        // No window: no ImGui and nothing to present; the attachments are the only render targets
+        caps.enable_imgui = false;
+        if (caps.presentation_mode == PresentationMode::DirectToSwapchain) caps.presentation_mode = PresentationMode::EngineBlit;
+    }
+    caps.frames_in_flight = std::clamp(caps.frames_in_flight, 1u, MAX_FRAMES_IN_FLIGHT);
     caps.swapchain_usage |= VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
 
     if (caps.presentation_mode != PresentationMode::DirectToSwapchain && caps.color_attachments.empty()) caps.color_attachments.push_back(AttachmentRequest{.name = "hdr_color"});
@@ -548,10 +1001,41 @@ void VulkanEngine::sanitize_renderer_caps(RendererCaps& caps) const {
     bool found = false; for (const auto& att : caps.color_attachments) { if (att.name == caps.presentation_attachment) { found = true; break; } }
     if (!found && !caps.color_attachments.empty()) caps.presentation_attachment = caps.color_attachments.front().name;
 
+    // Highest sample count at most `want` that the device supports for color and depth targets alike
+    VkPhysicalDeviceProperties props{}; vkGetPhysicalDeviceProperties(ctx_.physical, &props);
+    const VkSampleCountFlags supported = props.limits.framebufferColorSampleCounts & props.limits.framebufferDepthSampleCounts;
+    auto supported_samples = [&](VkSampleCountFlagBits want) {
+        for (uint32_t s = want; s > VK_SAMPLE_COUNT_1_BIT; s >>= 1u) if (supported & s) return static_cast<VkSampleCountFlagBits>(s);
+        return VK_SAMPLE_COUNT_1_BIT;
+    };
+    caps.color_samples = supported_samples(caps.color_samples);
+
+    // Multisampled attachments cannot be blitted or stored to without extra features; their resolve targets take over both
+    std::vector<AttachmentRequest> resolves;
     for (auto& att : caps.color_attachments) {
         if (att.aspect == 0) att.aspect = VK_IMAGE_ASPECT_COLOR_BIT;
         if (att.samples == VK_SAMPLE_COUNT_1_BIT) att.samples = caps.color_samples;
-        if (caps.presentation_mode == PresentationMode::EngineBlit && att.name == caps.presentation_attachment) att.usage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+        att.samples = supported_samples(att.samples);
+        if (att.samples == VK_SAMPLE_COUNT_1_BIT) continue;
+        const bool presented = att.name == caps.presentation_attachment && caps.presentation_mode != PresentationMode::DirectToSwapchain;
+        if (presented && att.resolve_mode == VK_RESOLVE_MODE_NONE) att.resolve_mode = VK_RESOLVE_MODE_AVERAGE_BIT;
+        const VkImageUsageFlags usage = att.usage;
+        att.usage = (att.usage & ~(VK_IMAGE_USAGE_STORAGE_BIT | VK_IMAGE_USAGE_TRANSFER_SRC_BIT)) | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
+        if (att.resolve_mode == VK_RESOLVE_MODE_NONE) continue;
+        std::string name = resolve_attachment_name(att.name);
+        if (presented) caps.presentation_attachment = name;
+        if (std::ranges::find(caps.color_attachments, name, &AttachmentRequest::name) != caps.color_attachments.end()) continue;
+        resolves.push_back(AttachmentRequest{.name = std::move(name), .format = att.format, .usage = usage | VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT, .samples = VK_SAMPLE_COUNT_1_BIT,
+            .aspect = att.aspect, .initial_layout = att.initial_layout, .transient = false, .resolve_mode = VK_RESOLVE_MODE_NONE});
+    }
+    std::ranges::move(resolves, std::back_inserter(caps.color_attachments));
+
+    for (auto& att : caps.color_attachments) {
+        if (caps.presentation_mode != PresentationMode::EngineBlit || att.name != caps.presentation_attachment) continue;
+        att.usage |= VK_IMAGE_USAGE_TRANSFER_SRC_BIT;
+#ifdef VV_ENABLE_TONEMAP
+        if (!state_.headless && is_float_format(att.format)) att.usage |= VK_IMAGE_USAGE_SAMPLED_BIT; // read by the tonemap pass
+#endif
     }
 
     if (caps.presentation_mode == PresentationMode::EngineBlit) caps.swapchain_usage |= VK_IMAGE_USAGE_TRANSFER_DST_BIT;
@@ -564,6 +1048,7 @@ void VulkanEngine::sanitize_renderer_caps(RendererCaps& caps) const {
         caps.uses_depth = VK_TRUE;
         if (caps.depth_attachment->aspect == 0) caps.depth_attachment->aspect = VK_IMAGE_ASPECT_DEPTH_BIT;
         if (caps.depth_attachment->samples == VK_SAMPLE_COUNT_1_BIT) caps.depth_attachment->samples = caps.color_samples;
+        caps.depth_attachment->samples = supported_samples(caps.depth_attachment->samples);
     } else {
         caps.uses_depth = VK_FALSE;
     }
@@ -573,26 +1058,54 @@ void VulkanEngine::sanitize_renderer_caps(RendererCaps& caps) const {
 }
 
 void VulkanEngine::create_context(int window_width, int window_height, const char* app_name) {
-    vkb::InstanceBuilder ib; ib.set_app_name(app_name).request_validation_layers(false).use_default_debug_messenger().require_api_version(1, 3, 0);
+    vkb::InstanceBuilder ib; ib.set_app_name(app_name).request_validation_layers(false).use_default_debug_messenger().require_api_version(1, 3, 0).set_headless(state_.headless);
     for (const char* ext : renderer_caps_.extra_instance_extensions) ib.enable_extension(ext);
     vkb::Instance vkb_inst = ib.build().value();
     ctx_.instance          = vkb_inst.instance;
     ctx_.debug_messenger   = vkb_inst.debug_messenger;
-    int sdl_init_rc = SDL_Init(SDL_INIT_VIDEO);
-    REQUIRE_TRUE(sdl_init_rc, std::string("SDL_Init failed: ") + SDL_GetError());
-    ctx_.window = SDL_CreateWindow(app_name, window_width, window_height, SDL_WINDOW_VULKAN | SDL_WINDOW_RESIZABLE);
-    REQUIRE_TRUE(ctx_.window != nullptr, std::string("SDL_CreateWindow failed: ") + SDL_GetError());
-    REQUIRE_TRUE(SDL_Vulkan_CreateSurface(ctx_.window, ctx_.instance, nullptr, &ctx_.surface), std::string("SDL_Vulkan_CreateSurface failed: ") + SDL_GetError());
+    if (!state_.headless) {
+        int sdl_init_rc = SDL_Init(SDL_INIT_VIDEO);
+        REQUIRE_TRUE(sdl_init_rc, std::string("SDL_Init failed: ") + SDL_GetError());
+        ctx_.window = SDL_CreateWindow(app_name, window_width, window_height, SDL_WINDOW_VULKAN | SDL_WINDOW_RESIZABLE);
+        REQUIRE_TRUE(ctx_.window != nullptr, std::string("SDL_CreateWindow failed: ") + SDL_GetError());
+        REQUIRE_TRUE(SDL_Vulkan_CreateSurface(ctx_.window, ctx_.instance, nullptr, &ctx_.surface), std::string("SDL_Vulkan_CreateSurface failed: ") + SDL_GetError());
+    }
 
     VkPhysicalDeviceVulkan13Features f13{.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_3_FEATURES, .pNext = nullptr, .synchronization2 = VK_TRUE, .dynamicRendering = VK_TRUE};
     VkPhysicalDeviceVulkan12Features f12{.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES, .pNext = &f13, .descriptorIndexing = VK_TRUE, .bufferDeviceAddress = renderer_caps_.buffer_device_address ? VK_TRUE : VK_FALSE};
+    if (renderer_caps_.descriptor_indexing) {
+        // What the bindless heap relies on; all of it is mandatory for Vulkan 1.3 devices
+        f12.runtimeDescriptorArray                        = VK_TRUE;
+        f12.descriptorBindingPartiallyBound               = VK_TRUE;
+        f12.descriptorBindingUpdateUnusedWhilePending     = VK_TRUE;
+        f12.descriptorBindingStorageImageUpdateAfterBind  = VK_TRUE;
+        f12.descriptorBindingSampledImageUpdateAfterBind  = VK_TRUE;
+        f12.descriptorBindingStorageBufferUpdateAfterBind = VK_TRUE;
+        f12.shaderSampledImageArrayNonUniformIndexing     = VK_TRUE;
+        f12.shaderStorageBufferArrayNonUniformIndexing    = VK_TRUE;
+    }
 
     vkb::PhysicalDeviceSelector selector(vkb_inst);
-    selector.set_surface(ctx_.surface).set_minimum_version(1, 3).set_required_features_12(f12);
+    selector.set_minimum_version(1, 3).set_required_features_12(f12);
+    if (state_.headless) selector.require_present(false); // any device works, including software ICDs such as lavapipe
+    else selector.set_surface(ctx_.surface);
     for (const char* ext : renderer_caps_.extra_device_extensions) selector.add_required_extension(ext);
     vkb::PhysicalDevice phys = selector.select().value();
     ctx_.physical            = phys.physical_device;
 
+    // Optional frame pacing extensions: present ids let us wait until a given frame is actually on screen
+    VkPhysicalDevicePresentIdFeaturesKHR present_id_features{.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_ID_FEATURES_KHR, .pNext = nullptr, .presentId = VK_TRUE};
+    VkPhysicalDevicePresentWaitFeaturesKHR present_wait_features{.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PRESENT_WAIT_FEATURES_KHR, .pNext = nullptr, .presentWait = VK_TRUE};
+    bool present_wait = !state_.headless && phys.enable_extension_if_present(VK_KHR_PRESENT_ID_EXTENSION_NAME) && phys.enable_extension_if_present(VK_KHR_PRESENT_WAIT_EXTENSION_NAME);
+    present_wait      = present_wait && phys.enable_extension_features_if_present(present_id_features) && phys.enable_extension_features_if_present(present_wait_features);
+
+    ctx_.calibrated_timestamps = phys.enable_extension_if_present(VK_EXT_CALIBRATED_TIMESTAMPS_EXTENSION_NAME);
+    VkPhysicalDeviceFeatures stats_features{}; stats_features.pipelineStatisticsQuery = VK_TRUE;
+    ctx_.pipeline_statistics   = phys.enable_features_if_present(stats_features);
+    // Optional even on Vulkan 1.3: without it bindless storage image indices must be dynamically uniform
+    VkPhysicalDeviceVulkan12Features nonuniform_features{.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_FEATURES, .pNext = nullptr, .shaderStorageImageArrayNonUniformIndexing = VK_TRUE};
+    ctx_.storage_image_nonuniform = renderer_caps_.descriptor_indexing && phys.enable_extension_features_if_present(nonuniform_features);
+
     vkb::DeviceBuilder db(phys);
     vkb::Device vkbDev         = db.build().value();
     ctx_.device                = vkbDev.device;
@@ -604,19 +1117,41 @@ void VulkanEngine::create_context(int window_width, int window_height, const cha
     ctx_.compute_queue_family  = vkbDev.get_queue_index(vkb::QueueType::compute).value();
     ctx_.transfer_queue_family = vkbDev.get_queue_index(vkb::QueueType::transfer).value();
     ctx_.present_queue_family  = ctx_.graphics_queue_family;
+    pacing_.wait_for_present   = present_wait ? reinterpret_cast<PFN_vkWaitForPresentKHR>(vkGetDeviceProcAddr(ctx_.device, "vkWaitForPresentKHR")) : nullptr;
 
     VmaAllocatorCreateInfo ac{}; ac.flags = VMA_ALLOCATOR_CREATE_BUFFER_DEVICE_ADDRESS_BIT; ac.physicalDevice = ctx_.physical; ac.device = ctx_.device; ac.instance = ctx_.instance; ac.vulkanApiVersion = VK_API_VERSION_1_3; VK_CHECK(vmaCreateAllocator(&ac, &ctx_.allocator));
     mdq_.emplace_back([&] { vmaDestroyAllocator(ctx_.allocator); });
 
     std::vector<DescriptorAllocator::PoolSizeRatio> sizes = {{VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 2.0f}, {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 4.0f}, {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 4.0f}, {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 4.0f}};
-    ctx_.descriptor_allocator.init_pool(ctx_.device, 128, sizes);
-    mdq_.emplace_back([&] { ctx_.descriptor_allocator.destroy_pool(ctx_.device); });
+    ctx_.descriptor_allocator = std::make_unique<DescriptorAllocator>();
+    ctx_.descriptor_allocator->init_pool(ctx_.device, 128, sizes); // a starting size only: pools grow on demand
+    mdq_.emplace_back([&] { ctx_.descriptor_allocator->destroy_pool(ctx_.device); ctx_.descriptor_allocator.reset(); });
 
     VkSemaphoreTypeCreateInfo type_ci{.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO, .pNext = nullptr, .semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE, .initialValue = 0};
     VkSemaphoreCreateInfo sem_ci{.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO, .pNext = &type_ci, .flags = 0u};
     VK_CHECK(vkCreateSemaphore(ctx_.device, &sem_ci, nullptr, &render_timeline_));
     mdq_.emplace_back([&] { vkDestroySemaphore(ctx_.device, render_timeline_, nullptr); });
     timeline_value_ = 0;
+
+    retire_queue_ = std::make_unique<vv::RetireQueue>();
+    retire_queue_->init(ctx_.device, ctx_.allocator, render_timeline_);
+    mdq_.emplace_back([&] { retire_queue_->shutdown(); retire_queue_.reset(); }); // after everything later in mdq_ retired into it
+
+    if (pipeline_cache_dir_.empty()) {
+        char* pref = SDL_GetPrefPath("vulkan-visualizer", app_name);
+        pipeline_cache_dir_ = pref ? pref : "pipeline_cache";
+        SDL_free(pref);
+    }
+    pipeline_cache_ = std::make_unique<vv::PipelineCache>();
+    pipeline_cache_->init(ctx_.device, ctx_.physical, pipeline_cache_dir_); // a missing or stale file just means a cold start
+    mdq_.emplace_back([&] { pipeline_cache_->shutdown(); pipeline_cache_.reset(); }); // saves what this run compiled
+
+    shaders_ = std::make_unique<vv::ShaderService>();
+    shaders_->init(ctx_.device, std::filesystem::path(pipeline_cache_dir_) / "spirv", std::clamp(std::thread::hardware_concurrency() / 4u, 1u, 4u));
+#ifdef VV_SHADER_INCLUDE_DIR
+    shaders_->add_include_dir(VV_SHADER_INCLUDE_DIR);
+#endif
+    mdq_.emplace_back([&] { shaders_->shutdown(); shaders_.reset(); });
 }
 
 void VulkanEngine::destroy_context() {
@@ -642,7 +1177,7 @@ EngineContext VulkanEngine::make_engine_context() const {
     eng.physical              = ctx_.physical;
     eng.device                = ctx_.device;
     eng.allocator             = ctx_.allocator;
-    eng.descriptorAllocator   = const_cast<DescriptorAllocator*>(&ctx_.descriptor_allocator);
+    eng.descriptorAllocator   = ctx_.descriptor_allocator.get();
     eng.window                = ctx_.window;
     eng.graphics_queue        = ctx_.graphics_queue;
     eng.compute_queue         = ctx_.compute_queue;
@@ -653,6 +1188,15 @@ EngineContext VulkanEngine::make_engine_context() const {
     eng.transfer_queue_family = ctx_.transfer_queue_family;
     eng.present_queue_family  = ctx_.present_queue_family;
     eng.services              = ui_ ? static_cast<vv_ui::TabsHost*>(ui_.get()) : nullptr;
+    eng.gpu_profiler          = gpu_profiler_.get();
+    eng.render_graph          = render_graph_.get();
+    eng.retire_queue          = retire_queue_.get();
+    eng.async_compute         = compute_timeline_ != VK_NULL_HANDLE;
+    eng.uploads               = uploads_.get();
+    eng.pipeline_cache        = pipeline_cache_.get();
+    eng.shaders               = shaders_.get();
+    eng.bindless              = bindless_.get();
+    eng.metrics               = metrics_.get();
     return eng;
 }
 
@@ -660,7 +1204,9 @@ FrameContext VulkanEngine::make_frame_context(uint64_t frame_index, uint32_t ima
     FrameContext frm{};
     frm.frame_index      = frame_index;
     frm.image_index      = image_index;
-    frm.extent           = extent;
+    frm.extent           = scaled_extent(extent, resolution_.scale);
+    frm.swapchain_extent = extent;
+    frm.render_scale     = resolution_.scale;
     frm.swapchain_format = swapchain_.swapchain_image_format;
     frm.dt_sec           = state_.dt_sec;
     frm.time_sec         = state_.time_sec;
@@ -669,6 +1215,11 @@ FrameContext VulkanEngine::make_frame_context(uint64_t frame_index, uint32_t ima
         frm.swapchain_image_view = swapchain_.swapchain_image_views[image_index];
     }
 
+    // Aliased attachments start every frame undefined; the others where the render graph left them
+    auto layout_at_frame_start = [&](const AttachmentResource& att) {
+        if (att.alias_block != UINT32_MAX) return VK_IMAGE_LAYOUT_UNDEFINED;
+        return render_graph_ ? render_graph_->tracked_layout(att.image.image, att.initial_layout) : att.initial_layout;
+    };
     frame_attachment_views_.clear();
     frame_attachment_views_.reserve(swapchain_.color_attachments.size());
     for (const auto& att : swapchain_.color_attachments) {
@@ -681,7 +1232,14 @@ FrameContext VulkanEngine::make_frame_context(uint64_t frame_index, uint32_t ima
             .samples        = att.samples,
             .usage          = att.usage,
             .aspect         = att.aspect,
-            .current_layout = att.initial_layout});
+            .current_layout = layout_at_frame_start(att)});
+    }
+    for (size_t i = 0; i < swapchain_.color_attachments.size(); ++i) {
+        const int r = swapchain_.color_attachments[i].resolve_index;
+        if (r < 0) continue;
+        frame_attachment_views_[i].resolve_image = frame_attachment_views_[static_cast<size_t>(r)].image;
+        frame_attachment_views_[i].resolve_view  = frame_attachment_views_[static_cast<size_t>(r)].view;
+        frame_attachment_views_[i].resolve_mode  = swapchain_.color_attachments[i].resolve_mode;
     }
     frm.color_attachments = frame_attachment_views_;
     if (!frame_attachment_views_.empty()) { frm.offscreen_image = frame_attachment_views_.front().image; frm.offscreen_image_view = frame_attachment_views_.front().view; }
@@ -697,7 +1255,7 @@ FrameContext VulkanEngine::make_frame_context(uint64_t frame_index, uint32_t ima
             .samples        = swapchain_.depth_attachment->samples,
             .usage          = swapchain_.depth_attachment->usage,
             .aspect         = swapchain_.depth_attachment->aspect,
-            .current_layout = swapchain_.depth_attachment->initial_layout};
+            .current_layout = layout_at_frame_start(*swapchain_.depth_attachment)};
         frm.depth_attachment = &depth_attachment_view_;
         frm.depth_image      = depth_attachment_view_.image;
         frm.depth_image_view = depth_attachment_view_.view;
@@ -711,65 +1269,147 @@ FrameContext VulkanEngine::make_frame_context(uint64_t frame_index, uint32_t ima
     return frm;
 }
 
-void VulkanEngine::blit_offscreen_to_swapchain(VkCommandBuffer cmd, uint32_t imageIndex, VkExtent2D extent) {
+VkExtent2D VulkanEngine::scaled_extent(VkExtent2D extent, float scale) {
+    return {std::max(1u, static_cast<uint32_t>(std::ceil(static_cast<float>(extent.width) * scale))), std::max(1u, static_cast<uint32_t>(std::ceil(static_cast<float>(extent.height) * scale)))};
+}
+
+void VulkanEngine::blit_offscreen_to_swapchain(VkCommandBuffer cmd, uint32_t imageIndex, VkExtent2D src_extent, VkExtent2D dst_extent) {
     if (renderer_caps_.presentation_mode != PresentationMode::EngineBlit) return;
     if (imageIndex >= swapchain_.swapchain_images.size()) return;
     if (presentation_attachment_index_ < 0 || presentation_attachment_index_ >= static_cast<int>(swapchain_.color_attachments.size())) return;
 
     const auto& srcAtt = swapchain_.color_attachments[static_cast<size_t>(presentation_attachment_index_)];
+    if (srcAtt.samples != VK_SAMPLE_COUNT_1_BIT) return; // not blittable; sanitize_renderer_caps presents its resolve target instead
     VkImage src        = srcAtt.image.image; if (src == VK_NULL_HANDLE) return; VkImage dst = swapchain_.swapchain_images[imageIndex];
-
-    VkImageMemoryBarrier2 barriers[2]{};
-    barriers[0].sType            = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
-    barriers[0].srcStageMask     = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
-    barriers[0].srcAccessMask    = VK_ACCESS_2_MEMORY_WRITE_BIT;
-    barriers[0].dstStageMask     = VK_PIPELINE_STAGE_2_TRANSFER_BIT;
-    barriers[0].dstAccessMask    = VK_ACCESS_2_TRANSFER_READ_BIT;
-    barriers[0].oldLayout        = VK_IMAGE_LAYOUT_GENERAL;
-    barriers[0].newLayout        = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL;
-    barriers[0].image            = src;
-    barriers[0].subresourceRange = {srcAtt.aspect, 0u, 1u, 0u, 1u};
-
-    barriers[1].sType            = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2;
-    barriers[1].srcStageMask     = VK_PIPELINE_STAGE_2_NONE;
-    barriers[1].srcAccessMask    = 0u;
-    barriers[1].dstStageMask     = VK_PIPELINE_STAGE_2_TRANSFER_BIT;
-    barriers[1].dstAccessMask    = VK_ACCESS_2_TRANSFER_WRITE_BIT;
-    barriers[1].oldLayout        = VK_IMAGE_LAYOUT_UNDEFINED;
-    barriers[1].newLayout        = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
-    barriers[1].image            = dst;
-    barriers[1].subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0u, 1u, 0u, 1u};
-
-    VkDependencyInfo dep{}; dep.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO; dep.imageMemoryBarrierCount = 2u; dep.pImageMemoryBarriers = barriers; vkCmdPipelineBarrier2(cmd, &dep);
+    // Runs as the "blit" render graph pass: src is in TRANSFER_SRC_OPTIMAL and dst in TRANSFER_DST_OPTIMAL
 
     VkImageBlit2 blit{}; blit.sType = VK_STRUCTURE_TYPE_IMAGE_BLIT_2; blit.srcSubresource = {srcAtt.aspect, 0, 0, 1}; blit.dstSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1};
-    blit.srcOffsets[0] = {0, 0, 0}; blit.srcOffsets[1] = {static_cast<int32_t>(srcAtt.image.imageExtent.width), static_cast<int32_t>(srcAtt.image.imageExtent.height), 1};
-    blit.dstOffsets[0] = {0, 0, 0}; blit.dstOffsets[1] = {static_cast<int32_t>(extent.width), static_cast<int32_t>(extent.height), 1};
+    // Only the rendered corner is read; with dynamic resolution it is smaller than the attachment and the filter upscales it
+    src_extent = {std::min(src_extent.width, srcAtt.image.imageExtent.width), std::min(src_extent.height, srcAtt.image.imageExtent.height)};
+    blit.srcOffsets[0] = {0, 0, 0}; blit.srcOffsets[1] = {static_cast<int32_t>(src_extent.width), static_cast<int32_t>(src_extent.height), 1};
+    blit.dstOffsets[0] = {0, 0, 0}; blit.dstOffsets[1] = {static_cast<int32_t>(dst_extent.width), static_cast<int32_t>(dst_extent.height), 1};
 
     VkBlitImageInfo2 bi{}; bi.sType = VK_STRUCTURE_TYPE_BLIT_IMAGE_INFO_2; bi.srcImage = src; bi.srcImageLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL; bi.dstImage = dst; bi.dstImageLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL; bi.regionCount = 1u; bi.pRegions = &blit; bi.filter = VK_FILTER_LINEAR; vkCmdBlitImage2(cmd, &bi);
 }
 
+// Imports the attachments and the acquired swapchain image, lets the renderer add its passes, then appends the engine's
+// presentation passes so compose/blit/screenshot are ordered and synchronized like any other pass.
+void VulkanEngine::build_frame_graph(const EngineContext& eng, const FrameContext& frm, uint32_t imageIndex) {
+    vv::RenderGraph& graph = *render_graph_;
+    graph.reset();
+
+    std::vector<std::pair<vv::RenderGraph::ResourceId, VkImageLayout>> attachments;
+    auto import_attachment = [&](const AttachmentResource& att) {
+        const auto id = att.alias_block != UINT32_MAX ? graph.import_transient_image(att.name, att.image.image, att.aspect, att.alias_block)
+                                                       : graph.import_image(att.name, att.image.image, att.aspect, {VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, VK_ACCESS_2_MEMORY_WRITE_BIT, att.initial_layout});
+        if (id != vv::RenderGraph::invalid) attachments.emplace_back(id, att.initial_layout);
+    };
+    for (const auto& att : swapchain_.color_attachments) import_attachment(att);
+    if (swapchain_.depth_attachment) import_attachment(*swapchain_.depth_attachment);
+
+    // Acquired images are ready at the acquire semaphore wait (COLOR_ATTACHMENT_OUTPUT), so the first barrier chains with
+    // it; DirectToSwapchain renderers have already written theirs in record_graphics() and leave it in TRANSFER_DST_OPTIMAL
+    swapchain_resource_ = vv::RenderGraph::invalid;
+    if (frm.swapchain_image) {
+        const vv::ResourceUse acquired = renderer_caps_.presentation_mode == PresentationMode::DirectToSwapchain
+            ? vv::ResourceUse{VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, VK_ACCESS_2_MEMORY_WRITE_BIT, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL}
+            : vv::ResourceUse{VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT, VK_ACCESS_2_NONE, VK_IMAGE_LAYOUT_UNDEFINED};
+        swapchain_resource_ = graph.import_image("swapchain", frm.swapchain_image, VK_IMAGE_ASPECT_COLOR_BIT, acquired, false);
+    }
+    const auto swap = swapchain_resource_;
+
+    if (renderer_) renderer_->build_render_graph(graph, eng, frm);
+    // Renderers without passes transition attachments by hand and expect them in their initial layout every frame
+    if (graph.pass_count() == 0) for (const auto& [id, initial] : attachments) graph.set_final_use(id, {VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, VK_ACCESS_2_MEMORY_READ_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT, initial});
+
+    const bool has_presentation = presentation_attachment_index_ >= 0 && presentation_attachment_index_ < static_cast<int>(swapchain_.color_attachments.size());
+    const auto presented = has_presentation ? graph.find(swapchain_.color_attachments[static_cast<size_t>(presentation_attachment_index_)].name) : vv::RenderGraph::invalid;
+    graph.mark_output(presented);
+
+    switch (renderer_caps_.presentation_mode) {
+    case PresentationMode::EngineBlit:
+#ifdef VV_ENABLE_TONEMAP
+        if (tonemapper_ && tonemap_enabled_ && swap != vv::RenderGraph::invalid && presented != vv::RenderGraph::invalid) {
+            // Replaces the blit: exposure, curve, dither and the render-scale upsample in the one write of the swapchain image
+            const auto& src = swapchain_.color_attachments[static_cast<size_t>(presentation_attachment_index_)];
+            tonemapper_->prepare(frame_slot(), src.image.imageView, src.image.imageExtent, frm.extent, frm.dt_sec);
+            if (tonemapper_->settings().auto_exposure) {
+                const auto histogram = graph.import_buffer("tonemap_histogram", tonemapper_->histogram_buffer());
+                const auto exposure  = graph.import_buffer("tonemap_exposure", tonemapper_->exposure_buffer());
+                graph.add_pass("luminance_histogram", [this](VkCommandBuffer cmd) { tonemapper_->record_histogram(cmd); })
+                    .use(presented, vv::use::sampled_compute)
+                    .use(histogram, vv::use::storage_rw_compute);
+                graph.add_pass("auto_exposure", [this](VkCommandBuffer cmd) { tonemapper_->record_exposure(cmd); })
+                    .use(histogram, vv::use::storage_rw_compute)
+                    .use(exposure, vv::use::storage_rw_compute);
+                graph.add_pass("tonemap", [this, view = frm.swapchain_image_view, dst = frm.swapchain_extent](VkCommandBuffer cmd) { vv::cpu_zone c("tonemap"); tonemapper_->record_present(cmd, view, dst); })
+                    .use(presented, vv::use::sampled_fragment)
+                    .use(exposure, vv::use::storage_read_fragment)
+                    .use(swap, vv::use::color_attachment_write);
+            } else {
+                graph.add_pass("tonemap", [this, view = frm.swapchain_image_view, dst = frm.swapchain_extent](VkCommandBuffer cmd) { vv::cpu_zone c("tonemap"); tonemapper_->record_present(cmd, view, dst); })
+                    .use(presented, vv::use::sampled_fragment)
+                    .use(swap, vv::use::color_attachment_write);
+            }
+            break;
+        }
+#endif
+        if (swap != vv::RenderGraph::invalid && presented != vv::RenderGraph::invalid) {
+            graph.add_pass("blit", [this, imageIndex, src = frm.extent, dst = frm.swapchain_extent](VkCommandBuffer cmd) { vv::cpu_zone c("blit"); blit_offscreen_to_swapchain(cmd, imageIndex, src, dst); })
+                .use(presented, vv::use::transfer_src)
+                .use(swap, vv::use::transfer_dst);
+        }
+        break;
+    case PresentationMode::RendererComposite:
+        // compose() may read any attachment in whatever layout the renderer left it
+        for (const auto& [id, initial] : attachments) graph.mark_output(id);
+        if (renderer_) {
+            graph.add_pass("compose", [this, &eng, &frm](VkCommandBuffer cmd) { vv::cpu_zone c("compose"); renderer_->compose(cmd, eng, frm); })
+                .use(swap, {VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, VK_ACCESS_2_MEMORY_READ_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL})
+                .side_effect();
+        }
+        break;
+    case PresentationMode::DirectToSwapchain: default: break; }
+
+#ifdef VV_ENABLE_SCREENSHOT
+    if (screenshot_.request && swap != vv::RenderGraph::invalid) graph.add_pass("screenshot", [this, imageIndex](VkCommandBuffer cmd) { queue_swapchain_screenshot(cmd, imageIndex); }).use(swap, vv::use::transfer_src).side_effect();
+#endif
+
+    // ImGui transitions to PRESENT_SRC itself, starting from graph.layout(swap)
+    if (swap != vv::RenderGraph::invalid) { if (ui_) graph.mark_output(swap); else graph.set_final_use(swap, vv::use::present); }
+}
+
 void VulkanEngine::create_swapchain(uint32_t width, uint32_t height) {
     swapchain_.swapchain_image_format = renderer_caps_.preferred_swapchain_format;
 #ifdef VV_ENABLE_TONEMAP
-    if (tonemap_enabled_) { swapchain_.swapchain_image_format = VK_FORMAT_B8G8R8A8_SRGB; use_srgb_swapchain_ = true; }
-    else { use_srgb_swapchain_ = false; }
+    if (srgb_swapchain_) swapchain_.swapchain_image_format = VK_FORMAT_B8G8R8A8_SRGB;
 #endif
+    if (state_.headless) { swapchain_.swapchain_extent = {std::max(1u, width), std::max(1u, height)}; return; }
     VkSurfaceFormatKHR surface_fmt{swapchain_.swapchain_image_format, VK_COLOR_SPACE_SRGB_NONLINEAR_KHR};
+    const VkSwapchainKHR old = swapchain_.swapchain;
 
     vkb::Swapchain sc = vkb::SwapchainBuilder(ctx_.physical, ctx_.device, ctx_.surface)
                             .set_desired_format(surface_fmt)
                             .set_desired_present_mode(renderer_caps_.present_mode)
                             .set_desired_extent(width, height)
                             .add_image_usage_flags(renderer_caps_.swapchain_usage)
+                            .set_old_swapchain(old)
                             .build()
                             .value();
 
+    if (old) {
+        // Frames still queued present from the retired swapchain; it goes once the first frame on the new one completes
+        for (auto v : swapchain_.swapchain_image_views) retire_queue_->retire(v, retire_queue_->frame_value());
+        retire_queue_->retire([device = ctx_.device, old] { vkDestroySwapchainKHR(device, old, nullptr); }, retire_queue_->frame_value());
+        swapchain_.swapchain_image_views.clear();
+    } else {
+        mdq_.emplace_back([&] { destroy_swapchain(); });
+    }
     swapchain_.swapchain             = sc.swapchain;
+    swapchain_.swapchain_image_format = sc.image_format; // the surface may not offer the desired format
     swapchain_.swapchain_extent      = sc.extent;
     swapchain_.swapchain_images      = sc.get_images().value();
     swapchain_.swapchain_image_views = sc.get_image_views().value();
-    mdq_.emplace_back([&] { destroy_swapchain(); });
 }
 void VulkanEngine::destroy_swapchain() {
     for (auto v : swapchain_.swapchain_image_views) IF_NOT_NULL_DO_AND_SET(v, vkDestroyImageView(ctx_.device, v, nullptr), VK_NULL_HANDLE);
@@ -777,14 +1417,15 @@ void VulkanEngine::destroy_swapchain() {
     swapchain_.swapchain_images.clear();
     IF_NOT_NULL_DO_AND_SET(swapchain_.swapchain, vkDestroySwapchainKHR(ctx_.device, swapchain_.swapchain, nullptr), VK_NULL_HANDLE);
 }
+// No device idle: the old swapchain, attachments and the renderer's size-dependent resources are retired against
+// timeline values, so frames already queued finish on them while new frames record against the replacements.
 void VulkanEngine::recreate_swapchain() {
     if (!ctx_.device) return;
 
-    if (renderer_) { renderer_->on_swapchain_destroy(make_engine_context()); }
+    IF_NOT_NULL_DO(renderer_, renderer_->on_swapchain_destroy(make_engine_context()));
 
-    vkDeviceWaitIdle(ctx_.device);
-    destroy_swapchain();
     destroy_renderer_targets();
+    pacing_.displayed_id = pacing_.present_id; // present ids of the retired swapchain will never be waited on
 
     int pxw = 0; int pxh = 0; SDL_GetWindowSizeInPixels(ctx_.window, &pxw, &pxh); pxw = std::max(1, pxw); pxh = std::max(1, pxh);
 
@@ -797,8 +1438,16 @@ void VulkanEngine::recreate_swapchain() {
 
     IF_NOT_NULL_DO(renderer_, renderer_->on_swapchain_ready(make_engine_context(), frm));
 
+#ifdef VV_ENABLE_TONEMAP
+    if (tonemapper_ && tonemapper_->target_format() != swapchain_.swapchain_image_format) {
+        vkDeviceWaitIdle(ctx_.device); // rare (sRGB toggle): its present pipeline is built for the old format
+        destroy_tonemapper();
+        create_tonemapper();
+    }
+#endif
     if (ui_) {
         if (imgui_format_ != swapchain_.swapchain_image_format) {
+            vkDeviceWaitIdle(ctx_.device); // rare (sRGB toggle): the ImGui backend owns pipelines built for the old format
             ui_->shutdown(ctx_.device);
             ui_.reset();
             create_imgui();
@@ -810,16 +1459,91 @@ void VulkanEngine::recreate_swapchain() {
     state_.resize_requested = false;
 }
 
+// Transient attachment lifetimes come from the executed graph. Targets are rebuilt once they are first known, and again
+// whenever attachments sharing a block are seen overlapping; lifetimes are merged over frames so the plan settles.
+// compose() may read any attachment outside the graph, so RendererComposite never aliases.
+void VulkanEngine::observe_attachment_lifetimes() {
+    if (render_graph_->pass_count() == 0 || renderer_caps_.presentation_mode == PresentationMode::RendererComposite) return;
+    std::vector<const AttachmentResource*> transients;
+    for (const auto& att : swapchain_.color_attachments) if (att.transient) transients.push_back(&att);
+    if (swapchain_.depth_attachment && swapchain_.depth_attachment->transient) transients.push_back(&*swapchain_.depth_attachment);
+    if (transients.size() < 2) return;
+
+    bool changed = !aliasing_.observed;
+    for (const AttachmentResource* att : transients) {
+        const auto lt = render_graph_->lifetime(render_graph_->find(att->name));
+        auto it       = std::ranges::find(aliasing_.lifetimes, att->name, &std::pair<std::string, vv::RenderGraph::Lifetime>::first);
+        if (it == aliasing_.lifetimes.end()) { aliasing_.lifetimes.emplace_back(att->name, lt); changed = true; continue; }
+        if (lt.empty()) continue;
+        it->second = {std::min(it->second.first, lt.first), it->second.empty() ? lt.last : std::max(it->second.last, lt.last)};
+        // Only a conflict inside an existing block forces new targets; other growth is picked up by the next rebuild
+        if (att->alias_block == UINT32_MAX) continue;
+        for (const AttachmentResource* other : transients) {
+            if (other == att || other->alias_block != att->alias_block) continue;
+            if (lt.overlaps(render_graph_->lifetime(render_graph_->find(other->name)))) { changed = true; VV_LOG_WARN("Aliased attachments %s and %s overlap; rebuilding targets", att->name.c_str(), other->name.c_str()); }
+        }
+    }
+    aliasing_.observed = true;
+    state_.targets_dirty |= changed;
+}
+
+void VulkanEngine::rebuild_renderer_targets() {
+    state_.targets_dirty = false;
+    IF_NOT_NULL_DO(renderer_, renderer_->on_swapchain_destroy(make_engine_context()));
+    create_renderer_targets(swapchain_.swapchain_extent);
+    FrameContext frm         = make_frame_context(state_.frame_number, 0u, swapchain_.swapchain_extent);
+    frm.swapchain_image      = VK_NULL_HANDLE;
+    frm.swapchain_image_view = VK_NULL_HANDLE;
+    IF_NOT_NULL_DO(renderer_, renderer_->on_swapchain_ready(make_engine_context(), frm));
+}
+
 void VulkanEngine::create_renderer_targets(VkExtent2D extent) {
     destroy_renderer_targets();
 
-    const uint32_t width  = std::max(1u, extent.width);
-    const uint32_t height = std::max(1u, extent.height);
+    // Large enough for the highest render scale; frames render into the top-left FrameContext::extent
+    extent                = scaled_extent(extent, resolution_.max_scale);
+    const uint32_t width  = extent.width;
+    const uint32_t height = extent.height;
 
     swapchain_.color_attachments.clear();
     swapchain_.color_attachments.reserve(renderer_caps_.color_attachments.size());
 
+    // Transient attachments with an observed lifetime are created unbound and placed into shared allocations below
+    auto lifetime_of = [&](const std::string& name) -> const vv::RenderGraph::Lifetime* {
+        for (const auto& [n, lt] : aliasing_.lifetimes) if (n == name) return &lt;
+        return nullptr;
+    };
+    auto create_view = [&](AttachmentResource& out) {
+        VkImageViewCreateInfo viewci{.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
+            .pNext                          = nullptr,
+            .flags                          = 0u,
+            .image                          = out.image.image,
+            .viewType                       = VK_IMAGE_VIEW_TYPE_2D,
+            .format                         = out.image.imageFormat,
+            .components                     = {VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY},
+            .subresourceRange               = {out.aspect, 0u, 1u, 0u, 1u}};
+        VK_CHECK(vkCreateImageView(ctx_.device, &viewci, nullptr, &out.image.imageView));
+    };
+    const VmaAllocationCreateInfo ainfo{.flags = 0u,
+        .usage                                 = VMA_MEMORY_USAGE_GPU_ONLY,
+        .requiredFlags                         = static_cast<VkMemoryPropertyFlags>(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT),
+        .preferredFlags                        = 0u,
+        .memoryTypeBits                        = 0u,
+        .pool                                  = VK_NULL_HANDLE,
+        .pUserData                             = nullptr,
+        .priority                              = 1.0f};
+
     auto create_image = [&](const AttachmentRequest& req, AttachmentResource& out) {
+        out.image.imageFormat = req.format;
+        out.image.imageExtent = {width, height, 1u};
+        out.usage             = req.usage;
+        out.aspect            = req.aspect;
+        out.samples           = req.samples;
+        out.initial_layout    = req.initial_layout;
+        out.transient         = req.transient;
+        out.resolve_mode      = req.samples != VK_SAMPLE_COUNT_1_BIT ? req.resolve_mode : VK_RESOLVE_MODE_NONE;
+        const bool aliasable  = req.transient && lifetime_of(out.name) != nullptr;
+
         VkImageCreateInfo imgci{.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO,
             .pNext                     = nullptr,
             .flags                     = 0u,
@@ -834,45 +1558,60 @@ void VulkanEngine::create_renderer_targets(VkExtent2D extent) {
             .sharingMode               = VK_SHARING_MODE_EXCLUSIVE,
             .queueFamilyIndexCount     = 0u,
             .pQueueFamilyIndices       = nullptr,
-            .initialLayout             = req.initial_layout};
-
-        VmaAllocationCreateInfo ainfo{.flags = 0u,
-            .usage                       = VMA_MEMORY_USAGE_GPU_ONLY,
-            .requiredFlags               = static_cast<VkMemoryPropertyFlags>(VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT),
-            .preferredFlags              = 0u,
-            .memoryTypeBits              = 0u,
-            .pool                        = VK_NULL_HANDLE,
-            .pUserData                   = nullptr,
-            .priority                    = 1.0f};
+            .initialLayout             = aliasable ? VK_IMAGE_LAYOUT_UNDEFINED : req.initial_layout};
 
+        if (aliasable) { VK_CHECK(vkCreateImage(ctx_.device, &imgci, nullptr, &out.image.image)); return; }
         VK_CHECK(vmaCreateImage(ctx_.allocator, &imgci, &ainfo, &out.image.image, &out.image.allocation, nullptr));
-
-        VkImageViewCreateInfo viewci{.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO,
-            .pNext                          = nullptr,
-            .flags                          = 0u,
-            .image                          = out.image.image,
-            .viewType                       = VK_IMAGE_VIEW_TYPE_2D,
-            .format                         = req.format,
-            .components                     = {VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY, VK_COMPONENT_SWIZZLE_IDENTITY},
-            .subresourceRange               = {req.aspect, 0u, 1u, 0u, 1u}};
-        VK_CHECK(vkCreateImageView(ctx_.device, &viewci, nullptr, &out.image.imageView));
-
-        out.image.imageFormat = req.format;
-        out.image.imageExtent = {width, height, 1u};
-        out.usage             = req.usage;
-        out.aspect            = req.aspect;
-        out.samples           = req.samples;
-        out.initial_layout    = req.initial_layout;
+        create_view(out);
     };
 
     for (const auto& req : renderer_caps_.color_attachments) {
         AttachmentResource res{}; res.name = req.name; create_image(req, res); swapchain_.color_attachments.push_back(std::move(res));
     }
+    for (auto& att : swapchain_.color_attachments) {
+        if (att.resolve_mode == VK_RESOLVE_MODE_NONE) continue;
+        const auto it = std::ranges::find(swapchain_.color_attachments, resolve_attachment_name(att.name), &AttachmentResource::name);
+        if (it != swapchain_.color_attachments.end()) att.resolve_index = static_cast<int>(it - swapchain_.color_attachments.begin());
+    }
 
     if (renderer_caps_.depth_attachment) {
         AttachmentResource depth{}; depth.name = renderer_caps_.depth_attachment->name.empty() ? "depth" : renderer_caps_.depth_attachment->name; create_image(*renderer_caps_.depth_attachment, depth); swapchain_.depth_attachment = std::move(depth);
     } else { swapchain_.depth_attachment.reset(); }
 
+    // Greedy interval colouring: in order of first use, each unbound attachment joins the first block whose members are all
+    // done before it starts (and that has a compatible memory type); blocks of one get a dedicated allocation.
+    struct Block { std::vector<AttachmentResource*> members; VkMemoryRequirements reqs{}; uint32_t last{0}; bool any_used{false}; };
+    std::vector<AttachmentResource*> unbound;
+    for (auto& att : swapchain_.color_attachments) if (att.image.image && !att.image.imageView) unbound.push_back(&att);
+    if (swapchain_.depth_attachment && swapchain_.depth_attachment->image.image && !swapchain_.depth_attachment->image.imageView) unbound.push_back(&*swapchain_.depth_attachment);
+    std::ranges::stable_sort(unbound, {}, [&](const AttachmentResource* a) { return lifetime_of(a->name)->first; });
+
+    std::vector<Block> blocks;
+    for (AttachmentResource* att : unbound) {
+        const vv::RenderGraph::Lifetime lt = *lifetime_of(att->name);
+        VkMemoryRequirements reqs{}; vkGetImageMemoryRequirements(ctx_.device, att->image.image, &reqs);
+        auto fits = [&](const Block& b) { return (b.reqs.memoryTypeBits & reqs.memoryTypeBits) != 0 && (lt.empty() || !b.any_used || b.last < lt.first); };
+        auto it = std::ranges::find_if(blocks, fits);
+        if (it == blocks.end()) { blocks.push_back(Block{.members = {}, .reqs = reqs, .last = 0u, .any_used = false}); it = std::prev(blocks.end()); }
+        else { it->reqs.size = std::max(it->reqs.size, reqs.size); it->reqs.alignment = std::max(it->reqs.alignment, reqs.alignment); it->reqs.memoryTypeBits &= reqs.memoryTypeBits; }
+        if (!lt.empty()) { it->last = std::max(it->last, lt.last); it->any_used = true; }
+        it->members.push_back(att);
+        aliasing_.dedicated_bytes += reqs.size;
+    }
+    for (Block& b : blocks) {
+        VmaAllocation alloc = VK_NULL_HANDLE;
+        VK_CHECK(vmaAllocateMemory(ctx_.allocator, &b.reqs, &ainfo, &alloc, nullptr));
+        aliasing_.aliased_bytes += b.reqs.size;
+        const bool shared = b.members.size() > 1;
+        if (shared) aliasing_.blocks.push_back(alloc);
+        for (AttachmentResource* att : b.members) {
+            VK_CHECK(vmaBindImageMemory(ctx_.allocator, alloc, att->image.image));
+            if (shared) att->alias_block = static_cast<uint32_t>(aliasing_.blocks.size() - 1u);
+            else att->image.allocation = alloc;
+            create_view(*att);
+        }
+    }
+
     presentation_attachment_index_ = -1;
     for (size_t i = 0; i < swapchain_.color_attachments.size(); ++i) { if (swapchain_.color_attachments[i].name == renderer_caps_.presentation_attachment) { presentation_attachment_index_ = static_cast<int>(i); break; } }
     if (presentation_attachment_index_ == -1 && !swapchain_.color_attachments.empty()) presentation_attachment_index_ = 0;
@@ -880,20 +1619,32 @@ void VulkanEngine::create_renderer_targets(VkExtent2D extent) {
     mdq_.emplace_back([&] { destroy_renderer_targets(); });
 }
 
+// Graph state is dropped now; the images, views and shared blocks are retired until in-flight frames stop using them
 void VulkanEngine::destroy_renderer_targets() {
+    std::vector<AllocatedImage> images;
     for (auto& att : swapchain_.color_attachments) {
-        IF_NOT_NULL_DO_AND_SET(att.image.imageView, vkDestroyImageView(ctx_.device, att.image.imageView, nullptr), VK_NULL_HANDLE);
-        IF_NOT_NULL_DO_AND_SET(att.image.image, vmaDestroyImage(ctx_.allocator, att.image.image, att.image.allocation), VK_NULL_HANDLE);
+        if (render_graph_ && att.image.image) render_graph_->forget_image(att.image.image);
+        if (att.image.image) images.push_back(att.image);
         att.image = {};
     }
     swapchain_.color_attachments.clear();
 
     if (swapchain_.depth_attachment) {
-        IF_NOT_NULL_DO_AND_SET(swapchain_.depth_attachment->image.imageView, vkDestroyImageView(ctx_.device, swapchain_.depth_attachment->image.imageView, nullptr), VK_NULL_HANDLE);
-        IF_NOT_NULL_DO_AND_SET(swapchain_.depth_attachment->image.image, vmaDestroyImage(ctx_.allocator, swapchain_.depth_attachment->image.image, swapchain_.depth_attachment->image.allocation), VK_NULL_HANDLE);
+        if (render_graph_ && swapchain_.depth_attachment->image.image) render_graph_->forget_image(swapchain_.depth_attachment->image.image);
+        if (swapchain_.depth_attachment->image.image) images.push_back(swapchain_.depth_attachment->image);
         swapchain_.depth_attachment.reset();
     }
 
+    for (const auto& img : images) { retire_queue_->retire(img.imageView, timeline_value_); retire_queue_->retire(img.image, img.allocation, timeline_value_); }
+    // Aliased images carry no allocation of their own; their shared blocks go after them
+    for (uint32_t i = 0; i < aliasing_.blocks.size(); ++i) {
+        IF_NOT_NULL_DO(render_graph_, render_graph_->forget_memory(i));
+        retire_queue_->retire([allocator = ctx_.allocator, block = aliasing_.blocks[i]] { vmaFreeMemory(allocator, block); }, timeline_value_);
+    }
+    aliasing_.blocks.clear();
+    aliasing_.dedicated_bytes = 0;
+    aliasing_.aliased_bytes   = 0;
+
     frame_attachment_views_.clear();
     depth_attachment_view_ = {};
     presentation_attachment_index_ = -1;
@@ -901,6 +1652,7 @@ void VulkanEngine::destroy_renderer_targets() {
 
 void VulkanEngine::create_command_buffers() {
     VkCommandPoolCreateInfo pci{.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO, .pNext = nullptr, .flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT, .queueFamilyIndex = ctx_.graphics_queue_family};
+    frames_.assign(frames_in_flight_, FrameData{});
     for (auto& fr : frames_) {
         VK_CHECK(vkCreateCommandPool(ctx_.device, &pci, nullptr, &fr.commandPool));
         VkCommandBufferAllocateInfo ai{.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO, .pNext = nullptr, .commandPool = fr.commandPool, .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY, .commandBufferCount = 1u};
@@ -914,92 +1666,267 @@ void VulkanEngine::create_command_buffers() {
             VK_CHECK(vkCreateCommandPool(ctx_.device, &cpool, nullptr, &fr.computeCommandPool));
             VkCommandBufferAllocateInfo cai{.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO, .pNext = nullptr, .commandPool = fr.computeCommandPool, .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY, .commandBufferCount = 1u};
             VK_CHECK(vkAllocateCommandBuffers(ctx_.device, &cai, &fr.asyncComputeCommandBuffer));
-            VkSemaphoreCreateInfo sci2{.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO, .pNext = nullptr, .flags = 0u};
-            VK_CHECK(vkCreateSemaphore(ctx_.device, &sci2, nullptr, &fr.asyncComputeFinished));
         }
     }
+    if (renderer_caps_.allow_async_compute && ctx_.compute_queue && ctx_.compute_queue != ctx_.graphics_queue) {
+        VkSemaphoreTypeCreateInfo type_ci{.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO, .pNext = nullptr, .semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE, .initialValue = 0};
+        VkSemaphoreCreateInfo sem_ci{.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO, .pNext = &type_ci, .flags = 0u};
+        VK_CHECK(vkCreateSemaphore(ctx_.device, &sem_ci, nullptr, &compute_timeline_));
+        compute_value_ = 0;
+    }
+    recorder_ = std::make_unique<ParallelRecorder>();
+    recorder_->init(ctx_.device, ctx_.graphics_queue_family, frames_in_flight_);
     mdq_.emplace_back([&] { destroy_command_buffers(); });
 }
 void VulkanEngine::destroy_command_buffers() {
+    if (recorder_) { recorder_->shutdown(); recorder_.reset(); }
     for (auto& fr : frames_) {
         for (auto& f : std::ranges::reverse_view(fr.dq)) f();
         fr.dq.clear();
         IF_NOT_NULL_DO_AND_SET(fr.imageAcquired, vkDestroySemaphore(ctx_.device, fr.imageAcquired, nullptr), VK_NULL_HANDLE);
         IF_NOT_NULL_DO_AND_SET(fr.renderComplete, vkDestroySemaphore(ctx_.device, fr.renderComplete, nullptr), VK_NULL_HANDLE);
         IF_NOT_NULL_DO_AND_SET(fr.commandPool, vkDestroyCommandPool(ctx_.device, fr.commandPool, nullptr), VK_NULL_HANDLE);
-        IF_NOT_NULL_DO_AND_SET(fr.asyncComputeFinished, vkDestroySemaphore(ctx_.device, fr.asyncComputeFinished, nullptr), VK_NULL_HANDLE);
         IF_NOT_NULL_DO_AND_SET(fr.computeCommandPool, vkDestroyCommandPool(ctx_.device, fr.computeCommandPool, nullptr), VK_NULL_HANDLE);
         fr.mainCommandBuffer         = VK_NULL_HANDLE;
         fr.asyncComputeCommandBuffer = VK_NULL_HANDLE;
         fr.submitted_timeline_value  = 0;
     }
+    frames_.clear();
+    IF_NOT_NULL_DO_AND_SET(compute_timeline_, vkDestroySemaphore(ctx_.device, compute_timeline_, nullptr), VK_NULL_HANDLE);
+    async_outputs_.clear();
 }
 
 void VulkanEngine::begin_frame(uint32_t& imageIndex, VkCommandBuffer& cmd) {
-    FrameData& fr = frames_[state_.frame_number % FRAME_OVERLAP];
+    { vv::cpu_zone z("pace_frame"); pace_frame(); }
+    FrameData& fr = current_frame();
     if (fr.submitted_timeline_value > 0) {
+        vv::cpu_zone z("wait_frame_slot");
         VkSemaphore sem = render_timeline_;
         uint64_t val    = fr.submitted_timeline_value;
         VkSemaphoreWaitInfo wi{.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO, .pNext = nullptr, .flags = 0u, .semaphoreCount = 1u, .pSemaphores = &sem, .pValues = &val};
         VK_CHECK(vkWaitSemaphores(ctx_.device, &wi, UINT64_MAX));
-#ifdef VV_ENABLE_GPU_TIMESTAMPS
-        if (ts_query_pool_) {
-            const uint32_t base = static_cast<uint32_t>((state_.frame_number % FRAME_OVERLAP) * 2);
-            uint64_t ticks[2]{};
-            VkResult qres = vkGetQueryPoolResults(ctx_.device, ts_query_pool_, base, 2, sizeof(ticks), ticks, sizeof(uint64_t), VK_QUERY_RESULT_64_BIT);
-            if (qres == VK_SUCCESS && ticks[1] > ticks[0]) last_gpu_ms_ = (static_cast<double>(ticks[1] - ticks[0]) * ts_period_ns_) / 1.0e6;
-        }
-#endif
+        for (auto& f : std::ranges::reverse_view(fr.dq)) f();
+        fr.dq.clear();
+    }
+    retire_queue_->collect();
+    ctx_.descriptor_allocator->begin_frame(ctx_.device, frame_slot());
+    if (bindless_) bindless_->collect();
+    if (swapchain_.swapchain) {
+        vv::cpu_zone z("acquire");
+        const VkResult acq = vkAcquireNextImageKHR(ctx_.device, swapchain_.swapchain, UINT64_MAX, fr.imageAcquired, VK_NULL_HANDLE, &imageIndex);
+        if (acq == VK_ERROR_OUT_OF_DATE_KHR) { state_.resize_requested = true; cmd = VK_NULL_HANDLE; return; }
+        if (acq == VK_SUBOPTIMAL_KHR) state_.resize_requested = true; // image acquired and imageAcquired pending: render it, recreate after
+        else VK_CHECK(acq);
+    } else {
+        imageIndex = UINT32_MAX; // headless: no swapchain image this frame
     }
-    const VkResult acq = vkAcquireNextImageKHR(ctx_.device, swapchain_.swapchain, UINT64_MAX, fr.imageAcquired, VK_NULL_HANDLE, &imageIndex);
-    if (acq == VK_ERROR_OUT_OF_DATE_KHR || acq == VK_SUBOPTIMAL_KHR) { state_.resize_requested = true; cmd = VK_NULL_HANDLE; return; }
-    VK_CHECK(acq);
     VK_CHECK(vkResetCommandBuffer(fr.mainCommandBuffer, 0));
     cmd = fr.mainCommandBuffer;
     VkCommandBufferBeginInfo bi{.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO, .pNext = nullptr, .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT, .pInheritanceInfo = nullptr};
     VK_CHECK(vkBeginCommandBuffer(cmd, &bi));
-#ifdef VV_ENABLE_GPU_TIMESTAMPS
-    if (ts_query_pool_) {
-        const uint32_t base = static_cast<uint32_t>((state_.frame_number % FRAME_OVERLAP) * 2);
-        vkCmdResetQueryPool(cmd, ts_query_pool_, base, 2);
-        vkCmdWriteTimestamp2(cmd, VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT, ts_query_pool_, base);
+    if (gpu_profiler_) gpu_profiler_->begin_frame(cmd, frame_slot()); // resolves this slot's previous zones (already waited above)
+}
+
+// Queue family ownership transfer barriers for async compute outputs; `masks` gives {srcStage, srcAccess, dstStage, dstAccess}
+template <class Masks> static void record_ownership_barriers(VkCommandBuffer cmd, std::span<const AsyncComputeOutput* const> outs, uint32_t src_family, uint32_t dst_family, Masks&& masks) {
+    std::vector<VkImageMemoryBarrier2> images;
+    std::vector<VkBufferMemoryBarrier2> buffers;
+    for (const AsyncComputeOutput* o : outs) {
+        const auto [ss, sa, ds, da] = masks(*o);
+        if (o->image) images.push_back(VkImageMemoryBarrier2{.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2, .pNext = nullptr, .srcStageMask = ss, .srcAccessMask = sa, .dstStageMask = ds, .dstAccessMask = da, .oldLayout = o->layout, .newLayout = o->layout, .srcQueueFamilyIndex = src_family, .dstQueueFamilyIndex = dst_family, .image = o->image, .subresourceRange = o->range});
+        else if (o->buffer) buffers.push_back(VkBufferMemoryBarrier2{.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2, .pNext = nullptr, .srcStageMask = ss, .srcAccessMask = sa, .dstStageMask = ds, .dstAccessMask = da, .srcQueueFamilyIndex = src_family, .dstQueueFamilyIndex = dst_family, .buffer = o->buffer, .offset = 0, .size = VK_WHOLE_SIZE});
     }
-#endif
+    if (images.empty() && buffers.empty()) return;
+    const VkDependencyInfo dep{.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO, .pNext = nullptr, .dependencyFlags = 0u, .memoryBarrierCount = 0u, .pMemoryBarriers = nullptr, .bufferMemoryBarrierCount = static_cast<uint32_t>(buffers.size()), .pBufferMemoryBarriers = buffers.data(), .imageMemoryBarrierCount = static_cast<uint32_t>(images.size()), .pImageMemoryBarriers = images.data()};
+    vkCmdPipelineBarrier2(cmd, &dep);
 }
 
-void VulkanEngine::end_frame(uint32_t imageIndex, VkCommandBuffer cmd) {
-#ifdef VV_ENABLE_GPU_TIMESTAMPS
-    if (ts_query_pool_) {
-        const uint32_t base = static_cast<uint32_t>((state_.frame_number % FRAME_OVERLAP) * 2);
-        vkCmdWriteTimestamp2(cmd, VK_PIPELINE_STAGE_2_BOTTOM_OF_PIPE_BIT, ts_query_pool_, base + 1);
+// Records and submits this frame's async compute. The submission waits (on render_timeline_) only for the graphics frames
+// that last read its outputs and signals compute_timeline_; the graphics submission of the same frame waits for that value
+// at the stages reading the outputs. Ownership goes compute -> graphics here and back in release_async_outputs().
+void VulkanEngine::submit_async_compute(const EngineContext& eng, const FrameContext& frm, VkCommandBuffer graphics_cmd) {
+    vv::cpu_zone z("record_async_compute");
+    FrameData& fr                = current_frame();
+    fr.asyncComputeSubmitted     = false;
+    fr.asyncComputeWaitStages    = VK_PIPELINE_STAGE_2_NONE;
+    const bool transfer          = ctx_.compute_queue_family != ctx_.graphics_queue_family;
+    const VkCommandBuffer cmd    = fr.asyncComputeCommandBuffer;
+
+    async_frame_outputs_.clear();
+    renderer_->get_async_compute_outputs(eng, frm, async_frame_outputs_);
+    std::vector<const AsyncComputeOutput*> outputs, reacquire;
+    uint64_t wait_graphics = 0;
+    for (const auto& o : async_frame_outputs_) {
+        const uint64_t key = o.image ? (uint64_t)(o.image) : (uint64_t)(o.buffer);
+        if (!key) continue;
+        outputs.push_back(&o);
+        if (auto it = async_outputs_.find(key); it != async_outputs_.end()) {
+            wait_graphics = std::max(wait_graphics, it->second.graphics_value);
+            if (it->second.graphics_owned) reacquire.push_back(&o);
+        }
     }
-#endif
+
+    VK_CHECK(vkResetCommandBuffer(cmd, 0));
+    VkCommandBufferBeginInfo cbi{.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO, .pNext = nullptr, .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT, .pInheritanceInfo = nullptr};
+    VK_CHECK(vkBeginCommandBuffer(cmd, &cbi));
+    if (transfer) record_ownership_barriers(cmd, reacquire, ctx_.graphics_queue_family, ctx_.compute_queue_family, [](const AsyncComputeOutput&) { return std::array<uint64_t, 4>{VK_PIPELINE_STAGE_2_NONE, 0, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, VK_ACCESS_2_MEMORY_READ_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT}; });
+    // Zones are graphics-queue only (the query pools are reset on the graphics queue); ignore them on the compute queue
+    vv::GpuProfiler::set_active(nullptr);
+    const bool recorded = renderer_->record_async_compute(cmd, eng, frm);
+    vv::GpuProfiler::set_active(gpu_profiler_.get());
+    if (!recorded) { VK_CHECK(vkEndCommandBuffer(cmd)); return; } // never submitted: ownership is unchanged
+    if (transfer) record_ownership_barriers(cmd, outputs, ctx_.compute_queue_family, ctx_.graphics_queue_family, [](const AsyncComputeOutput&) { return std::array<uint64_t, 4>{VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, VK_ACCESS_2_MEMORY_WRITE_BIT, VK_PIPELINE_STAGE_2_NONE, 0}; });
     VK_CHECK(vkEndCommandBuffer(cmd));
-    FrameData& fr = frames_[state_.frame_number % FRAME_OVERLAP];
+
+    VkCommandBufferSubmitInfo cbsi{.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO, .pNext = nullptr, .commandBuffer = cmd, .deviceMask = 0};
+    VkSemaphoreSubmitInfo wait{.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO, .pNext = nullptr, .semaphore = render_timeline_, .value = wait_graphics, .stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, .deviceIndex = 0};
+    VkSemaphoreSubmitInfo signal{.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO, .pNext = nullptr, .semaphore = compute_timeline_, .value = ++compute_value_, .stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, .deviceIndex = 0};
+    VkSubmitInfo2 submit{.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2, .pNext = nullptr, .flags = 0u, .waitSemaphoreInfoCount = wait_graphics > 0 ? 1u : 0u, .pWaitSemaphoreInfos = &wait, .commandBufferInfoCount = 1, .pCommandBufferInfos = &cbsi, .signalSemaphoreInfoCount = 1, .pSignalSemaphoreInfos = &signal};
+    VK_CHECK(vkQueueSubmit2(ctx_.compute_queue, 1, &submit, VK_NULL_HANDLE));
+    fr.asyncComputeSubmitted = true;
+    async_stats_.submissions++;
+    if (wait_graphics < timeline_value_) async_stats_.overlapped++;
+
+    for (const AsyncComputeOutput* o : outputs) fr.asyncComputeWaitStages |= o->graphics_stages;
+    if (fr.asyncComputeWaitStages == VK_PIPELINE_STAGE_2_NONE) fr.asyncComputeWaitStages = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT;
+    if (transfer) record_ownership_barriers(graphics_cmd, outputs, ctx_.compute_queue_family, ctx_.graphics_queue_family, [](const AsyncComputeOutput& o) { return std::array<uint64_t, 4>{VK_PIPELINE_STAGE_2_NONE, 0, o.graphics_stages, o.graphics_access}; });
+}
+
+// End of the graphics command buffer: hand the frame's outputs back to the compute family and note the timeline value
+// end_frame() signals, which the next compute submission touching them waits for
+void VulkanEngine::release_async_outputs(VkCommandBuffer graphics_cmd) {
+    const bool transfer = ctx_.compute_queue_family != ctx_.graphics_queue_family;
+    std::vector<const AsyncComputeOutput*> outputs;
+    for (const auto& o : async_frame_outputs_) {
+        const uint64_t key = o.image ? (uint64_t)(o.image) : (uint64_t)(o.buffer);
+        if (!key) continue;
+        outputs.push_back(&o);
+        async_outputs_[key] = AsyncOutputState{.graphics_owned = false, .graphics_value = timeline_value_ + 1, .last_frame = state_.frame_number};
+    }
+    if (transfer) {
+        record_ownership_barriers(graphics_cmd, outputs, ctx_.graphics_queue_family, ctx_.compute_queue_family, [](const AsyncComputeOutput& o) { return std::array<uint64_t, 4>{o.graphics_stages, 0, VK_PIPELINE_STAGE_2_NONE, 0}; });
+        for (const AsyncComputeOutput* o : outputs) async_outputs_[o->image ? (uint64_t)(o->image) : (uint64_t)(o->buffer)].graphics_owned = true;
+    }
+    // Handles not declared for a while belong to destroyed or idle resources; a recycled handle must not inherit their state
+    std::erase_if(async_outputs_, [&](const auto& kv) { return kv.second.last_frame + 16 < state_.frame_number; });
+}
+
+void VulkanEngine::end_frame(uint32_t imageIndex, VkCommandBuffer cmd) {
+    if (gpu_profiler_) gpu_profiler_->end_frame(cmd);
+    VK_CHECK(vkEndCommandBuffer(cmd));
+    FrameData& fr = current_frame();
 
     VkCommandBufferSubmitInfo cbsi{.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO, .pNext = nullptr, .commandBuffer = cmd, .deviceMask = 0u};
 
-    VkSemaphoreSubmitInfo waitInfos[2]{}; uint32_t waitCount = 0;
-    waitInfos[waitCount] = VkSemaphoreSubmitInfo{.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO, .pNext = nullptr, .semaphore = fr.imageAcquired, .value = 0u, .stageMask = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT, .deviceIndex = 0u};
-    waitCount++;
-    if (fr.asyncComputeSubmitted) { waitInfos[waitCount] = VkSemaphoreSubmitInfo{.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO, .pNext = nullptr, .semaphore = fr.asyncComputeFinished, .value = 0u, .stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, .deviceIndex = 0u}; waitCount++; }
+    const bool presenting = swapchain_.swapchain != VK_NULL_HANDLE;
+    VkSemaphoreSubmitInfo waitInfos[3]{}; uint32_t waitCount = 0;
+    if (presenting) { waitInfos[waitCount] = VkSemaphoreSubmitInfo{.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO, .pNext = nullptr, .semaphore = fr.imageAcquired, .value = 0u, .stageMask = VK_PIPELINE_STAGE_2_COLOR_ATTACHMENT_OUTPUT_BIT, .deviceIndex = 0u}; waitCount++; }
+    if (fr.asyncComputeSubmitted) { waitInfos[waitCount] = VkSemaphoreSubmitInfo{.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO, .pNext = nullptr, .semaphore = compute_timeline_, .value = compute_value_, .stageMask = fr.asyncComputeWaitStages, .deviceIndex = 0u}; waitCount++; }
+    if (uploads_ && uploads_->wait_value()) { waitInfos[waitCount] = VkSemaphoreSubmitInfo{.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO, .pNext = nullptr, .semaphore = uploads_->timeline(), .value = uploads_->wait_value(), .stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, .deviceIndex = 0u}; waitCount++; }
 
     timeline_value_++;
+    retire_queue_->set_submitted(timeline_value_);
     uint64_t timeline_to_signal = timeline_value_;
     VkSemaphoreSubmitInfo signalInfos[2]{
         VkSemaphoreSubmitInfo{.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO, .pNext = nullptr, .semaphore = fr.renderComplete, .value = 0u, .stageMask = VK_PIPELINE_STAGE_2_ALL_GRAPHICS_BIT, .deviceIndex = 0u},
         VkSemaphoreSubmitInfo{.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO, .pNext = nullptr, .semaphore = render_timeline_, .value = timeline_to_signal, .stageMask = VK_PIPELINE_STAGE_2_ALL_GRAPHICS_BIT, .deviceIndex = 0u}};
 
-    VkSubmitInfo2 si{.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2, .pNext = nullptr, .waitSemaphoreInfoCount = waitCount, .pWaitSemaphoreInfos = waitInfos, .commandBufferInfoCount = 1, .pCommandBufferInfos = &cbsi, .signalSemaphoreInfoCount = 2u, .pSignalSemaphoreInfos = signalInfos};
-    VK_CHECK(vkQueueSubmit2(ctx_.graphics_queue, 1, &si, VK_NULL_HANDLE));
+    // Headless frames only signal the timeline (signalInfos[1])
+    VkSubmitInfo2 si{.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2, .pNext = nullptr, .waitSemaphoreInfoCount = waitCount, .pWaitSemaphoreInfos = waitInfos, .commandBufferInfoCount = 1, .pCommandBufferInfos = &cbsi, .signalSemaphoreInfoCount = presenting ? 2u : 1u, .pSignalSemaphoreInfos = presenting ? signalInfos : &signalInfos[1]};
+    { vv::cpu_zone z("submit"); VK_CHECK(vkQueueSubmit2(ctx_.graphics_queue, 1, &si, VK_NULL_HANDLE)); }
     fr.submitted_timeline_value = timeline_to_signal;
-
-    VkPresentInfoKHR pi{.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR, .pNext = nullptr, .waitSemaphoreCount = 1u, .pWaitSemaphores = &fr.renderComplete, .swapchainCount = 1u, .pSwapchains = &swapchain_.swapchain, .pImageIndices = &imageIndex, .pResults = nullptr};
-    VkResult pres = vkQueuePresentKHR(ctx_.graphics_queue, &pi);
+    if (!presenting) return;
+
+    const uint64_t present_id = ++pacing_.present_id;
+    pacing_.frame_start_sec[present_id % pacing_.frame_start_sec.size()] = pacing_.last_frame_start;
+    VkPresentIdKHR pid{.sType = VK_STRUCTURE_TYPE_PRESENT_ID_KHR, .pNext = nullptr, .swapchainCount = 1u, .pPresentIds = &present_id};
+    VkPresentInfoKHR pi{.sType = VK_STRUCTURE_TYPE_PRESENT_INFO_KHR, .pNext = pacing_.wait_for_present ? &pid : nullptr, .waitSemaphoreCount = 1u, .pWaitSemaphores = &fr.renderComplete, .swapchainCount = 1u, .pSwapchains = &swapchain_.swapchain, .pImageIndices = &imageIndex, .pResults = nullptr};
+    VkResult pres = VK_SUCCESS;
+    { vv::cpu_zone z("present"); pres = vkQueuePresentKHR(ctx_.graphics_queue, &pi); }
     if (pres == VK_ERROR_OUT_OF_DATE_KHR || pres == VK_SUBOPTIMAL_KHR) { state_.resize_requested = true; return; }
     VK_CHECK(pres);
 }
 
+static double pacing_clock_sec() { return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count(); }
+
+void VulkanEngine::pace_frame() {
+    // 1) CPU frame limiter: sleep coarsely, then yield-spin the last millisecond for a stable cadence
+    double now = pacing_clock_sec();
+    if (pacing_.target_fps > 0.0) {
+        const double period   = 1.0 / pacing_.target_fps;
+        const double deadline = pacing_.last_frame_start + period;
+        const double slept_at = now;
+        if (deadline - now > 0.002) std::this_thread::sleep_for(std::chrono::duration<double>(deadline - now - 0.001));
+        while ((now = pacing_clock_sec()) < deadline) std::this_thread::yield();
+        pacing_.limiter_wait_ms  = (now - slept_at) * 1000.0;
+        pacing_.last_frame_start = now - deadline > period ? now : deadline; // resync instead of bursting after a hitch
+    } else {
+        pacing_.limiter_wait_ms  = 0.0;
+        pacing_.last_frame_start = now;
+    }
+
+    // 2) Queue depth: bound how many frames may be waiting between the CPU and the display
+    const uint32_t max_queued = pacing_.max_queued_frames;
+    if (pacing_.wait_for_present && swapchain_.swapchain) {
+        while (pacing_.displayed_id < pacing_.present_id) {
+            const uint64_t next    = pacing_.displayed_id + 1;
+            const bool must_block  = max_queued > 0 && pacing_.present_id - pacing_.displayed_id >= max_queued;
+            const VkResult r       = pacing_.wait_for_present(ctx_.device, swapchain_.swapchain, next, must_block ? 100'000'000ull : 0ull);
+            if (r == VK_ERROR_OUT_OF_DATE_KHR || r == VK_SUBOPTIMAL_KHR) { state_.resize_requested = true; break; }
+            if (r != VK_SUCCESS) break; // VK_TIMEOUT: not on screen yet
+            pacing_.displayed_id = next;
+            const double latency = (pacing_clock_sec() - pacing_.frame_start_sec[next % pacing_.frame_start_sec.size()]) * 1000.0;
+            pacing_.display_latency_ms = pacing_.display_latency_ms > 0.0 ? pacing_.display_latency_ms * 0.9 + latency * 0.1 : latency;
+        }
+        pacing_.queue_depth = static_cast<uint32_t>(pacing_.present_id - pacing_.displayed_id);
+    } else {
+        // Fallback: GPU completion on the render timeline stands in for display
+        uint64_t completed = 0; VK_CHECK(vkGetSemaphoreCounterValue(ctx_.device, render_timeline_, &completed));
+        if (max_queued > 0 && timeline_value_ >= completed + max_queued) {
+            const uint64_t val = timeline_value_ + 1 - max_queued;
+            VkSemaphoreWaitInfo wi{.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO, .pNext = nullptr, .flags = 0u, .semaphoreCount = 1u, .pSemaphores = &render_timeline_, .pValues = &val};
+            VK_CHECK(vkWaitSemaphores(ctx_.device, &wi, UINT64_MAX));
+            completed = val;
+        }
+        pacing_.queue_depth = static_cast<uint32_t>(timeline_value_ - completed);
+        const double latency = (pacing_clock_sec() - pacing_.last_frame_start) * 1000.0 + static_cast<double>(pacing_.queue_depth) * state_.dt_sec * 1000.0;
+        pacing_.display_latency_ms = pacing_.display_latency_ms > 0.0 ? pacing_.display_latency_ms * 0.9 + latency * 0.1 : latency;
+    }
+}
+
+// After begin_frame(): the profiler has just resolved this slot's previous frame
+// frame_ms is the loop interval (stalls anywhere show up there, hence the hitch metric); gpu_ms lags a few frames
+void VulkanEngine::sample_engine_metrics(double cpu_ms) {
+    metrics_->set(engine_metrics_.frame_ms, state_.dt_sec * 1000.0);
+    metrics_->set(engine_metrics_.cpu_ms, cpu_ms);
+    if (gpu_profiler_) metrics_->set(engine_metrics_.gpu_ms, gpu_profiler_->frame_ms());
+    const VkPhysicalDeviceMemoryProperties* mem = nullptr; vmaGetMemoryProperties(ctx_.allocator, &mem);
+    std::array<VmaBudget, VK_MAX_MEMORY_HEAPS> budgets{}; vmaGetHeapBudgets(ctx_.allocator, budgets.data());
+    uint64_t usage = 0; for (uint32_t i = 0; i < mem->memoryHeapCount; ++i) usage += budgets[i].usage;
+    metrics_->set(engine_metrics_.vram_mb, static_cast<double>(usage) / (1024.0 * 1024.0));
+    metrics_->end_frame(state_.frame_number);
+}
+
+void VulkanEngine::update_render_scale() {
+    DynamicResolution& r = resolution_;
+    if (r.target_gpu_ms <= 0.0 || !gpu_profiler_ || r.min_scale == r.max_scale) return;
+    const double ms = gpu_profiler_->frame_ms();
+    if (ms <= 0.0) return;
+    if (r.cooldown > 0) { --r.cooldown; return; }
+    r.filtered_ms = r.samples++ > 0 ? r.filtered_ms * 0.75 + ms * 0.25 : ms;
+    if (r.samples < 4) return;
+    // Shrink as soon as the target is exceeded, grow only with clear headroom; aim 10% under the target either way
+    if (r.filtered_ms <= r.target_gpu_ms && r.filtered_ms >= r.target_gpu_ms * 0.8) return;
+    const double step = std::clamp(std::sqrt(r.target_gpu_ms * 0.9 / r.filtered_ms), 0.75, 1.1);
+    const float next  = std::clamp(static_cast<float>(r.scale * step), r.min_scale, r.max_scale);
+    if (std::abs(next - r.scale) < 0.01f) return;
+    r.scale       = next;
+    r.cooldown    = frames_in_flight_;
+    r.samples     = 0;
+    r.filtered_ms = 0.0;
+    r.changes++;
+}
+
 void VulkanEngine::create_renderer() {
     if (!renderer_) throw std::runtime_error("Renderer not set");
     EngineContext eng = make_engine_context();
@@ -1049,16 +1976,40 @@ void VulkanEngine::create_imgui() {
         ImGui::Text("Time:    %.3f s", state_.time_sec);
         ImGui::Text("dt:      %.3f ms", state_.dt_sec * 1000.0);
 #ifdef VV_ENABLE_GPU_TIMESTAMPS
-        ImGui::Text("GPU:     %.3f ms (engine)", last_gpu_ms_);
+        if (gpu_profiler_) {
+            ImGui::Text("GPU:     %.3f ms (engine)", gpu_profiler_->frame_ms());
+            ImGui::SeparatorText("GPU Zones");
+            gpu_profiler_->imgui_panel_contents();
+        }
 #endif
+        ImGui::SeparatorText("CPU Trace");
+        vv::CpuTracer::imgui_panel_contents();
+        if (gpu_profiler_ && !gpu_profiler_->calibrated()) ImGui::TextDisabled("GPU zones not merged (no calibrated timestamps)");
         ImGui::SeparatorText("Swapchain");
         ImGui::Text("Extent:  %u x %u", swapchain_.swapchain_extent.width, swapchain_.swapchain_extent.height);
+        if (resolution_.min_scale != 1.0f || resolution_.max_scale != 1.0f) {
+            const VkExtent2D render = scaled_extent(swapchain_.swapchain_extent, resolution_.scale);
+            ImGui::Text("Render:  %u x %u (%.0f%%)", render.width, render.height, resolution_.scale * 100.0f);
+            if (resolution_.target_gpu_ms > 0.0) ImGui::Text("Target:  %.2f ms GPU, %llu scale changes", resolution_.target_gpu_ms, static_cast<unsigned long long>(resolution_.changes));
+            float scale = resolution_.scale;
+            if (resolution_.target_gpu_ms <= 0.0 && ImGui::SliderFloat("Scale", &scale, resolution_.min_scale, resolution_.max_scale, "%.2f")) set_render_scale(scale);
+        }
         ImGui::Text("Images:  %zu", swapchain_.swapchain_images.size());
         ImGui::Text("Format:  0x%08X", static_cast<uint32_t>(swapchain_.swapchain_image_format));
         ImGui::SeparatorText("Attachments");
         if (swapchain_.color_attachments.empty()) { ImGui::TextUnformatted("Color: (none)"); }
-        else { for (const auto& att : swapchain_.color_attachments) ImGui::Text("%s: 0x%08X", att.name.c_str(), static_cast<uint32_t>(att.image.imageFormat)); }
-        if (swapchain_.depth_attachment) ImGui::Text("Depth %s: 0x%08X", swapchain_.depth_attachment->name.c_str(), static_cast<uint32_t>(swapchain_.depth_attachment->image.imageFormat));
+        else { for (const auto& att : swapchain_.color_attachments) ImGui::Text("%s: 0x%08X x%u", att.name.c_str(), static_cast<uint32_t>(att.image.imageFormat), static_cast<uint32_t>(att.samples)); }
+        if (swapchain_.depth_attachment) ImGui::Text("Depth %s: 0x%08X x%u", swapchain_.depth_attachment->name.c_str(), static_cast<uint32_t>(swapchain_.depth_attachment->image.imageFormat), static_cast<uint32_t>(swapchain_.depth_attachment->samples));
+        if (!aliasing_.blocks.empty()) {
+            for (const auto& att : swapchain_.color_attachments) if (att.alias_block != UINT32_MAX) ImGui::Text("%s: alias block %u", att.name.c_str(), att.alias_block);
+            if (swapchain_.depth_attachment && swapchain_.depth_attachment->alias_block != UINT32_MAX) ImGui::Text("%s: alias block %u", swapchain_.depth_attachment->name.c_str(), swapchain_.depth_attachment->alias_block);
+        }
+        if (aliasing_.dedicated_bytes > 0) {
+            constexpr double mb = 1024.0 * 1024.0;
+            ImGui::Text("Aliasing: %.1f MB saved (%.1f -> %.1f MB)", static_cast<double>(aliasing_.dedicated_bytes - aliasing_.aliased_bytes) / mb, static_cast<double>(aliasing_.dedicated_bytes) / mb, static_cast<double>(aliasing_.aliased_bytes) / mb);
+        }
+        ImGui::SeparatorText("Render Graph");
+        if (render_graph_) render_graph_->imgui_panel_contents();
         ImGui::SeparatorText("Window");
         int lw=0, lh=0, pw=0, ph=0; SDL_GetWindowSize(ctx_.window, &lw, &lh); SDL_GetWindowSizeInPixels(ctx_.window, &pw, &ph);
         ImGui::Text("Logical: %d x %d", lw, lh);
@@ -1078,12 +2029,19 @@ void VulkanEngine::create_imgui() {
         ImGui::Text("PRS qfam: %u", ctx_.present_queue_family);
         ImGui::SeparatorText("Renderer");
         if (renderer_) {
-            const RendererStats st = renderer_->get_stats();
+            RendererStats st = renderer_->get_stats();
+            if (gpu_profiler_ && st.pipeline.vertex_invocations == 0 && st.pipeline.fragment_invocations == 0 && st.pipeline.compute_invocations == 0) st.pipeline = gpu_profiler_->pipeline_totals();
             ImGui::Text("Draws:   %llu", static_cast<unsigned long long>(st.draw_calls));
             ImGui::Text("Disp:    %llu", static_cast<unsigned long long>(st.dispatches));
             ImGui::Text("Tris:    %llu", static_cast<unsigned long long>(st.triangles));
             ImGui::Text("CPU:     %.3f ms", st.cpu_ms);
             ImGui::Text("GPU:     %.3f ms", st.gpu_ms);
+            if (ctx_.pipeline_statistics) {
+                ImGui::Text("VS inv:  %llu", static_cast<unsigned long long>(st.pipeline.vertex_invocations));
+                ImGui::Text("Clip:    %llu -> %llu prims", static_cast<unsigned long long>(st.pipeline.clipping_invocations), static_cast<unsigned long long>(st.pipeline.clipping_primitives));
+                ImGui::Text("FS inv:  %llu", static_cast<unsigned long long>(st.pipeline.fragment_invocations));
+                ImGui::Text("CS inv:  %llu", static_cast<unsigned long long>(st.pipeline.compute_invocations));
+            }
             ImGui::SeparatorText("Caps");
             ImGui::Text("FramesInFlight: %u", renderer_caps_.frames_in_flight);
             ImGui::Text("DynamicRendering: %s", renderer_caps_.dynamic_rendering ? "Yes" : "No");
@@ -1095,43 +2053,96 @@ void VulkanEngine::create_imgui() {
         } else ImGui::TextUnformatted("(no renderer)");
         ImGui::SeparatorText("Sync");
         ImGui::Text("Timeline value: %llu", static_cast<unsigned long long>(timeline_value_));
+        retire_queue_->imgui_panel_contents();
+        if (compute_timeline_) {
+            ImGui::Text("Async compute: value %llu, %llu/%llu submissions overlapped the previous frame (%s)", static_cast<unsigned long long>(compute_value_), static_cast<unsigned long long>(async_stats_.overlapped), static_cast<unsigned long long>(async_stats_.submissions),
+                ctx_.compute_queue_family != ctx_.graphics_queue_family ? "ownership transfers" : "shared family");
+        }
+        if (uploads_) uploads_->imgui_panel_contents();
+        ImGui::SeparatorText("Descriptors");
+        ctx_.descriptor_allocator->imgui_panel_contents();
+        if (bindless_) bindless_->imgui_panel_contents();
+        ImGui::SeparatorText("Pipelines");
+        pipeline_cache_->imgui_panel_contents();
+        shaders_->imgui_panel_contents();
+#ifdef VV_ENABLE_HOTRELOAD
+        if (file_watcher_) file_watcher_->imgui_panel_contents();
+#endif
+        ImGui::SeparatorText("Pacing");
+        ImGui::Text("Mode:    %s", pacing_.wait_for_present ? "present_wait" : "timeline (CPU fallback)");
+        ImGui::Text("Latency: %.2f ms%s", pacing_.display_latency_ms, pacing_.wait_for_present ? "" : " (est.)");
+        ImGui::Text("Queued:  %u", pacing_.queue_depth);
+        ImGui::Text("Limiter: %.2f ms", pacing_.limiter_wait_ms);
+        float target_fps = static_cast<float>(pacing_.target_fps);
+        if (ImGui::SliderFloat("Target FPS (0 = off)", &target_fps, 0.0f, 240.0f, "%.0f")) pacing_.target_fps = target_fps;
+        int max_queued = static_cast<int>(pacing_.max_queued_frames);
+        if (ImGui::SliderInt("Max queued (0 = off)", &max_queued, 0, 4)) pacing_.max_queued_frames = static_cast<uint32_t>(max_queued);
         ImGui::SeparatorText("Memory (VMA)");
-        std::vector<VmaBudget> budgets(memProps.memoryHeapCount); vmaGetHeapBudgets(ctx_.allocator, budgets.data());
+        std::array<VmaBudget, VK_MAX_MEMORY_HEAPS> budgets{}; vmaGetHeapBudgets(ctx_.allocator, budgets.data());
         uint64_t totalBudget=0, totalUsage=0; for (uint32_t i=0;i<memProps.memoryHeapCount;++i){ totalBudget+=budgets[i].budget; totalUsage+=budgets[i].usage; }
         auto fmtMB = [](uint64_t bytes){ return static_cast<double>(bytes)/(1024.0*1024.0); };
         ImGui::Text("Usage:  %.1f MB / %.1f MB", fmtMB(totalUsage), fmtMB(totalBudget));
     });
 
-#ifdef VV_ENABLE_SCREENSHOT
-    // Controls tab (screenshot & tonemap toggle)
+#if defined(VV_ENABLE_SCREENSHOT) || defined(VV_ENABLE_TONEMAP)
+    // Controls tab (screenshot, sRGB swapchain, tonemapping)
     ui_->add_persistent_tab("Controls", [this] {
+#ifdef VV_ENABLE_SCREENSHOT
+        if (ImGui::Button("Screenshot (PrtSc)")) { screenshot_.request = true; screenshot_.path.clear(); }
+#endif
 #ifdef VV_ENABLE_TONEMAP
-        ImGui::Checkbox("Use sRGB Swapchain (Gamma)", &tonemap_enabled_);
+        ImGui::Checkbox("Use sRGB Swapchain (Gamma)", &srgb_swapchain_);
         ImGui::SameLine(); if (ImGui::Button("Apply")) { state_.resize_requested = true; }
+        if (tonemapper_) {
+            ImGui::SeparatorText("Tonemapping");
+            ImGui::Checkbox("Enabled (off: plain blit)", &tonemap_enabled_);
+            if (tonemap_enabled_) tonemapper_->imgui_panel_contents();
+        }
 #endif
-        if (ImGui::Button("Screenshot (PrtSc)")) { screenshot_.request = true; screenshot_.path.clear(); }
     });
 #endif
 
+    ui_->add_persistent_tab("Metrics", [this] { metrics_->imgui_panel_contents(); });
+
 #ifdef VV_ENABLE_LOGGING
-    ui_->add_persistent_tab("Log", [this] {
-        for (const auto& line : log_lines_) ImGui::TextUnformatted(line.c_str());
-    });
-    log_line("Engine initialized");
+    ui_->add_persistent_tab("Log", [] { vv::Log::imgui_panel_contents(); });
 #endif
+    VV_LOG_INFO("Engine initialized");
 }
 
 void VulkanEngine::destroy_imgui() { if (ui_) { ui_->shutdown(ctx_.device); ui_.reset(); imgui_format_ = VK_FORMAT_UNDEFINED; } }
 
 #ifdef VV_ENABLE_GPU_TIMESTAMPS
-void VulkanEngine::create_timestamp_pool() {
-    VkPhysicalDeviceProperties props{}; vkGetPhysicalDeviceProperties(ctx_.physical, &props);
-    ts_period_ns_ = static_cast<double>(props.limits.timestampPeriod);
-    VkQueryPoolCreateInfo qci{.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO, .pNext = nullptr, .flags = 0u, .queryType = VK_QUERY_TYPE_TIMESTAMP, .queryCount = FRAME_OVERLAP * 2, .pipelineStatistics = 0u};
-    VK_CHECK(vkCreateQueryPool(ctx_.device, &qci, nullptr, &ts_query_pool_));
-    mdq_.emplace_back([&] { destroy_timestamp_pool(); });
+void VulkanEngine::create_gpu_profiler() {
+    gpu_profiler_ = std::make_unique<vv::GpuProfiler>();
+    if (!gpu_profiler_->init(ctx_.physical, ctx_.device, ctx_.graphics_queue_family, frames_in_flight_)) { gpu_profiler_.reset(); return; }
+    if (ctx_.calibrated_timestamps) gpu_profiler_->enable_calibration(ctx_.instance, ctx_.physical);
+    if (ctx_.pipeline_statistics) gpu_profiler_->enable_pipeline_statistics();
+    vv::GpuProfiler::set_active(gpu_profiler_.get());
+    mdq_.emplace_back([&] { destroy_gpu_profiler(); });
+}
+void VulkanEngine::destroy_gpu_profiler() { if (gpu_profiler_) { gpu_profiler_->shutdown(); gpu_profiler_.reset(); } }
+#endif
+
+#ifdef VV_ENABLE_TONEMAP
+void VulkanEngine::create_tonemapper() {
+    if (state_.headless || renderer_caps_.presentation_mode != PresentationMode::EngineBlit) return;
+    if (presentation_attachment_index_ < 0 || presentation_attachment_index_ >= static_cast<int>(swapchain_.color_attachments.size())) return;
+    if (!is_float_format(swapchain_.color_attachments[static_cast<size_t>(presentation_attachment_index_)].image.imageFormat)) return; // already display-referred: blit
+    tonemapper_ = std::make_unique<vv::ToneMapper>();
+#if defined(VV_HAVE_BUILTIN_SHADERS)
+    const std::filesystem::path shader_dir{}; // SPIR-V embedded at build time
+#elif defined(VV_SHADER_INCLUDE_DIR)
+    const std::filesystem::path shader_dir = VV_SHADER_INCLUDE_DIR; // glslc missing at build time: compile the sources
+#else
+    const std::filesystem::path shader_dir = "shaders";
+#endif
+    if (!tonemapper_->init(ctx_.device, ctx_.allocator, *shaders_, *pipeline_cache_, shader_dir, swapchain_.swapchain_image_format, frames_in_flight_)) {
+        VV_LOG_WARN("Tonemap pass unavailable; presenting with a blit");
+        destroy_tonemapper();
+    }
 }
-void VulkanEngine::destroy_timestamp_pool() { IF_NOT_NULL_DO_AND_SET(ts_query_pool_, vkDestroyQueryPool(ctx_.device, ts_query_pool_, nullptr), VK_NULL_HANDLE); }
+void VulkanEngine::destroy_tonemapper() { if (tonemapper_) { tonemapper_->shutdown(); tonemapper_.reset(); } }
 #endif
 
 #ifdef VV_ENABLE_SCREENSHOT
@@ -1149,77 +2160,55 @@ static std::string default_screenshot_name() {
 }
 
 void VulkanEngine::queue_swapchain_screenshot(VkCommandBuffer cmd, uint32_t imageIndex) {
-    if (imageIndex >= swapchain_.swapchain_images.size()) return;
+    if (!screenshots_ || imageIndex >= swapchain_.swapchain_images.size()) return;
     const uint32_t w = swapchain_.swapchain_extent.width; const uint32_t h = swapchain_.swapchain_extent.height; VkImage img = swapchain_.swapchain_images[imageIndex];
 
-    VkDeviceSize sz = static_cast<VkDeviceSize>(w) * static_cast<VkDeviceSize>(h) * 4u;
-    VkBuffer buffer = VK_NULL_HANDLE; VmaAllocation alloc{}; VmaAllocationInfo aout{};
-    VkBufferCreateInfo bci{.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO, .pNext = nullptr, .flags = 0u, .size = sz, .usage = VK_BUFFER_USAGE_TRANSFER_DST_BIT, .sharingMode = VK_SHARING_MODE_EXCLUSIVE, .queueFamilyIndexCount = 0u, .pQueueFamilyIndices = nullptr};
-    VmaAllocationCreateInfo ainfo{.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT, .usage = VMA_MEMORY_USAGE_AUTO, .requiredFlags = VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT};
-    VK_CHECK(vmaCreateBuffer(ctx_.allocator, &bci, &ainfo, &buffer, &alloc, &aout));
-
-    VkImageMemoryBarrier2 to_src{.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2, .pNext = nullptr, .srcStageMask = VK_PIPELINE_STAGE_2_TRANSFER_BIT, .srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT, .dstStageMask = VK_PIPELINE_STAGE_2_TRANSFER_BIT, .dstAccessMask = VK_ACCESS_2_TRANSFER_READ_BIT, .oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, .newLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, .image = img, .subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1}};
-    VkDependencyInfo dep_to_src{.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO, .pNext = nullptr, .dependencyFlags = 0u, .memoryBarrierCount = 0u, .pMemoryBarriers = nullptr, .bufferMemoryBarrierCount = 0u, .pBufferMemoryBarriers = nullptr, .imageMemoryBarrierCount = 1u, .pImageMemoryBarriers = &to_src};
-    vkCmdPipelineBarrier2(cmd, &dep_to_src);
+    const VkDeviceSize sz = static_cast<VkDeviceSize>(w) * static_cast<VkDeviceSize>(h) * 4u;
+    ScreenshotSystem::Slot* slot = screenshots_->acquire(ctx_.allocator, sz);
+    if (!slot) return; // all readback slots busy: keep the request pending and retry next frame
 
+    // Runs as the "screenshot" render graph pass, which has the image in TRANSFER_SRC_OPTIMAL
     VkBufferImageCopy region{.bufferOffset = 0, .bufferRowLength = 0, .bufferImageHeight = 0, .imageSubresource = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1}, .imageOffset = {0, 0, 0}, .imageExtent = {w, h, 1}};
-    vkCmdCopyImageToBuffer(cmd, img, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, buffer, 1, &region);
-
-    VkImageMemoryBarrier2 back_dst{.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2, .pNext = nullptr, .srcStageMask = VK_PIPELINE_STAGE_2_TRANSFER_BIT, .srcAccessMask = VK_ACCESS_2_TRANSFER_READ_BIT, .dstStageMask = VK_PIPELINE_STAGE_2_TRANSFER_BIT, .dstAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT, .oldLayout = VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, .newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, .image = img, .subresourceRange = {VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1}};
-    VkDependencyInfo dep_back{.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO, .pNext = nullptr, .dependencyFlags = 0u, .memoryBarrierCount = 0u, .pMemoryBarriers = nullptr, .bufferMemoryBarrierCount = 0u, .pBufferMemoryBarriers = nullptr, .imageMemoryBarrierCount = 1u, .pImageMemoryBarriers = &back_dst};
-    vkCmdPipelineBarrier2(cmd, &dep_back);
-
-    FrameData& fr = frames_[state_.frame_number % FRAME_OVERLAP];
-    const std::string outPath = screenshot_.path.empty() ? default_screenshot_name() : screenshot_.path;
-#ifdef VV_ENABLE_LOGGING
-    log_line(std::string("Queued screenshot: ") + outPath);
-#endif
-    fr.dq.emplace_back([this, buffer, alloc, outPath, w, h] {
-        void* p = nullptr; vmaMapMemory(ctx_.allocator, alloc, &p);
-        const uint8_t* bgra = static_cast<const uint8_t*>(p);
-        std::vector<uint8_t> rgba; rgba.resize(static_cast<size_t>(w) * static_cast<size_t>(h) * 4ull);
-        for (size_t i = 0, n = static_cast<size_t>(w) * static_cast<size_t>(h); i < n; ++i) {
-            rgba[i * 4 + 0] = bgra[i * 4 + 2];
-            rgba[i * 4 + 1] = bgra[i * 4 + 1];
-            rgba[i * 4 + 2] = bgra[i * 4 + 0];
-            rgba[i * 4 + 3] = bgra[i * 4 + 3];
-        }
-        stbi_write_png(outPath.c_str(), static_cast<int>(w), static_cast<int>(h), 4, rgba.data(), static_cast<int>(w * 4));
-        vmaUnmapMemory(ctx_.allocator, alloc);
-        vmaDestroyBuffer(ctx_.allocator, buffer, alloc);
-#ifdef VV_ENABLE_LOGGING
-        log_line(std::string("Saved screenshot: ") + outPath);
-#endif
-    });
+    vkCmdCopyImageToBuffer(cmd, img, VK_IMAGE_LAYOUT_TRANSFER_SRC_OPTIMAL, slot->buffer, 1, &region);
+
+    VkBufferMemoryBarrier2 to_host{.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2, .pNext = nullptr, .srcStageMask = VK_PIPELINE_STAGE_2_TRANSFER_BIT, .srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT, .dstStageMask = VK_PIPELINE_STAGE_2_HOST_BIT, .dstAccessMask = VK_ACCESS_2_HOST_READ_BIT, .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED, .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED, .buffer = slot->buffer, .offset = 0, .size = sz};
+    VkDependencyInfo dep_host{.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO, .pNext = nullptr, .dependencyFlags = 0u, .memoryBarrierCount = 0u, .pMemoryBarriers = nullptr, .bufferMemoryBarrierCount = 1u, .pBufferMemoryBarriers = &to_host, .imageMemoryBarrierCount = 0u, .pImageMemoryBarriers = nullptr};
+    vkCmdPipelineBarrier2(cmd, &dep_host);
+
+    const VkFormat fmt = swapchain_.swapchain_image_format;
+    slot->width          = w;
+    slot->height         = h;
+    slot->swizzle        = fmt == VK_FORMAT_B8G8R8A8_UNORM || fmt == VK_FORMAT_B8G8R8A8_SRGB;
+    slot->path           = screenshot_.path.empty() ? default_screenshot_name() : screenshot_.path;
+    slot->timeline_value = timeline_value_ + 1; // value end_frame() signals for this submission
+    slot->state.store(ScreenshotSystem::SlotState::InFlight, std::memory_order_release);
+    screenshot_.request = false;
+    VV_LOG_INFO("Queued screenshot: %s", slot->path.c_str());
 }
 #endif
 
 #ifdef VV_ENABLE_HOTRELOAD
 void VulkanEngine::add_hot_reload_watch_path(const std::string& path) {
     if (path.empty()) return;
-    std::error_code ec{}; std::filesystem::path p = std::filesystem::absolute(path, ec); if (ec) p = std::filesystem::path(path);
-    uint64_t latest = 0;
-    for (auto it = std::filesystem::recursive_directory_iterator(p, std::filesystem::directory_options::skip_permission_denied, ec);
-         it != std::filesystem::recursive_directory_iterator(); ++it) {
-        if (ec) break; if (!it->is_regular_file()) continue; auto ft = it->last_write_time(ec); if (ec) continue; latest = std::max<uint64_t>(latest, static_cast<uint64_t>(ft.time_since_epoch().count()));
-    }
-    watch_list_.push_back(WatchItem{p.string(), latest});
+    if (!file_watcher_) file_watcher_ = std::make_unique<vv::FileWatcher>();
+    if (!file_watcher_->add(path)) VV_LOG_WARN("Hot reload: cannot watch %s", path.c_str());
 }
 
+// Runs every frame: the watcher thread did the scanning, this only swaps out a settled batch
 void VulkanEngine::poll_file_watches(const EngineContext& eng) {
-    bool changed = false;
-    for (auto& w : watch_list_) {
-        std::error_code ec{}; uint64_t latest = w.stamp;
-        for (auto it = std::filesystem::recursive_directory_iterator(w.path, std::filesystem::directory_options::skip_permission_denied, ec);
-             it != std::filesystem::recursive_directory_iterator(); ++it) {
-            if (ec) break; if (!it->is_regular_file()) continue; auto ft = it->last_write_time(ec); if (ec) continue; latest = std::max<uint64_t>(latest, static_cast<uint64_t>(ft.time_since_epoch().count()));
-        }
-        if (latest > w.stamp) { w.stamp = latest; changed = true; }
+    if (!file_watcher_) return;
+    std::vector<std::filesystem::path> changed = file_watcher_->take_changes();
+    if (changed.empty()) return;
+    vv::cpu_zone z("reload_assets");
+#if defined(VV_ENABLE_TONEMAP) && defined(VV_SHADER_INCLUDE_DIR)
+    // Only when include/shaders is watched: the tonemap pass otherwise keeps its embedded SPIR-V
+    const auto is_tonemap_shader = [](const std::filesystem::path& p) { const std::string n = p.filename().string(); return n.starts_with("vv_tonemap") || n == "vv_fullscreen.vert"; };
+    if (tonemapper_ && std::ranges::any_of(changed, is_tonemap_shader)) {
+        vkDeviceWaitIdle(ctx_.device); // rare (edited engine shader): the old pipelines may still be in flight
+        if (!tonemapper_->reload(*shaders_, *pipeline_cache_, VV_SHADER_INCLUDE_DIR)) VV_LOG_WARN("Tonemap shaders failed to compile; keeping the previous pipelines");
     }
-    if (changed && renderer_) { renderer_->reload_assets(eng); }
+#endif
+    if (renderer_) renderer_->reload_assets(eng, changed);
 }
 #endif
 
-#ifdef VV_ENABLE_LOGGING
-void VulkanEngine::log_line(const std::string& s) { log_lines_.push_back(s); if (log_lines_.size() > 2000) log_lines_.erase(log_lines_.begin(), log_lines_.begin() + (log_lines_.size() - 2000)); }
-#endif
@@ -0,0 +1,134 @@
+#include "vv_bindless.h"
+#include <algorithm>
+#include <imgui.h>
+
+namespace vv {
+
+static constexpr std::array<VkDescriptorType, 3> kTypes{VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER};
+static constexpr std::array<const char*, 3> kNames{"storage images", "sampled images", "storage buffers"};
+
+bool BindlessHeap::init(VkDevice device, VkPhysicalDevice physical, VkSemaphore timeline, const Capacity& capacity, bool storage_image_nonuniform) {
+    device_   = device;
+    timeline_ = timeline;
+    storage_image_nonuniform_ = storage_image_nonuniform;
+
+    // Update-after-bind limits are separate from (and usually far above) the classic per-stage limits
+    VkPhysicalDeviceVulkan12Properties p12{.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_VULKAN_1_2_PROPERTIES};
+    VkPhysicalDeviceProperties2 props{.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2, .pNext = &p12};
+    vkGetPhysicalDeviceProperties2(physical, &props);
+    stats_.capacity = {
+        std::clamp(capacity.storage_images, 1u, std::min(p12.maxDescriptorSetUpdateAfterBindStorageImages, p12.maxPerStageDescriptorUpdateAfterBindStorageImages)),
+        std::clamp(capacity.sampled_images, 1u, std::min(p12.maxDescriptorSetUpdateAfterBindSampledImages, p12.maxPerStageDescriptorUpdateAfterBindSampledImages)),
+        std::clamp(capacity.storage_buffers, 1u, std::min(p12.maxDescriptorSetUpdateAfterBindStorageBuffers, p12.maxPerStageDescriptorUpdateAfterBindStorageBuffers)),
+    };
+    // Every table is visible to all stages, so together they also have to fit the per-stage resource limit
+    const uint64_t total = uint64_t{stats_.capacity[0]} + stats_.capacity[1] + stats_.capacity[2];
+    if (total > p12.maxPerStageUpdateAfterBindResources) {
+        for (uint32_t& c : stats_.capacity) c = std::max(1u, static_cast<uint32_t>(c * uint64_t{p12.maxPerStageUpdateAfterBindResources} / total));
+    }
+
+    std::array<VkDescriptorSetLayoutBinding, 3> bindings{};
+    std::array<VkDescriptorBindingFlags, 3> flags{};
+    std::array<VkDescriptorPoolSize, 3> sizes{};
+    for (uint32_t i = 0; i < 3; ++i) {
+        bindings[i] = VkDescriptorSetLayoutBinding{.binding = i, .descriptorType = kTypes[i], .descriptorCount = stats_.capacity[i], .stageFlags = VK_SHADER_STAGE_ALL, .pImmutableSamplers = nullptr};
+        flags[i]    = VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT | VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT;
+        sizes[i]    = VkDescriptorPoolSize{.type = kTypes[i], .descriptorCount = stats_.capacity[i]};
+    }
+    const VkDescriptorSetLayoutBindingFlagsCreateInfo fci{.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO, .pNext = nullptr, .bindingCount = 3u, .pBindingFlags = flags.data()};
+    const VkDescriptorSetLayoutCreateInfo lci{.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO, .pNext = &fci, .flags = VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT, .bindingCount = 3u, .pBindings = bindings.data()};
+    if (vkCreateDescriptorSetLayout(device_, &lci, nullptr, &set_layout_) != VK_SUCCESS) return false;
+
+    const VkPushConstantRange pcr{.stageFlags = VK_SHADER_STAGE_ALL, .offset = 0u, .size = push_constant_bytes};
+    const VkPipelineLayoutCreateInfo pli{.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO, .pNext = nullptr, .flags = 0u, .setLayoutCount = 1u, .pSetLayouts = &set_layout_, .pushConstantRangeCount = 1u, .pPushConstantRanges = &pcr};
+    if (vkCreatePipelineLayout(device_, &pli, nullptr, &pipeline_layout_) != VK_SUCCESS) return false;
+
+    const VkDescriptorPoolCreateInfo pci{.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO, .pNext = nullptr, .flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT, .maxSets = 1u, .poolSizeCount = 3u, .pPoolSizes = sizes.data()};
+    if (vkCreateDescriptorPool(device_, &pci, nullptr, &pool_) != VK_SUCCESS) return false;
+    const VkDescriptorSetAllocateInfo ai{.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO, .pNext = nullptr, .descriptorPool = pool_, .descriptorSetCount = 1u, .pSetLayouts = &set_layout_};
+    return vkAllocateDescriptorSets(device_, &ai, &set_) == VK_SUCCESS;
+}
+
+void BindlessHeap::shutdown() {
+    if (pool_) vkDestroyDescriptorPool(device_, pool_, nullptr); // frees set_
+    if (pipeline_layout_) vkDestroyPipelineLayout(device_, pipeline_layout_, nullptr);
+    if (set_layout_) vkDestroyDescriptorSetLayout(device_, set_layout_, nullptr);
+    pool_ = VK_NULL_HANDLE; pipeline_layout_ = VK_NULL_HANDLE; set_layout_ = VK_NULL_HANDLE; set_ = VK_NULL_HANDLE;
+    slots_ = {}; releases_.clear(); stats_ = Stats{};
+    device_ = VK_NULL_HANDLE; timeline_ = VK_NULL_HANDLE; storage_image_nonuniform_ = false;
+}
+
+uint32_t BindlessHeap::acquire(Table table) {
+    const auto t = static_cast<uint32_t>(table);
+    Slots& s     = slots_[t];
+    uint32_t index;
+    if (!s.free.empty()) { index = s.free.back(); s.free.pop_back(); }
+    else if (s.next < stats_.capacity[t]) index = s.next++;
+    else return invalid;
+    stats_.used[t]++;
+    return index;
+}
+
+void BindlessHeap::write(Table table, uint32_t index, const VkDescriptorImageInfo* image, const VkDescriptorBufferInfo* buffer) {
+    const auto t = static_cast<uint32_t>(table);
+    const VkWriteDescriptorSet w{.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, .pNext = nullptr, .dstSet = set_, .dstBinding = t, .dstArrayElement = index, .descriptorCount = 1u, .descriptorType = kTypes[t], .pImageInfo = image, .pBufferInfo = buffer, .pTexelBufferView = nullptr};
+    vkUpdateDescriptorSets(device_, 1u, &w, 0u, nullptr);
+    stats_.writes++;
+}
+
+uint32_t BindlessHeap::add_storage_image(VkImageView view, VkImageLayout layout) {
+    const uint32_t index = acquire(Table::StorageImage);
+    if (index == invalid) return invalid;
+    const VkDescriptorImageInfo ii{.sampler = VK_NULL_HANDLE, .imageView = view, .imageLayout = layout};
+    write(Table::StorageImage, index, &ii, nullptr);
+    return index;
+}
+
+uint32_t BindlessHeap::add_sampled_image(VkImageView view, VkSampler sampler, VkImageLayout layout) {
+    const uint32_t index = acquire(Table::SampledImage);
+    if (index == invalid) return invalid;
+    const VkDescriptorImageInfo ii{.sampler = sampler, .imageView = view, .imageLayout = layout};
+    write(Table::SampledImage, index, &ii, nullptr);
+    return index;
+}
+
+uint32_t BindlessHeap::add_storage_buffer(VkBuffer buffer, VkDeviceSize offset, VkDeviceSize range) {
+    const uint32_t index = acquire(Table::StorageBuffer);
+    if (index == invalid) return invalid;
+    const VkDescriptorBufferInfo bi{.buffer = buffer, .offset = offset, .range = range};
+    write(Table::StorageBuffer, index, nullptr, &bi);
+    return index;
+}
+
+// The stale descriptor stays in place until the index is handed out again; partially bound arrays allow that
+void BindlessHeap::release(Table table, uint32_t index, uint64_t value) {
+    if (index == invalid) return;
+    releases_.push_back(Release{value, table, index});
+    stats_.pending_release++;
+}
+
+void BindlessHeap::collect() {
+    if (releases_.empty() || !timeline_) return;
+    uint64_t completed = 0;
+    if (vkGetSemaphoreCounterValue(device_, timeline_, &completed) != VK_SUCCESS) return;
+    std::erase_if(releases_, [&](const Release& r) {
+        if (r.value > completed) return false;
+        const auto t = static_cast<uint32_t>(r.table);
+        slots_[t].free.push_back(r.index);
+        stats_.used[t]--;
+        stats_.pending_release--;
+        return true;
+    });
+}
+
+void BindlessHeap::bind(VkCommandBuffer cmd, VkPipelineBindPoint bind_point, VkPipelineLayout layout) const {
+    vkCmdBindDescriptorSets(cmd, bind_point, layout ? layout : pipeline_layout_, 0u, 1u, &set_, 0u, nullptr);
+}
+
+void BindlessHeap::imgui_panel_contents() const {
+    for (uint32_t t = 0; t < 3; ++t) ImGui::Text("Bindless %s: %u / %u", kNames[t], stats_.used[t], stats_.capacity[t]);
+    ImGui::Text("Bindless writes: %llu, %u releases pending", static_cast<unsigned long long>(stats_.writes), stats_.pending_release);
+    ImGui::Text("Storage image indexing: %s", storage_image_nonuniform_ ? "non-uniform" : "dynamically uniform only");
+}
+
+} // namespace vv
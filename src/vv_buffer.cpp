@@ -0,0 +1,30 @@
+#include "vv_buffer.h"
+#include "vv_retire.h"
+#include <stdexcept>
+#include <vk_mem_alloc.h>
+
+namespace vv {
+
+DeviceBuffer create_device_buffer(VkDevice device, VmaAllocator allocator, VkDeviceSize size, VkBufferUsageFlags usage, BufferAccess access) {
+    const VkBufferCreateInfo bci{.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO, .pNext = nullptr, .flags = 0u, .size = size, .usage = usage | VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, .sharingMode = VK_SHARING_MODE_EXCLUSIVE, .queueFamilyIndexCount = 0u, .pQueueFamilyIndices = nullptr};
+    VmaAllocationCreateInfo aci{}; aci.usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE;
+    if (access == BufferAccess::HostWrite) aci.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT;
+    DeviceBuffer b{.size = size};
+    VmaAllocationInfo info{};
+    if (vmaCreateBuffer(allocator, &bci, &aci, &b.buffer, &b.allocation, &info) != VK_SUCCESS) throw std::runtime_error("create_device_buffer: allocation failed");
+    b.address = buffer_address(device, b.buffer);
+    b.mapped  = info.pMappedData;
+    return b;
+}
+
+VkDeviceAddress buffer_address(VkDevice device, VkBuffer buffer) {
+    const VkBufferDeviceAddressInfo ai{.sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO, .pNext = nullptr, .buffer = buffer};
+    return vkGetBufferDeviceAddress(device, &ai);
+}
+
+void retire_device_buffer(RetireQueue& queue, DeviceBuffer& buffer, uint64_t value) {
+    queue.retire(buffer.buffer, buffer.allocation, value); // VMA drops the persistent mapping with the allocation
+    buffer = DeviceBuffer{};
+}
+
+} // namespace vv
@@ -0,0 +1,224 @@
+#include "vv_file_watch.h"
+#include "vv_profiler.h"
+#include <algorithm>
+#include <imgui.h>
+#include <utility>
+
+#ifdef __linux__
+#include <cerrno>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace vv {
+
+#ifdef __linux__
+namespace {
+    // Whole-file events only: IN_MODIFY would fire for every write() of a save in progress
+    constexpr uint32_t kDirMask = IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_CREATE | IN_DELETE | IN_DELETE_SELF | IN_ONLYDIR;
+
+    // `path` is `dir` or lies below it, compared by whole components: /a/sh contains /a/sh/x but not /a/sh2/x
+    bool within(const std::filesystem::path& path, const std::filesystem::path& dir) {
+        const auto& p = path.native();
+        const auto& d = dir.native();
+        if (!p.starts_with(d)) return false;
+        return p.size() == d.size() || p[d.size()] == '/' || (!d.empty() && d.back() == '/');
+    }
+} // namespace
+
+bool FileWatcher::start(std::chrono::milliseconds debounce) {
+    if (thread_.joinable()) return true;
+    debounce_ = debounce;
+    std::vector<Root> roots;
+    {
+        // add() may run on another thread; it reads the fd through watch_tree() under the same lock
+        std::scoped_lock lock(mutex_);
+        inotify_fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        wake_fd_    = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        stop_       = false;
+        roots       = roots_;
+    }
+    if (inotify_fd_ < 0 || wake_fd_ < 0) { shutdown(); return false; }
+    for (const auto& r : roots) watch_tree(r.path);
+    thread_ = std::thread([this] { thread_main(); });
+    return true;
+}
+
+void FileWatcher::shutdown() {
+    { std::scoped_lock lock(mutex_); stop_ = true; }
+    if (wake_fd_ >= 0) { const uint64_t one = 1; (void)!write(wake_fd_, &one, sizeof(one)); }
+    if (thread_.joinable()) thread_.join();
+    std::scoped_lock lock(mutex_);
+    if (inotify_fd_ >= 0) close(inotify_fd_); // drops every watch
+    if (wake_fd_ >= 0) close(wake_fd_);
+    inotify_fd_ = wake_fd_ = -1;
+    dirs_.clear();
+}
+
+bool FileWatcher::add(const std::filesystem::path& path) {
+    std::error_code ec;
+    std::filesystem::path p = std::filesystem::absolute(path, ec);
+    if (ec || !std::filesystem::exists(p, ec)) return false;
+    const bool directory = std::filesystem::is_directory(p, ec);
+    { std::scoped_lock lock(mutex_); roots_.push_back(Root{p, directory}); }
+    watch_tree(p); // no-op until start()
+    return true;
+}
+
+// A file is watched through its directory, so editors that save by replacing the file do not drop the watch
+void FileWatcher::watch_tree(const std::filesystem::path& root) {
+    std::error_code ec;
+    std::vector<std::filesystem::path> dirs{std::filesystem::is_directory(root, ec) ? root : root.parent_path()};
+    if (std::filesystem::is_directory(root, ec)) {
+        for (auto it = std::filesystem::recursive_directory_iterator(root, std::filesystem::directory_options::skip_permission_denied, ec); !ec && it != std::filesystem::recursive_directory_iterator(); it.increment(ec)) {
+            if (it->is_directory(ec)) dirs.push_back(it->path());
+        }
+    }
+    std::scoped_lock lock(mutex_);
+    if (inotify_fd_ < 0) return; // not started, or shut down meanwhile
+    for (const auto& d : dirs) {
+        const int wd = inotify_add_watch(inotify_fd_, d.c_str(), kDirMask);
+        if (wd >= 0 && dirs_.emplace(wd, d).second) stats_.watches++;
+    }
+}
+
+void FileWatcher::thread_main() {
+    CpuTracer::set_thread_name("file watcher");
+    std::set<std::filesystem::path> pending;
+    auto last_event = std::chrono::steady_clock::now();
+    alignas(inotify_event) char buf[16 * 1024];
+
+    for (;;) {
+        int timeout = -1;
+        if (!pending.empty()) {
+            const auto quiet = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - last_event);
+            if (quiet >= debounce_) { publish(pending); continue; }
+            timeout = static_cast<int>((debounce_ - quiet).count()) + 1;
+        }
+        pollfd fds[2] = {{inotify_fd_, POLLIN, 0}, {wake_fd_, POLLIN, 0}};
+        if (poll(fds, 2, timeout) < 0 && errno != EINTR) break;
+        { std::scoped_lock lock(mutex_); if (stop_) break; }
+        if (!(fds[0].revents & POLLIN)) continue;
+
+        cpu_zone z("file_watch_events");
+        std::vector<std::filesystem::path> new_dirs;
+        ssize_t n;
+        while ((n = read(inotify_fd_, buf, sizeof(buf))) > 0) {
+            std::scoped_lock lock(mutex_);
+            for (char* p = buf; p < buf + n;) {
+                const auto* ev = reinterpret_cast<const inotify_event*>(p);
+                p += sizeof(inotify_event) + ev->len;
+                stats_.events++;
+                if (ev->mask & IN_Q_OVERFLOW) { stats_.overflows++; for (const auto& r : roots_) pending.insert(r.path); continue; } // lost track: report every root
+                auto it = dirs_.find(ev->wd);
+                if (it == dirs_.end()) continue;
+                if (ev->mask & IN_IGNORED) { dirs_.erase(it); stats_.watches--; continue; }
+                const std::filesystem::path path = ev->len ? it->second / ev->name : it->second;
+                if ((ev->mask & IN_ISDIR) && (ev->mask & (IN_CREATE | IN_MOVED_TO))) new_dirs.push_back(path);
+                // Roots that name files only report their own events
+                const bool wanted = std::ranges::any_of(roots_, [&](const Root& r) { return r.directory ? within(path, r.path) : r.path == path; });
+                if (wanted) pending.insert(path);
+            }
+        }
+        for (const auto& d : new_dirs) watch_tree(d); // files created inside before the watch landed still show up as the directory itself
+        last_event = std::chrono::steady_clock::now();
+    }
+}
+#else
+bool FileWatcher::start(std::chrono::milliseconds debounce) {
+    if (thread_.joinable()) return true;
+    debounce_ = debounce;
+    stop_     = false;
+    thread_   = std::thread([this] { thread_main(); });
+    return true;
+}
+
+void FileWatcher::shutdown() {
+    { std::scoped_lock lock(mutex_); stop_ = true; }
+    cv_.notify_all();
+    if (thread_.joinable()) thread_.join();
+}
+
+bool FileWatcher::add(const std::filesystem::path& path) {
+    std::error_code ec;
+    std::filesystem::path p = std::filesystem::absolute(path, ec);
+    if (ec || !std::filesystem::exists(p, ec)) return false;
+    const bool directory = std::filesystem::is_directory(p, ec);
+    std::scoped_lock lock(mutex_);
+    roots_.push_back(Root{p, directory});
+    stats_.watches++;
+    return true;
+}
+
+void FileWatcher::scan(std::unordered_map<std::string, std::filesystem::file_time_type>& into) const {
+    std::vector<Root> roots;
+    { std::scoped_lock lock(mutex_); roots = roots_; }
+    for (const auto& [r, directory] : roots) {
+        std::error_code ec;
+        if (!directory) { auto t = std::filesystem::last_write_time(r, ec); if (!ec) into[r.string()] = t; continue; }
+        for (auto it = std::filesystem::recursive_directory_iterator(r, std::filesystem::directory_options::skip_permission_denied, ec); !ec && it != std::filesystem::recursive_directory_iterator(); it.increment(ec)) {
+            if (!it->is_regular_file(ec)) continue;
+            auto t = it->last_write_time(ec);
+            if (!ec) into[it->path().string()] = t;
+        }
+    }
+}
+
+// No native backend wired up here: rescan every half second on this thread, never on the render thread
+void FileWatcher::thread_main() {
+    CpuTracer::set_thread_name("file watcher");
+    std::unordered_map<std::string, std::filesystem::file_time_type> known, now;
+    scan(known);
+    std::set<std::filesystem::path> pending;
+    for (;;) {
+        {
+            std::unique_lock lock(mutex_);
+            cv_.wait_for(lock, pending.empty() ? std::chrono::milliseconds(500) : debounce_, [&] { return stop_; });
+            if (stop_) break;
+        }
+        cpu_zone z("file_watch_scan");
+        now.clear();
+        scan(now);
+        size_t diffs = 0;
+        for (const auto& [p, t] : now) { auto it = known.find(p); if (it == known.end() || it->second != t) { pending.insert(p); diffs++; } }
+        for (const auto& [p, t] : known) if (!now.contains(p)) { pending.insert(p); diffs++; }
+        known.swap(now);
+        { std::scoped_lock lock(mutex_); stats_.events += diffs; }
+        if (diffs == 0 && !pending.empty()) publish(pending); // quiet for one debounce interval
+    }
+}
+#endif
+
+void FileWatcher::publish(std::set<std::filesystem::path>& pending) {
+    std::scoped_lock lock(mutex_);
+    ready_.insert(ready_.end(), pending.begin(), pending.end());
+    pending.clear();
+    stats_.batches++;
+}
+
+std::vector<std::filesystem::path> FileWatcher::take_changes() {
+    std::scoped_lock lock(mutex_);
+    if (ready_.empty()) return {};
+    std::ranges::sort(ready_);
+    ready_.erase(std::unique(ready_.begin(), ready_.end()), ready_.end());
+    last_batch_ = ready_;
+    return std::exchange(ready_, {});
+}
+
+void FileWatcher::imgui_panel_contents() const {
+    std::scoped_lock lock(mutex_);
+#ifdef __linux__
+    ImGui::Text("File watch: inotify, %u directories, debounce %lld ms", stats_.watches, static_cast<long long>(debounce_.count()));
+#else
+    ImGui::Text("File watch: polling %u roots, debounce %lld ms", stats_.watches, static_cast<long long>(debounce_.count()));
+#endif
+    ImGui::Text("Events: %llu, batches: %llu%s", static_cast<unsigned long long>(stats_.events), static_cast<unsigned long long>(stats_.batches), stats_.overflows ? " (queue overflowed)" : "");
+    if (!last_batch_.empty() && ImGui::TreeNode("Last batch", "Last batch (%zu)", last_batch_.size())) {
+        for (const auto& p : last_batch_) ImGui::TextUnformatted(p.string().c_str());
+        ImGui::TreePop();
+    }
+}
+
+} // namespace vv
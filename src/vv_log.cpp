@@ -0,0 +1,212 @@
+#include "vv_log.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstring>
+#include <imgui.h>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace vv {
+
+namespace {
+    // Bounded MPMC ring after Vyukov, used with a single consumer: a slot is free for ticket t when seq == t and
+    // readable when seq == t + 1; the consumer hands it back for the next lap with seq = t + ring_records.
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> seq{0};
+        Log::Record record{};
+    };
+
+    struct LogState {
+        std::unique_ptr<std::array<Slot, Log::ring_records>> ring;
+        alignas(64) std::atomic<uint64_t> head{0}; // next ticket producers claim
+        alignas(64) uint64_t tail{0};              // next ticket the sink reads (sink thread only)
+        std::atomic<uint64_t> dropped{0};
+        std::atomic<uint32_t> threads{0};
+        std::chrono::steady_clock::time_point epoch{std::chrono::steady_clock::now()};
+
+        std::mutex sink_mutex; // start/stop and the sink's wake-up
+        std::condition_variable wake;
+        std::thread sink;
+        bool stopping{false};
+        std::FILE* file{nullptr};
+
+        std::mutex history_mutex; // sink appends, the panel reads
+        std::vector<Log::Record> history;
+        uint64_t history_written{0};
+        uint64_t history_cleared{0}; // records before this are hidden by "Clear"
+
+        LogState() : ring(std::make_unique<std::array<Slot, Log::ring_records>>()) {
+            for (uint32_t i = 0; i < Log::ring_records; ++i) (*ring)[i].seq.store(i, std::memory_order_relaxed);
+            history.resize(Log::history_records);
+        }
+    };
+    LogState& log_state() { static LogState s; return s; }
+
+    thread_local uint32_t t_thread = 0;
+
+    const char* level_name(LogLevel l) {
+        switch (l) { case LogLevel::Debug: return "DEBUG"; case LogLevel::Info: return "INFO"; case LogLevel::Warn: return "WARN"; case LogLevel::Error: return "ERROR"; }
+        return "?";
+    }
+
+    // Moves everything readable out of the ring; returns the number of records taken
+    size_t drain(LogState& st, std::vector<Log::Record>& batch) {
+        batch.clear();
+        for (;;) {
+            Slot& slot = (*st.ring)[st.tail & (Log::ring_records - 1u)];
+            if (slot.seq.load(std::memory_order_acquire) != st.tail + 1u) break;
+            batch.push_back(slot.record);
+            slot.seq.store(st.tail + Log::ring_records, std::memory_order_release);
+            ++st.tail;
+        }
+        return batch.size();
+    }
+
+    void emit(LogState& st, const std::vector<Log::Record>& batch) {
+        if (batch.empty()) return;
+        for (const auto& r : batch) {
+            std::fprintf(stderr, "[%s] %.*s\n", level_name(r.level), static_cast<int>(r.length), r.text);
+            if (st.file) std::fprintf(st.file, "%10.3f [%s] (t%u) %.*s\n", static_cast<double>(r.time_ns) * 1e-9, level_name(r.level), r.thread, static_cast<int>(r.length), r.text);
+        }
+        if (st.file) std::fflush(st.file);
+        std::scoped_lock lk(st.history_mutex);
+        for (const auto& r : batch) st.history[st.history_written++ % Log::history_records] = r;
+    }
+
+    void sink_loop(LogState& st) {
+        std::vector<Log::Record> batch; batch.reserve(Log::ring_records);
+        std::unique_lock lk(st.sink_mutex);
+        while (!st.stopping) {
+            // Producers never signal (that would cost them a syscall); a few milliseconds of latency is fine for a log
+            st.wake.wait_for(lk, std::chrono::milliseconds(5));
+            lk.unlock();
+            while (drain(st, batch) > 0) emit(st, batch);
+            lk.lock();
+        }
+        lk.unlock();
+        while (drain(st, batch) > 0) emit(st, batch);
+    }
+} // namespace
+
+void Log::write(LogLevel level, const char* fmt, ...) {
+    va_list args;
+    va_start(args, fmt);
+    writev(level, fmt, args);
+    va_end(args);
+}
+
+void Log::writev(LogLevel level, const char* fmt, va_list args) {
+    if (!enabled(level)) return;
+    LogState& st = log_state();
+    uint64_t ticket = st.head.load(std::memory_order_relaxed);
+    Slot* slot = nullptr;
+    for (;;) {
+        slot = &(*st.ring)[ticket & (ring_records - 1u)];
+        const uint64_t seq = slot->seq.load(std::memory_order_acquire);
+        if (seq == ticket) {
+            if (st.head.compare_exchange_weak(ticket, ticket + 1u, std::memory_order_relaxed)) break;
+        } else if (seq < ticket) {
+            st.dropped.fetch_add(1u, std::memory_order_relaxed); // full: the sink is a lap behind
+            return;
+        } else {
+            ticket = st.head.load(std::memory_order_relaxed);
+        }
+    }
+    if (t_thread == 0) t_thread = st.threads.fetch_add(1u, std::memory_order_relaxed) + 1u;
+
+    Record& r = slot->record;
+    r.time_ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - st.epoch).count());
+    r.thread  = t_thread;
+    r.level   = level;
+    const int n = std::vsnprintf(r.text, record_chars, fmt, args);
+    r.length  = static_cast<uint16_t>(std::clamp(n, 0, static_cast<int>(record_chars) - 1));
+    slot->seq.store(ticket + 1u, std::memory_order_release);
+}
+
+void Log::start(std::string_view file_path) {
+    LogState& st = log_state();
+    std::scoped_lock lk(st.sink_mutex);
+    if (st.sink.joinable()) return;
+    if (!file_path.empty()) {
+        st.file = std::fopen(std::string(file_path).c_str(), "w");
+        if (!st.file) std::fprintf(stderr, "[WARN] Cannot open log file %.*s\n", static_cast<int>(file_path.size()), file_path.data());
+    }
+    st.stopping = false;
+    st.sink     = std::thread([&st] { sink_loop(st); });
+}
+
+void Log::stop() {
+    LogState& st = log_state();
+    {
+        std::scoped_lock lk(st.sink_mutex);
+        if (!st.sink.joinable()) return;
+        st.stopping = true;
+    }
+    st.wake.notify_one();
+    st.sink.join();
+    std::scoped_lock lk(st.sink_mutex);
+    if (st.file) { std::fclose(st.file); st.file = nullptr; }
+}
+
+uint64_t Log::dropped() { return log_state().dropped.load(std::memory_order_relaxed); }
+
+void Log::imgui_panel_contents() {
+    static ImGuiTextFilter filter;
+    static int min_level = 0;
+    static bool auto_scroll = true;
+    // Indices (history tickets) passing the filters, rebuilt only when the history or a filter changes
+    static std::vector<uint64_t> visible;
+    static uint64_t visible_written = UINT64_MAX, visible_cleared = UINT64_MAX;
+    static int visible_level = -1;
+    static std::string visible_filter;
+
+    LogState& st = log_state();
+    int global = static_cast<int>(min_level_.load(std::memory_order_relaxed));
+    ImGui::SetNextItemWidth(90.0f);
+    if (ImGui::Combo("Record", &global, "Debug\0Info\0Warn\0Error\0")) set_min_level(static_cast<LogLevel>(global));
+    ImGui::SameLine(); ImGui::SetNextItemWidth(90.0f);
+    ImGui::Combo("Show", &min_level, "Debug\0Info\0Warn\0Error\0");
+    ImGui::SameLine(); filter.Draw("Filter", 160.0f);
+    ImGui::SameLine(); ImGui::Checkbox("Auto-scroll", &auto_scroll);
+    ImGui::SameLine();
+    const bool clear = ImGui::Button("Clear");
+    if (const uint64_t d = dropped(); d > 0) { ImGui::SameLine(); ImGui::TextColored(ImVec4(1.0f, 0.6f, 0.2f, 1.0f), "%llu dropped", static_cast<unsigned long long>(d)); }
+
+    std::scoped_lock lk(st.history_mutex);
+    if (clear) st.history_cleared = st.history_written;
+    const uint64_t first = std::max(st.history_cleared, st.history_written > history_records ? st.history_written - history_records : 0u);
+    const bool filtered  = min_level > 0 || filter.IsActive();
+    if (filtered && (visible_written != st.history_written || visible_cleared != st.history_cleared || visible_level != min_level || visible_filter != filter.InputBuf)) {
+        visible.clear();
+        for (uint64_t i = first; i < st.history_written; ++i) {
+            const Record& r = st.history[i % history_records];
+            if (static_cast<int>(r.level) >= min_level && filter.PassFilter(r.text, r.text + r.length)) visible.push_back(i);
+        }
+        visible_written = st.history_written; visible_cleared = st.history_cleared; visible_level = min_level; visible_filter = filter.InputBuf;
+    }
+    const int count = static_cast<int>(filtered ? visible.size() : st.history_written - first);
+
+    ImGui::BeginChild("log_lines", ImVec2(0.0f, 0.0f), ImGuiChildFlags_None, ImGuiWindowFlags_HorizontalScrollbar);
+    static constexpr ImVec4 colors[] = {{0.6f, 0.6f, 0.6f, 1.0f}, {0.9f, 0.9f, 0.9f, 1.0f}, {1.0f, 0.8f, 0.3f, 1.0f}, {1.0f, 0.4f, 0.4f, 1.0f}};
+    ImGuiListClipper clipper;
+    clipper.Begin(count);
+    while (clipper.Step()) {
+        for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row) {
+            const uint64_t i = filtered ? visible[static_cast<size_t>(row)] : first + static_cast<uint64_t>(row);
+            const Record& r = st.history[i % history_records];
+            ImGui::TextColored(colors[static_cast<int>(r.level)], "%9.3f %-5s", static_cast<double>(r.time_ns) * 1e-9, level_name(r.level));
+            ImGui::SameLine(); ImGui::TextUnformatted(r.text, r.text + r.length);
+        }
+    }
+    clipper.End();
+    if (auto_scroll && ImGui::GetScrollY() >= ImGui::GetScrollMaxY()) ImGui::SetScrollHereY(1.0f);
+    ImGui::EndChild();
+}
+
+} // namespace vv
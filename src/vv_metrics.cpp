@@ -0,0 +1,246 @@
+#include "vv_metrics.h"
+#include "vv_log.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <imgui.h>
+#include <iomanip>
+#include <sstream>
+
+namespace vv {
+
+namespace {
+    std::string default_metrics_name() {
+        std::time_t t = std::time(nullptr);
+        std::tm tm{};
+#ifdef _WIN32
+        localtime_s(&tm, &t);
+#else
+        localtime_r(&t, &tm);
+#endif
+        std::ostringstream oss; oss << "metrics_" << std::put_time(&tm, "%Y%m%d_%H%M%S") << ".csv";
+        return oss.str();
+    }
+
+    // Nearest-rank percentile of sorted values
+    float percentile(const std::vector<float>& sorted, float p) {
+        if (sorted.empty()) return 0.0f;
+        const size_t rank = static_cast<size_t>(std::ceil(p * static_cast<float>(sorted.size())));
+        return sorted[std::clamp<size_t>(rank, 1u, sorted.size()) - 1u];
+    }
+} // namespace
+
+MetricsRegistry::MetricsRegistry() : metrics_(std::make_unique<std::array<Metric, max_metrics>>()) { scratch_.reserve(history); }
+
+MetricsRegistry::MetricId MetricsRegistry::add_metric(std::string_view name, std::string_view unit, Kind kind, bool hud) {
+    std::scoped_lock lk(mutex_);
+    const auto metrics = registered();
+    for (size_t i = 0; i < metrics.size(); ++i) if (metrics[i].name == name) return metrics[i].kind == kind ? static_cast<MetricId>(i) : invalid;
+    if (metrics.size() == max_metrics) { VV_LOG_WARN("Metrics: registry full, %.*s not added", static_cast<int>(name.size()), name.data()); return invalid; }
+    // Samples before registration read as 0 so every series shares the frame axis
+    Metric& m = (*metrics_)[metrics.size()];
+    m.name = std::string(name);
+    m.unit = std::string(unit);
+    m.kind = kind;
+    m.hud  = hud;
+    count_metrics_.store(static_cast<uint32_t>(metrics.size()) + 1u, std::memory_order_release);
+    return static_cast<MetricId>(metrics.size());
+}
+
+MetricsRegistry::MetricId MetricsRegistry::gauge(std::string_view name, std::string_view unit, bool hud) { return add_metric(name, unit, Kind::Gauge, hud); }
+MetricsRegistry::MetricId MetricsRegistry::counter(std::string_view name, std::string_view unit, bool hud) { return add_metric(name, unit, Kind::Counter, hud); }
+
+MetricsRegistry::MetricId MetricsRegistry::find(std::string_view name) const {
+    std::scoped_lock lk(mutex_);
+    const auto metrics = registered();
+    for (size_t i = 0; i < metrics.size(); ++i) if (metrics[i].name == name) return static_cast<MetricId>(i);
+    return invalid;
+}
+
+// No lock: the array never moves and an id is only handed out once its metric is published
+void MetricsRegistry::set(MetricId id, double value) { if (id < max_metrics) (*metrics_)[id].current.store(value, std::memory_order_relaxed); }
+void MetricsRegistry::add(MetricId id, double delta) { if (id < max_metrics) (*metrics_)[id].current.fetch_add(delta, std::memory_order_relaxed); }
+
+void MetricsRegistry::end_frame(uint64_t frame_index) {
+    std::scoped_lock lk(mutex_);
+    const uint32_t slot = head_;
+    const auto metrics  = registered();
+    for (auto& m : metrics) {
+        const double v = m.kind == Kind::Counter ? m.current.exchange(0.0, std::memory_order_relaxed) : m.current.load(std::memory_order_relaxed);
+        m.samples[slot] = static_cast<float>(v);
+    }
+    frames_[slot] = frame_index;
+    hitch_[slot]  = 0u;
+    head_  = (head_ + 1u) % history;
+    count_ = std::min(count_ + 1u, history);
+
+    if (hitch_metric_ >= metrics.size() || hitch_factor_ <= 1.0f || count_ < hitch_warmup_) return;
+    const Metric& m = metrics[hitch_metric_];
+    scratch_.clear();
+    for (uint32_t i = 0, s = oldest(); i < count_; ++i, s = (s + 1u) % history) scratch_.push_back(m.samples[s]);
+    const auto mid = scratch_.begin() + static_cast<std::ptrdiff_t>(scratch_.size() / 2u);
+    std::nth_element(scratch_.begin(), mid, scratch_.end());
+    const float median = *mid;
+    const float value  = m.samples[slot];
+    if (median <= 0.0f || value <= hitch_factor_ * median) return;
+    hitch_[slot] = 1u;
+    hitches_[hitch_total_ % hitch_events] = Hitch{.frame = frame_index, .value = value, .median = median};
+    ++hitch_total_;
+    VV_LOG_WARN("Hitch: frame %llu %s = %.2f %s (%.1fx median)", static_cast<unsigned long long>(frame_index), m.name.c_str(), value, m.unit.c_str(), value / median);
+}
+
+MetricsRegistry::Summary MetricsRegistry::summarize(const Metric& m) const {
+    Summary s{};
+    if (count_ == 0) return s;
+    scratch_.clear();
+    double sum = 0.0;
+    for (uint32_t i = 0, slot = oldest(); i < count_; ++i, slot = (slot + 1u) % history) { scratch_.push_back(m.samples[slot]); sum += m.samples[slot]; }
+    s.last  = m.samples[(head_ + history - 1u) % history];
+    s.count = count_;
+    s.mean  = static_cast<float>(sum / count_);
+    std::ranges::sort(scratch_);
+    s.min = scratch_.front();
+    s.max = scratch_.back();
+    s.p50 = percentile(scratch_, 0.50f);
+    s.p95 = percentile(scratch_, 0.95f);
+    s.p99 = percentile(scratch_, 0.99f);
+    return s;
+}
+
+MetricsRegistry::Summary MetricsRegistry::summary(MetricId id) const {
+    std::scoped_lock lk(mutex_);
+    const auto metrics = registered();
+    return id < metrics.size() ? summarize(metrics[id]) : Summary{};
+}
+
+bool MetricsRegistry::export_csv(std::string path) const {
+    if (path.empty()) path = default_metrics_name();
+    std::scoped_lock lk(mutex_);
+    return write_csv(path);
+}
+
+bool MetricsRegistry::write_csv(const std::string& path) const {
+    std::ofstream out(path, std::ios::trunc);
+    if (!out) { VV_LOG_ERROR("Cannot write %s", path.c_str()); return false; }
+    const auto metrics = registered();
+    out << "frame";
+    for (const auto& m : metrics) { out << ',' << m.name; if (!m.unit.empty()) out << '[' << m.unit << ']'; }
+    out << ",hitch\n";
+    for (uint32_t i = 0, slot = oldest(); i < count_; ++i, slot = (slot + 1u) % history) {
+        out << frames_[slot];
+        for (const auto& m : metrics) out << ',' << m.samples[slot];
+        out << ',' << static_cast<int>(hitch_[slot]) << '\n';
+    }
+    VV_LOG_INFO("Metrics: %u frames written to %s", count_, path.c_str());
+    return static_cast<bool>(out);
+}
+
+void MetricsRegistry::plot(const Metric& m, const Summary& s, float width, float height) const {
+    const float scale_max = std::max(s.max, 1e-6f);
+    ImGui::PushID(&m);
+    // Before the ring wraps the samples are slots [0, count_) in order; afterwards they start at head_
+    ImGui::PlotLines("##plot", m.samples.data(), static_cast<int>(count_), count_ == history ? static_cast<int>(head_) : 0, nullptr, 0.0f, scale_max, ImVec2(width, height));
+    if (count_ > 1u && hitch_metric_ != invalid) {
+        const ImVec2 pad = ImGui::GetStyle().FramePadding;
+        const ImVec2 lo{ImGui::GetItemRectMin().x + pad.x, ImGui::GetItemRectMin().y + pad.y};
+        const ImVec2 hi{ImGui::GetItemRectMax().x - pad.x, ImGui::GetItemRectMax().y - pad.y};
+        ImDrawList* draw = ImGui::GetWindowDrawList();
+        for (uint32_t i = 0, slot = oldest(); i < count_; ++i, slot = (slot + 1u) % history) {
+            if (!hitch_[slot]) continue;
+            const float x = lo.x + (hi.x - lo.x) * static_cast<float>(i) / static_cast<float>(count_ - 1u);
+            draw->AddLine(ImVec2(x, lo.y), ImVec2(x, hi.y), IM_COL32(255, 80, 80, 160));
+        }
+    }
+    ImGui::PopID();
+}
+
+void MetricsRegistry::sparkline(const Metric& m, float x, float y, float width, float height, float scale_max) const {
+    ImDrawList* draw = ImGui::GetForegroundDrawList(ImGui::GetMainViewport());
+    draw->AddRectFilled(ImVec2(x, y), ImVec2(x + width, y + height), IM_COL32(20, 22, 26, 160));
+    if (count_ < 2u) return;
+    const float dx = width / static_cast<float>(history - 1u); // fixed scale: the line fills in as history accumulates
+    ImVec2 prev{};
+    for (uint32_t i = 0, slot = oldest(); i < count_; ++i, slot = (slot + 1u) % history) {
+        const float px = x + width - static_cast<float>(count_ - 1u - i) * dx;
+        const ImVec2 p{px, y + height - height * std::clamp(m.samples[slot] / scale_max, 0.0f, 1.0f)};
+        if (hitch_[slot]) draw->AddLine(ImVec2(px, y), ImVec2(px, y + height), IM_COL32(255, 80, 80, 200));
+        if (i > 0) draw->AddLine(prev, p, IM_COL32(120, 220, 120, 255));
+        prev = p;
+    }
+}
+
+void MetricsRegistry::imgui_panel_contents() {
+    std::scoped_lock lk(mutex_);
+    ImGui::Checkbox("HUD", &hud_);
+    ImGui::SameLine(); ImGui::SetNextItemWidth(120.0f);
+    ImGui::SliderFloat("Hitch (x median)", &hitch_factor_, 1.0f, 10.0f, "%.1f");
+    ImGui::SameLine();
+    static std::string last_export;
+    if (ImGui::Button("Export CSV")) {
+        last_export = default_metrics_name();
+        if (!write_csv(last_export)) last_export = "(failed)";
+    }
+    if (!last_export.empty()) { ImGui::SameLine(); ImGui::TextDisabled("%s", last_export.c_str()); }
+    ImGui::Text("%u frames retained, %llu hitches", count_, static_cast<unsigned long long>(hitch_total_));
+
+    if (ImGui::BeginTable("metrics", 8, ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV | ImGuiTableFlags_SizingFixedFit)) {
+        ImGui::TableSetupColumn("Metric");
+        ImGui::TableSetupColumn("Last");
+        ImGui::TableSetupColumn("p50");
+        ImGui::TableSetupColumn("p95");
+        ImGui::TableSetupColumn("p99");
+        ImGui::TableSetupColumn("Max");
+        ImGui::TableSetupColumn("History", ImGuiTableColumnFlags_WidthStretch);
+        ImGui::TableSetupColumn("HUD");
+        ImGui::TableHeadersRow();
+        for (auto& m : registered()) {
+            const Summary s = summarize(m);
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn(); ImGui::Text("%s%s%s", m.name.c_str(), m.unit.empty() ? "" : " ", m.unit.c_str());
+            ImGui::TableNextColumn(); ImGui::Text("%.3f", s.last);
+            ImGui::TableNextColumn(); ImGui::Text("%.3f", s.p50);
+            ImGui::TableNextColumn(); ImGui::Text("%.3f", s.p95);
+            ImGui::TableNextColumn(); ImGui::Text("%.3f", s.p99);
+            ImGui::TableNextColumn(); ImGui::Text("%.3f", s.max);
+            ImGui::TableNextColumn(); plot(m, s, -1.0f, 32.0f);
+            ImGui::TableNextColumn(); ImGui::PushID(&m); ImGui::Checkbox("##hud", &m.hud); ImGui::PopID();
+        }
+        ImGui::EndTable();
+    }
+
+    if (hitch_total_ > 0 && ImGui::TreeNode("Recent hitches")) {
+        const uint64_t n = std::min<uint64_t>(hitch_total_, hitch_events);
+        for (uint64_t i = 0; i < n; ++i) {
+            const Hitch& h = hitches_[(hitch_total_ - 1u - i) % hitch_events];
+            ImGui::Text("frame %llu: %.2f (median %.2f, %.1fx)", static_cast<unsigned long long>(h.frame), h.value, h.median, h.value / std::max(h.median, 1e-6f));
+        }
+        ImGui::TreePop();
+    }
+}
+
+void MetricsRegistry::imgui_hud() {
+    if (!hud_ || !ImGui::GetCurrentContext()) return;
+    std::scoped_lock lk(mutex_);
+    const ImGuiViewport* vp = ImGui::GetMainViewport();
+    constexpr float width = 240.0f, height = 36.0f, margin = 12.0f;
+    const float line = ImGui::GetTextLineHeight();
+    float y = vp->Pos.y + vp->Size.y - margin;
+    // Bottom-left, stacked upwards
+    const auto metrics = registered();
+    for (auto it = metrics.rbegin(); it != metrics.rend(); ++it) {
+        const Metric& m = *it;
+        if (!m.hud) continue;
+        const Summary s = summarize(m);
+        y -= height;
+        sparkline(m, vp->Pos.x + margin, y, width, height, std::max(s.p99 * 1.5f, 1e-6f));
+        y -= line + 2.0f;
+        char text[128];
+        std::snprintf(text, sizeof(text), "%s %.2f %s  p50 %.2f  p99 %.2f", m.name.c_str(), s.last, m.unit.c_str(), s.p50, s.p99);
+        ImGui::GetForegroundDrawList(vp)->AddText(ImVec2(vp->Pos.x + margin, y), IM_COL32(230, 230, 230, 255), text);
+        y -= 6.0f;
+    }
+}
+
+} // namespace vv
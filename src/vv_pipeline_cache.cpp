@@ -0,0 +1,138 @@
+#include "vv_pipeline_cache.h"
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <imgui.h>
+#include <vector>
+
+namespace vv {
+
+namespace {
+    constexpr uint32_t kMagic   = 0x43505656u; // "VVPC"
+    constexpr uint32_t kVersion = 1u;
+
+    // Prefixed to the driver's blob. The blob's own header already carries vendor/device/UUID, but drivers differ in how
+    // strictly they check it and a truncated file would still be handed to them; this one is checked before they see it.
+    struct FileHeader {
+        uint32_t magic;
+        uint32_t version;
+        uint32_t vendor_id;
+        uint32_t device_id;
+        uint32_t driver_version;
+        uint8_t uuid[VK_UUID_SIZE];
+        uint64_t data_size;
+        uint64_t data_hash;
+    };
+
+    uint64_t fnv1a(const uint8_t* p, size_t n) {
+        uint64_t h = 1469598103934665603ull;
+        for (size_t i = 0; i < n; ++i) { h ^= p[i]; h *= 1099511628211ull; }
+        return h;
+    }
+
+    template <class CreateInfo, class Fn>
+    VkResult create_with_feedback(const CreateInfo& info, Fn&& call, VkPipelineCreationFeedback& feedback, double& ms) {
+        CreateInfo ci = info;
+        VkPipelineCreationFeedbackCreateInfo fci{.sType = VK_STRUCTURE_TYPE_PIPELINE_CREATION_FEEDBACK_CREATE_INFO, .pNext = ci.pNext, .pPipelineCreationFeedback = &feedback, .pipelineStageCreationFeedbackCount = 0u, .pPipelineStageCreationFeedbacks = nullptr};
+        ci.pNext = &fci;
+        const auto t0 = std::chrono::steady_clock::now();
+        const VkResult r = call(ci);
+        ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+        return r;
+    }
+} // namespace
+
+bool PipelineCache::init(VkDevice device, VkPhysicalDevice physical, const std::filesystem::path& directory) {
+    device_ = device;
+    vkGetPhysicalDeviceProperties(physical, &props_);
+    char name[64]; std::snprintf(name, sizeof(name), "pipelines_%04x_%04x.bin", props_.vendorID, props_.deviceID);
+    path_ = directory / name;
+
+    std::vector<uint8_t> blob;
+    if (std::ifstream in{path_, std::ios::binary}) {
+        FileHeader h{};
+        if (!in.read(reinterpret_cast<char*>(&h), sizeof(h)) || h.magic != kMagic || h.version != kVersion) load_status_ = "rejected: not a cache file";
+        else if (h.vendor_id != props_.vendorID || h.device_id != props_.deviceID) load_status_ = "rejected: different device";
+        else if (h.driver_version != props_.driverVersion || std::memcmp(h.uuid, props_.pipelineCacheUUID, VK_UUID_SIZE) != 0) load_status_ = "rejected: driver changed";
+        else {
+            blob.resize(static_cast<size_t>(h.data_size));
+            if (!in.read(reinterpret_cast<char*>(blob.data()), static_cast<std::streamsize>(blob.size())) || fnv1a(blob.data(), blob.size()) != h.data_hash) { blob.clear(); load_status_ = "rejected: corrupt"; }
+            else load_status_ = "loaded";
+        }
+    } else load_status_ = "cold (no cache file)";
+
+    VkPipelineCacheCreateInfo ci{.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO, .pNext = nullptr, .flags = 0u, .initialDataSize = blob.size(), .pInitialData = blob.empty() ? nullptr : blob.data()};
+    if (vkCreatePipelineCache(device_, &ci, nullptr, &cache_) != VK_SUCCESS) {
+        // The driver refused the blob after all: start empty rather than without a cache
+        ci.initialDataSize = 0; ci.pInitialData = nullptr; load_status_ = "rejected by driver";
+        if (vkCreatePipelineCache(device_, &ci, nullptr, &cache_) != VK_SUCCESS) { cache_ = VK_NULL_HANDLE; return false; }
+        blob.clear();
+    }
+    stats_.loaded_bytes = blob.size();
+    return true;
+}
+
+void PipelineCache::shutdown() {
+    if (cache_ && stats_.misses + stats_.unreported > 0) save();
+    if (cache_) vkDestroyPipelineCache(device_, cache_, nullptr);
+    cache_ = VK_NULL_HANDLE; device_ = VK_NULL_HANDLE;
+}
+
+bool PipelineCache::save() {
+    if (!cache_) return false;
+    size_t size = 0;
+    if (vkGetPipelineCacheData(device_, cache_, &size, nullptr) != VK_SUCCESS || size == 0) return false;
+    std::vector<uint8_t> blob(size);
+    if (vkGetPipelineCacheData(device_, cache_, &size, blob.data()) != VK_SUCCESS) return false;
+    blob.resize(size);
+
+    FileHeader h{.magic = kMagic, .version = kVersion, .vendor_id = props_.vendorID, .device_id = props_.deviceID, .driver_version = props_.driverVersion, .uuid = {}, .data_size = blob.size(), .data_hash = fnv1a(blob.data(), blob.size())};
+    std::memcpy(h.uuid, props_.pipelineCacheUUID, VK_UUID_SIZE);
+
+    // Write next to the target and rename, so a crash mid-write never leaves a truncated cache behind
+    std::error_code ec;
+    std::filesystem::create_directories(path_.parent_path(), ec);
+    std::filesystem::path tmp = path_; tmp += ".tmp";
+    {
+        std::ofstream out{tmp, std::ios::binary | std::ios::trunc};
+        if (!out.write(reinterpret_cast<const char*>(&h), sizeof(h)) || !out.write(reinterpret_cast<const char*>(blob.data()), static_cast<std::streamsize>(blob.size()))) return false;
+    }
+    std::filesystem::rename(tmp, path_, ec);
+    if (ec) { std::filesystem::remove(tmp, ec); return false; }
+    std::scoped_lock lock(mutex_);
+    stats_.saved_bytes = blob.size();
+    return true;
+}
+
+VkResult PipelineCache::create(const VkGraphicsPipelineCreateInfo& info, VkPipeline* pipeline) {
+    VkPipelineCreationFeedback feedback{}; double ms = 0.0;
+    const VkResult r = create_with_feedback(info, [&](const VkGraphicsPipelineCreateInfo& ci) { return vkCreateGraphicsPipelines(device_, cache_, 1u, &ci, nullptr, pipeline); }, feedback, ms);
+    if (r == VK_SUCCESS) record(feedback, ms);
+    return r;
+}
+
+VkResult PipelineCache::create(const VkComputePipelineCreateInfo& info, VkPipeline* pipeline) {
+    VkPipelineCreationFeedback feedback{}; double ms = 0.0;
+    const VkResult r = create_with_feedback(info, [&](const VkComputePipelineCreateInfo& ci) { return vkCreateComputePipelines(device_, cache_, 1u, &ci, nullptr, pipeline); }, feedback, ms);
+    if (r == VK_SUCCESS) record(feedback, ms);
+    return r;
+}
+
+void PipelineCache::record(const VkPipelineCreationFeedback& feedback, double ms) {
+    std::scoped_lock lock(mutex_);
+    if (!(feedback.flags & VK_PIPELINE_CREATION_FEEDBACK_VALID_BIT)) stats_.unreported++;
+    else if (feedback.flags & VK_PIPELINE_CREATION_FEEDBACK_APPLICATION_PIPELINE_CACHE_HIT_BIT) stats_.hits++;
+    else stats_.misses++;
+    stats_.create_ms += ms;
+}
+
+void PipelineCache::imgui_panel_contents() {
+    const Stats s = stats();
+    ImGui::Text("Pipeline cache: %s (%.1f KiB)", load_status_.c_str(), static_cast<double>(s.loaded_bytes) / 1024.0);
+    ImGui::Text("Pipelines: %u hits, %u misses, %u unreported, %.2f ms creating", s.hits, s.misses, s.unreported, s.create_ms);
+    if (ImGui::Button("Save pipeline cache")) save();
+    if (s.saved_bytes) { ImGui::SameLine(); ImGui::Text("saved %.1f KiB", static_cast<double>(s.saved_bytes) / 1024.0); }
+}
+
+} // namespace vv
@@ -0,0 +1,512 @@
+#include "vv_profiler.h"
+#include <algorithm>
+#include <chrono>
+#include <ctime>
+#include <fstream>
+#include <imgui.h>
+#include <iomanip>
+#include <memory>
+#include <sstream>
+#include <stdexcept>
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#endif
+
+namespace vv {
+
+namespace {
+    // Zones open on this thread (indices into the current slot). Worker threads start empty and parent to the frame root.
+    thread_local std::vector<uint32_t> t_zone_stack;
+    thread_local bool t_stats_open = false; // a pipeline statistics query is active in this thread's command buffer
+    constexpr uint32_t initial_queries       = 64u;
+    constexpr uint32_t initial_stats_queries = 16u;
+    // Result order follows bit order: IA vertices, IA primitives, VS, clipping invocations, clipping primitives, FS, CS
+    constexpr VkQueryPipelineStatisticFlags pipeline_statistic_bits = VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_VERTICES_BIT | VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_PRIMITIVES_BIT |
+        VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT | VK_QUERY_PIPELINE_STATISTIC_CLIPPING_INVOCATIONS_BIT | VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT |
+        VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT | VK_QUERY_PIPELINE_STATISTIC_COMPUTE_SHADER_INVOCATIONS_BIT;
+    constexpr uint32_t pipeline_statistic_count = 7u;
+}
+
+PipelineCounters& PipelineCounters::operator+=(const PipelineCounters& o) {
+    input_vertices += o.input_vertices; input_primitives += o.input_primitives; vertex_invocations += o.vertex_invocations;
+    clipping_invocations += o.clipping_invocations; clipping_primitives += o.clipping_primitives;
+    fragment_invocations += o.fragment_invocations; compute_invocations += o.compute_invocations;
+    return *this;
+}
+
+bool GpuProfiler::init(VkPhysicalDevice physical, VkDevice device, uint32_t queue_family, uint32_t frames_in_flight) {
+    uint32_t qcount = 0; vkGetPhysicalDeviceQueueFamilyProperties(physical, &qcount, nullptr);
+    std::vector<VkQueueFamilyProperties> qprops(qcount); vkGetPhysicalDeviceQueueFamilyProperties(physical, &qcount, qprops.data());
+    if (queue_family >= qcount || qprops[queue_family].timestampValidBits == 0) return false;
+    const uint32_t bits = qprops[queue_family].timestampValidBits;
+    valid_mask_ = bits >= 64 ? ~0ull : ((1ull << bits) - 1ull);
+
+    VkPhysicalDeviceProperties props{}; vkGetPhysicalDeviceProperties(physical, &props);
+    period_ns_ = static_cast<double>(props.limits.timestampPeriod);
+    device_    = device;
+    slots_.resize(frames_in_flight);
+    for (auto& s : slots_) create_pool(s, initial_queries);
+    return true;
+}
+
+bool GpuProfiler::enable_calibration(VkInstance instance, VkPhysicalDevice physical) {
+    auto get_domains = reinterpret_cast<PFN_vkGetPhysicalDeviceCalibrateableTimeDomainsEXT>(vkGetInstanceProcAddr(instance, "vkGetPhysicalDeviceCalibrateableTimeDomainsEXT"));
+    auto get_ts      = reinterpret_cast<PFN_vkGetCalibratedTimestampsEXT>(vkGetDeviceProcAddr(device_, "vkGetCalibratedTimestampsEXT"));
+    if (!get_domains || !get_ts) return false;
+    uint32_t count = 0; get_domains(physical, &count, nullptr);
+    std::vector<VkTimeDomainEXT> domains(count); get_domains(physical, &count, domains.data());
+    // The host domain must be the clock behind std::chrono::steady_clock (CpuTracer::now_ns)
+#ifdef _WIN32
+    const VkTimeDomainEXT host = VK_TIME_DOMAIN_QUERY_PERFORMANCE_COUNTER_EXT;
+    LARGE_INTEGER freq{}; QueryPerformanceFrequency(&freq);
+    host_tick_ns_ = 1.0e9 / static_cast<double>(freq.QuadPart);
+#else
+    const VkTimeDomainEXT host = VK_TIME_DOMAIN_CLOCK_MONOTONIC_EXT;
+    host_tick_ns_ = 1.0;
+#endif
+    if (std::ranges::find(domains, VK_TIME_DOMAIN_DEVICE_EXT) == domains.end() || std::ranges::find(domains, host) == domains.end()) return false;
+    host_domain_   = host;
+    get_calibrated_ = get_ts;
+    return true;
+}
+
+bool GpuProfiler::calibrate(uint64_t& gpu_ticks, uint64_t& host_ns) const {
+    const VkCalibratedTimestampInfoEXT infos[2]{
+        {.sType = VK_STRUCTURE_TYPE_CALIBRATED_TIMESTAMP_INFO_EXT, .pNext = nullptr, .timeDomain = VK_TIME_DOMAIN_DEVICE_EXT},
+        {.sType = VK_STRUCTURE_TYPE_CALIBRATED_TIMESTAMP_INFO_EXT, .pNext = nullptr, .timeDomain = host_domain_}};
+    uint64_t ts[2]{}; uint64_t deviation = 0;
+    if (get_calibrated_(device_, 2u, infos, ts, &deviation) != VK_SUCCESS) return false;
+    gpu_ticks = ts[0] & valid_mask_;
+    host_ns   = static_cast<uint64_t>(static_cast<double>(ts[1]) * host_tick_ns_);
+    return true;
+}
+
+void GpuProfiler::shutdown() {
+    if (active() == this) set_active(nullptr);
+    for (auto& s : slots_) {
+        if (s.pool) { vkDestroyQueryPool(device_, s.pool, nullptr); s.pool = VK_NULL_HANDLE; }
+        if (s.stats_pool) { vkDestroyQueryPool(device_, s.stats_pool, nullptr); s.stats_pool = VK_NULL_HANDLE; }
+    }
+    slots_.clear(); history_.clear(); order_.clear();
+    current_ = nullptr; device_ = VK_NULL_HANDLE; get_calibrated_ = nullptr; stats_enabled_ = false;
+}
+
+void GpuProfiler::create_pool(Slot& slot, uint32_t capacity) {
+    if (slot.pool) vkDestroyQueryPool(device_, slot.pool, nullptr);
+    VkQueryPoolCreateInfo qci{.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO, .pNext = nullptr, .flags = 0u, .queryType = VK_QUERY_TYPE_TIMESTAMP, .queryCount = capacity, .pipelineStatistics = 0u};
+    if (vkCreateQueryPool(device_, &qci, nullptr, &slot.pool) != VK_SUCCESS) throw std::runtime_error("GpuProfiler: vkCreateQueryPool failed");
+    slot.capacity = capacity; slot.used = 0; slot.overflow = false; slot.zones.clear();
+}
+
+void GpuProfiler::enable_pipeline_statistics() {
+    std::scoped_lock lk(mutex_);
+    for (auto& s : slots_) create_stats_pool(s, initial_stats_queries);
+    stats_enabled_ = true;
+}
+
+void GpuProfiler::create_stats_pool(Slot& slot, uint32_t capacity) {
+    if (slot.stats_pool) vkDestroyQueryPool(device_, slot.stats_pool, nullptr);
+    VkQueryPoolCreateInfo qci{.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO, .pNext = nullptr, .flags = 0u, .queryType = VK_QUERY_TYPE_PIPELINE_STATISTICS, .queryCount = capacity, .pipelineStatistics = pipeline_statistic_bits};
+    if (vkCreateQueryPool(device_, &qci, nullptr, &slot.stats_pool) != VK_SUCCESS) throw std::runtime_error("GpuProfiler: vkCreateQueryPool (pipeline statistics) failed");
+    slot.stats_capacity = capacity; slot.stats_used = 0; slot.stats_overflow = false;
+}
+
+void GpuProfiler::begin_frame(VkCommandBuffer cmd, uint32_t frame_slot) {
+    std::scoped_lock lk(mutex_);
+    Slot& s = slots_[frame_slot % slots_.size()];
+    // The engine has already waited this slot's timeline value, so the queries are either available or were never written.
+    if (s.used > 0) resolve(s);
+    if (s.overflow) create_pool(s, s.capacity * 2u);
+    if (s.stats_overflow) create_stats_pool(s, s.stats_capacity * 2u);
+    vkCmdResetQueryPool(cmd, s.pool, 0u, s.capacity);
+    if (s.stats_pool) vkCmdResetQueryPool(cmd, s.stats_pool, 0u, s.stats_capacity);
+    s.stats_used = 0u;
+    s.zones.clear();
+    s.zones.push_back(Zone{.name = "frame", .parent = UINT32_MAX, .depth = 0u});
+    s.used = 2u;
+    vkCmdWriteTimestamp2(cmd, VK_PIPELINE_STAGE_2_TOP_OF_PIPE_BIT, s.pool, 0u);
+    current_ = &s;
+    t_zone_stack.clear();
+    t_stats_open = false;
+}
+
+void GpuProfiler::end_frame(VkCommandBuffer cmd) {
+    if (!current_) return;
+    vkCmdWriteTimestamp2(cmd, VK_PIPELINE_STAGE_2_BOTTOM_OF_PIPE_BIT, current_->pool, 1u);
+    current_ = nullptr;
+}
+
+uint32_t GpuProfiler::begin_zone(VkCommandBuffer cmd, std::string_view name, ZoneFlags flags) {
+    uint32_t zone = UINT32_MAX, stats_query = UINT32_MAX;
+    VkQueryPool pool = VK_NULL_HANDLE, stats_pool = VK_NULL_HANDLE;
+    {
+        std::scoped_lock lk(mutex_);
+        if (!current_) return UINT32_MAX;
+        if (current_->used + 2u > current_->capacity) { current_->overflow = true; t_zone_stack.push_back(UINT32_MAX); return UINT32_MAX; }
+        const uint32_t parent = t_zone_stack.empty() ? 0u : t_zone_stack.back();
+        zone = static_cast<uint32_t>(current_->zones.size());
+        if ((static_cast<uint32_t>(flags) & static_cast<uint32_t>(ZoneFlags::PipelineStats)) && stats_enabled_ && !t_stats_open) {
+            if (current_->stats_used < current_->stats_capacity) stats_query = current_->stats_used++;
+            else current_->stats_overflow = true;
+        }
+        current_->zones.push_back(Zone{.name = std::string(name), .parent = parent, .depth = current_->zones[parent].depth + 1u, .stats_query = stats_query});
+        current_->used += 2u;
+        pool = current_->pool; stats_pool = current_->stats_pool;
+    }
+    t_zone_stack.push_back(zone);
+    // ALL_COMMANDS rather than TOP_OF_PIPE so a zone does not absorb the tail of the work recorded before it.
+    vkCmdWriteTimestamp2(cmd, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, pool, zone * 2u);
+    if (stats_query != UINT32_MAX) { vkCmdBeginQuery(cmd, stats_pool, stats_query, 0u); t_stats_open = true; }
+    return zone;
+}
+
+void GpuProfiler::end_zone(VkCommandBuffer cmd, uint32_t zone) {
+    if (!t_zone_stack.empty()) t_zone_stack.pop_back();
+    if (zone == UINT32_MAX) return;
+    VkQueryPool pool = VK_NULL_HANDLE, stats_pool = VK_NULL_HANDLE;
+    uint32_t stats_query = UINT32_MAX;
+    { std::scoped_lock lk(mutex_); if (!current_) return; pool = current_->pool; stats_pool = current_->stats_pool; stats_query = current_->zones[zone].stats_query; }
+    if (stats_query != UINT32_MAX) { vkCmdEndQuery(cmd, stats_pool, stats_query); t_stats_open = false; }
+    vkCmdWriteTimestamp2(cmd, VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, pool, zone * 2u + 1u);
+}
+
+void GpuProfiler::resolve(Slot& slot) {
+    // [value, availability] pairs; no WAIT_BIT, unavailable zones are skipped for this frame
+    std::vector<uint64_t> raw(static_cast<size_t>(slot.used) * 2u);
+    const VkResult r = vkGetQueryPoolResults(device_, slot.pool, 0u, slot.used, raw.size() * sizeof(uint64_t), raw.data(), sizeof(uint64_t) * 2u, VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+    if (r != VK_SUCCESS && r != VK_NOT_READY) return;
+    // Pipeline statistics: 7 counters + availability per query, same non-blocking rules
+    constexpr uint32_t stats_stride = pipeline_statistic_count + 1u;
+    std::vector<uint64_t> stats_raw(static_cast<size_t>(slot.stats_used) * stats_stride);
+    bool stats_ok = false;
+    if (slot.stats_used > 0) {
+        const VkResult sr = vkGetQueryPoolResults(device_, slot.stats_pool, 0u, slot.stats_used, stats_raw.size() * sizeof(uint64_t), stats_raw.data(), sizeof(uint64_t) * stats_stride, VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+        stats_ok = sr == VK_SUCCESS || sr == VK_NOT_READY;
+    }
+
+    const size_t n = slot.zones.size();
+    std::vector<std::string> paths(n);
+    std::vector<std::vector<uint32_t>> children(n);
+    for (uint32_t i = 0; i < n; ++i) {
+        const Zone& z = slot.zones[i];
+        paths[i]      = (i == 0 || z.parent == 0u) ? z.name : paths[z.parent] + "/" + z.name;
+        if (i > 0) children[z.parent].push_back(i);
+    }
+
+    // Same-frame calibration: GPU ticks -> steady_clock ns for zones merged into a running CPU trace capture
+    uint64_t cal_gpu = 0, cal_host = 0;
+    const bool merge = get_calibrated_ && CpuTracer::accepts_gpu_events() && calibrate(cal_gpu, cal_host);
+    const auto to_host = [&](uint64_t t) { return static_cast<uint64_t>(static_cast<double>(cal_host) + (static_cast<double>(t) - static_cast<double>(cal_gpu)) * period_ns_); };
+
+    order_.clear();
+    std::vector<uint32_t> stack{0u};
+    while (!stack.empty()) {
+        const uint32_t i = stack.back(); stack.pop_back();
+        const uint64_t* b = &raw[static_cast<size_t>(i) * 4u];
+        if (b[1] != 0 && b[3] != 0) {
+            const uint64_t t0 = b[0] & valid_mask_, t1 = b[2] & valid_mask_;
+            const double ms   = t1 >= t0 ? static_cast<double>(t1 - t0) * period_ns_ / 1.0e6 : 0.0;
+            History& h        = history_[paths[i]];
+            h.name = slot.zones[i].name; h.depth = slot.zones[i].depth;
+            h.push(static_cast<float>(ms));
+            const uint32_t sq = slot.zones[i].stats_query;
+            const uint64_t* c = stats_ok && sq != UINT32_MAX ? &stats_raw[static_cast<size_t>(sq) * stats_stride] : nullptr;
+            h.has_pipeline    = c && c[pipeline_statistic_count] != 0;
+            if (h.has_pipeline) h.pipeline = PipelineCounters{.input_vertices = c[0], .input_primitives = c[1], .vertex_invocations = c[2], .clipping_invocations = c[3], .clipping_primitives = c[4], .fragment_invocations = c[5], .compute_invocations = c[6]};
+            if (i == 0) frame_ms_ = ms;
+            if (merge) CpuTracer::add_gpu_event(slot.zones[i].name, to_host(t0), to_host(t1), slot.zones[i].depth);
+            order_.push_back(paths[i]);
+        }
+        for (auto it = children[i].rbegin(); it != children[i].rend(); ++it) stack.push_back(*it);
+    }
+}
+
+double GpuProfiler::zone_ms(std::string_view path) const {
+    std::scoped_lock lk(mutex_);
+    auto it = history_.find(std::string(path));
+    if (it == history_.end() || it->second.count == 0) return 0.0;
+    const History& h = it->second;
+    return h.samples[(h.head + history_frames - 1) % history_frames];
+}
+
+std::vector<GpuProfiler::ZoneStats> GpuProfiler::stats() const {
+    std::scoped_lock lk(mutex_);
+    std::vector<ZoneStats> out; out.reserve(order_.size());
+    std::array<float, history_frames> sorted{};
+    for (const auto& path : order_) {
+        auto it = history_.find(path);
+        if (it == history_.end() || it->second.count == 0) continue;
+        const History& h = it->second;
+        ZoneStats s{.path = path, .name = h.name, .depth = h.depth, .has_pipeline = h.has_pipeline, .pipeline = h.pipeline};
+        s.last_ms = h.samples[(h.head + history_frames - 1) % history_frames];
+        double sum = 0.0;
+        for (uint32_t i = 0; i < h.count; ++i) sum += h.samples[i];
+        std::copy_n(h.samples.begin(), h.count, sorted.begin());
+        std::sort(sorted.begin(), sorted.begin() + h.count);
+        s.min_ms = sorted[0];
+        s.avg_ms = sum / h.count;
+        s.p99_ms = sorted[std::min<uint32_t>(h.count - 1, static_cast<uint32_t>(h.count * 0.99))];
+        out.push_back(std::move(s));
+    }
+    return out;
+}
+
+PipelineCounters GpuProfiler::pipeline_totals() const {
+    std::scoped_lock lk(mutex_);
+    PipelineCounters total{};
+    for (const auto& path : order_) {
+        auto it = history_.find(path);
+        if (it != history_.end() && it->second.has_pipeline) total += it->second.pipeline;
+    }
+    return total;
+}
+
+void GpuProfiler::imgui_panel_contents() const {
+    const auto zones = stats();
+    if (zones.empty()) { ImGui::TextDisabled("No GPU zones resolved yet"); return; }
+    if (ImGui::BeginTable("##gpu_zones", 5, ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV | ImGuiTableFlags_SizingStretchProp)) {
+        ImGui::TableSetupColumn("Zone", ImGuiTableColumnFlags_WidthStretch, 3.0f);
+        ImGui::TableSetupColumn("last");
+        ImGui::TableSetupColumn("min");
+        ImGui::TableSetupColumn("avg");
+        ImGui::TableSetupColumn("p99");
+        ImGui::TableHeadersRow();
+        for (const auto& z : zones) {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn(); ImGui::Text("%*s%s", static_cast<int>(z.depth * 2u), "", z.name.c_str());
+            ImGui::TableNextColumn(); ImGui::Text("%.3f", z.last_ms);
+            ImGui::TableNextColumn(); ImGui::Text("%.3f", z.min_ms);
+            ImGui::TableNextColumn(); ImGui::Text("%.3f", z.avg_ms);
+            ImGui::TableNextColumn(); ImGui::Text("%.3f", z.p99_ms);
+        }
+        ImGui::EndTable();
+    }
+    ImGui::TextDisabled("ms over the last %u frames", history_frames);
+
+    if (!stats_enabled_ || std::ranges::none_of(zones, [](const ZoneStats& z) { return z.has_pipeline; })) return;
+    // FS/VS >> 1 points at fragment-bound passes, clip out/in << 1 at vertex work spent on culled geometry
+    if (ImGui::BeginTable("##gpu_pipeline_stats", 7, ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV | ImGuiTableFlags_SizingStretchProp)) {
+        ImGui::TableSetupColumn("Zone", ImGuiTableColumnFlags_WidthStretch, 3.0f);
+        ImGui::TableSetupColumn("VS");
+        ImGui::TableSetupColumn("clip in");
+        ImGui::TableSetupColumn("clip out");
+        ImGui::TableSetupColumn("FS");
+        ImGui::TableSetupColumn("CS");
+        ImGui::TableSetupColumn("FS/VS");
+        ImGui::TableHeadersRow();
+        for (const auto& z : zones) {
+            if (!z.has_pipeline) continue;
+            const PipelineCounters& c = z.pipeline;
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn(); ImGui::TextUnformatted(z.path.c_str());
+            ImGui::TableNextColumn(); ImGui::Text("%llu", static_cast<unsigned long long>(c.vertex_invocations));
+            ImGui::TableNextColumn(); ImGui::Text("%llu", static_cast<unsigned long long>(c.clipping_invocations));
+            ImGui::TableNextColumn(); ImGui::Text("%llu", static_cast<unsigned long long>(c.clipping_primitives));
+            ImGui::TableNextColumn(); ImGui::Text("%llu", static_cast<unsigned long long>(c.fragment_invocations));
+            ImGui::TableNextColumn(); ImGui::Text("%llu", static_cast<unsigned long long>(c.compute_invocations));
+            ImGui::TableNextColumn(); if (c.vertex_invocations) ImGui::Text("%.1f", static_cast<double>(c.fragment_invocations) / static_cast<double>(c.vertex_invocations)); else ImGui::TextDisabled("-");
+        }
+        ImGui::EndTable();
+    }
+}
+
+namespace {
+    struct ThreadRing {
+        std::array<CpuTracer::Event, CpuTracer::ring_events> events{};
+        std::atomic<uint64_t> head{0};
+        uint32_t tid{0};
+        std::string name;
+    };
+    struct GpuEvent { std::string name; uint64_t begin_ns{0}; uint64_t end_ns{0}; uint32_t depth{0}; };
+    enum class CapturePhase : uint8_t { Idle, Pending, Recording, Draining };
+
+    struct TraceState {
+        std::mutex mutex;
+        std::vector<std::unique_ptr<ThreadRing>> rings;
+        std::vector<uint64_t> heads_at_begin;
+        std::vector<GpuEvent> gpu_events;
+        std::vector<std::string> messages;
+        std::atomic<CapturePhase> phase{CapturePhase::Idle};
+        uint32_t frames{0};
+        uint32_t frames_left{0};
+        std::string path;
+        uint64_t begin_ns{0};
+        uint64_t end_ns{0};
+    };
+    TraceState& trace_state() { static TraceState s; return s; }
+
+    thread_local ThreadRing* t_ring = nullptr;
+    thread_local uint32_t t_depth   = 0;
+
+    ThreadRing& thread_ring() {
+        if (!t_ring) {
+            TraceState& st = trace_state();
+            std::scoped_lock lk(st.mutex);
+            auto ring  = std::make_unique<ThreadRing>();
+            ring->tid  = static_cast<uint32_t>(st.rings.size()) + 1u;
+            ring->name = "thread " + std::to_string(ring->tid);
+            t_ring     = ring.get();
+            st.rings.push_back(std::move(ring));
+        }
+        return *t_ring;
+    }
+
+    std::string default_trace_name() {
+        std::time_t t = std::time(nullptr);
+        std::tm tm{};
+#ifdef _WIN32
+        localtime_s(&tm, &t);
+#else
+        localtime_r(&t, &tm);
+#endif
+        std::ostringstream oss; oss << "trace_" << std::put_time(&tm, "%Y%m%d_%H%M%S") << ".json";
+        return oss.str();
+    }
+
+    void write_json_string(std::ostream& os, std::string_view s) {
+        os << '"';
+        for (const char c : s) {
+            if (c == '"' || c == '\\') os << '\\' << c;
+            else if (static_cast<unsigned char>(c) < 0x20) os << ' ';
+            else os << c;
+        }
+        os << '"';
+    }
+
+    // Called on the main thread once recording has stopped; zones still open on other threads only append.
+    void write_capture(TraceState& st) {
+        std::scoped_lock lk(st.mutex);
+        std::ofstream os(st.path, std::ios::binary);
+        if (!os) { st.messages.push_back("Failed to write trace: " + st.path); return; }
+        os << std::fixed << std::setprecision(3);
+        const auto us = [&](uint64_t ns) { return static_cast<double>(ns - st.begin_ns) / 1000.0; };
+
+        os << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+        os << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"CPU\"}},\n";
+        os << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":2,\"tid\":0,\"args\":{\"name\":\"GPU\"}},\n";
+        os << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":2,\"tid\":1,\"args\":{\"name\":\"graphics queue\"}}";
+        size_t written = 0, dropped = 0;
+        for (size_t r = 0; r < st.rings.size(); ++r) {
+            const ThreadRing& ring = *st.rings[r];
+            const uint64_t head    = ring.head.load(std::memory_order_acquire);
+            const uint64_t start   = r < st.heads_at_begin.size() ? st.heads_at_begin[r] : 0u;
+            const uint64_t from    = std::max(start, head > CpuTracer::ring_events ? head - CpuTracer::ring_events : 0u);
+            dropped += static_cast<size_t>(from - start);
+            os << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << ring.tid << ",\"args\":{\"name\":"; write_json_string(os, ring.name); os << "}}";
+            for (uint64_t k = from; k < head; ++k) {
+                const CpuTracer::Event& e = ring.events[k % CpuTracer::ring_events];
+                if (e.begin_ns < st.begin_ns || e.end_ns > st.end_ns) continue;
+                os << ",\n{\"name\":"; write_json_string(os, e.name);
+                os << ",\"cat\":\"cpu\",\"ph\":\"X\",\"pid\":1,\"tid\":" << ring.tid << ",\"ts\":" << us(e.begin_ns) << ",\"dur\":" << static_cast<double>(e.end_ns - e.begin_ns) / 1000.0 << ",\"args\":{\"depth\":" << e.depth << "}}";
+                ++written;
+            }
+        }
+        for (const GpuEvent& e : st.gpu_events) {
+            os << ",\n{\"name\":"; write_json_string(os, e.name);
+            os << ",\"cat\":\"gpu\",\"ph\":\"X\",\"pid\":2,\"tid\":1,\"ts\":" << us(e.begin_ns) << ",\"dur\":" << static_cast<double>(e.end_ns - e.begin_ns) / 1000.0 << ",\"args\":{\"depth\":" << e.depth << "}}";
+            ++written;
+        }
+        os << "\n]}\n";
+        std::ostringstream msg;
+        msg << (os ? "Wrote trace: " : "Failed to write trace: ") << st.path << " (" << written << " events, " << st.gpu_events.size() << " GPU";
+        if (dropped) msg << ", " << dropped << " dropped by full rings";
+        msg << ")";
+        st.messages.push_back(msg.str());
+        st.gpu_events.clear();
+    }
+}
+
+uint64_t CpuTracer::now_ns() { return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count()); }
+
+uint32_t CpuTracer::enter() { return t_depth++; }
+
+void CpuTracer::leave(const char* name, uint64_t begin_ns, uint32_t depth) {
+    const uint64_t end = now_ns();
+    if (t_depth > 0) --t_depth;
+    ThreadRing& ring = thread_ring();
+    const uint64_t h = ring.head.load(std::memory_order_relaxed);
+    ring.events[h % ring_events] = Event{.name = name, .begin_ns = begin_ns, .end_ns = end, .depth = depth};
+    ring.head.store(h + 1u, std::memory_order_release);
+}
+
+void CpuTracer::set_thread_name(std::string_view name) {
+    ThreadRing& ring = thread_ring();
+    std::scoped_lock lk(trace_state().mutex);
+    ring.name = std::string(name);
+}
+
+void CpuTracer::request_capture(uint32_t frames, std::string path) {
+    TraceState& st = trace_state();
+    std::scoped_lock lk(st.mutex);
+    if (st.phase.load() != CapturePhase::Idle) { st.messages.push_back("Trace capture already running"); return; }
+    st.frames = std::max(1u, frames);
+    st.path   = path.empty() ? default_trace_name() : std::move(path);
+    st.phase.store(CapturePhase::Pending);
+}
+
+void CpuTracer::frame_mark() {
+    TraceState& st = trace_state();
+    switch (st.phase.load(std::memory_order_acquire)) {
+    case CapturePhase::Idle: break;
+    case CapturePhase::Pending: {
+        std::scoped_lock lk(st.mutex);
+        st.heads_at_begin.clear();
+        for (const auto& ring : st.rings) st.heads_at_begin.push_back(ring->head.load(std::memory_order_acquire));
+        st.gpu_events.clear();
+        st.begin_ns    = now_ns();
+        st.end_ns      = UINT64_MAX;
+        st.frames_left = st.frames;
+        st.phase.store(CapturePhase::Recording);
+        recording_.store(true, std::memory_order_relaxed);
+        break;
+    }
+    case CapturePhase::Recording:
+        if (--st.frames_left == 0) {
+            recording_.store(false, std::memory_order_relaxed);
+            { std::scoped_lock lk(st.mutex); st.end_ns = now_ns(); }
+            st.frames_left = drain_frames;
+            st.phase.store(CapturePhase::Draining);
+        }
+        break;
+    case CapturePhase::Draining:
+        if (--st.frames_left == 0) { write_capture(st); st.phase.store(CapturePhase::Idle); }
+        break;
+    }
+}
+
+bool CpuTracer::capture_busy() { return trace_state().phase.load(std::memory_order_acquire) != CapturePhase::Idle; }
+
+bool CpuTracer::accepts_gpu_events() {
+    const CapturePhase p = trace_state().phase.load(std::memory_order_acquire);
+    return p == CapturePhase::Recording || p == CapturePhase::Draining;
+}
+
+void CpuTracer::add_gpu_event(std::string_view name, uint64_t begin_ns, uint64_t end_ns, uint32_t depth) {
+    TraceState& st = trace_state();
+    std::scoped_lock lk(st.mutex);
+    if (begin_ns < st.begin_ns || end_ns > st.end_ns) return;
+    st.gpu_events.push_back(GpuEvent{.name = std::string(name), .begin_ns = begin_ns, .end_ns = end_ns, .depth = depth});
+}
+
+std::vector<std::string> CpuTracer::drain_messages() {
+    TraceState& st = trace_state();
+    std::scoped_lock lk(st.mutex);
+    std::vector<std::string> out; out.swap(st.messages);
+    return out;
+}
+
+void CpuTracer::imgui_panel_contents() {
+    static int frames = 60;
+    ImGui::SliderInt("Frames", &frames, 1, 600);
+    if (capture_busy()) { ImGui::TextDisabled("Capturing..."); return; }
+    if (ImGui::Button("Capture trace")) request_capture(static_cast<uint32_t>(frames));
+    ImGui::SameLine(); ImGui::TextDisabled("Chrome JSON (chrome://tracing, ui.perfetto.dev)");
+}
+
+} // namespace vv
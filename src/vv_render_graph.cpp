@@ -0,0 +1,215 @@
+#include "vv_render_graph.h"
+#include "vv_profiler.h"
+#include <algorithm>
+#include <imgui.h>
+#include <stdexcept>
+
+namespace vv {
+
+namespace {
+    constexpr VkAccessFlags2 write_access_bits = VK_ACCESS_2_SHADER_WRITE_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT | VK_ACCESS_2_COLOR_ATTACHMENT_WRITE_BIT |
+        VK_ACCESS_2_DEPTH_STENCIL_ATTACHMENT_WRITE_BIT | VK_ACCESS_2_TRANSFER_WRITE_BIT | VK_ACCESS_2_HOST_WRITE_BIT | VK_ACCESS_2_MEMORY_WRITE_BIT |
+        VK_ACCESS_2_ACCELERATION_STRUCTURE_WRITE_BIT_KHR;
+    // Non-dispatchable handles are pointers on 64-bit targets and uint64_t elsewhere
+    template <class H> uint64_t handle_key(H h) { return (uint64_t)(h); }
+}
+
+RenderGraph::PassBuilder& RenderGraph::PassBuilder::use(ResourceId id, const ResourceUse& u) {
+    if (id == invalid) return *this; // optional resources (e.g. no depth attachment) may be passed through unchecked
+    if (id >= graph_.resources_.size()) throw std::runtime_error("RenderGraph: unknown resource in pass " + graph_.passes_[pass_].name);
+    const Resource& r = graph_.resources_[id];
+    if (r.image && u.layout == VK_IMAGE_LAYOUT_UNDEFINED) throw std::runtime_error("RenderGraph: image use without a layout: " + r.name);
+    auto& uses = graph_.passes_[pass_].uses;
+    if (auto it = std::ranges::find(uses, id, &Use::id); it != uses.end()) {
+        if (r.image && it->use.layout != u.layout) throw std::runtime_error("RenderGraph: conflicting layouts for " + r.name + " in pass " + graph_.passes_[pass_].name);
+        it->use.stages |= u.stages;
+        it->use.access |= u.access;
+    } else {
+        uses.push_back(Use{id, u});
+    }
+    return *this;
+}
+
+RenderGraph::PassBuilder& RenderGraph::PassBuilder::side_effect() { graph_.passes_[pass_].side_effect = true; return *this; }
+
+RenderGraph::ResourceId RenderGraph::import_image(std::string_view name, VkImage image, VkImageAspectFlags aspect, const ResourceUse& initial, bool persistent) {
+    if (image == VK_NULL_HANDLE) return invalid;
+    return import(Resource{.name = std::string(name), .image = image, .aspect = aspect, .persistent = persistent}, initial);
+}
+
+RenderGraph::ResourceId RenderGraph::import_transient_image(std::string_view name, VkImage image, VkImageAspectFlags aspect, uint32_t memory) {
+    if (image == VK_NULL_HANDLE) return invalid;
+    return import(Resource{.name = std::string(name), .image = image, .aspect = aspect, .persistent = false, .memory = memory}, {});
+}
+
+RenderGraph::ResourceId RenderGraph::import_buffer(std::string_view name, VkBuffer buffer, const ResourceUse& initial) {
+    if (buffer == VK_NULL_HANDLE) return invalid;
+    return import(Resource{.name = std::string(name), .buffer = buffer}, initial);
+}
+
+RenderGraph::ResourceId RenderGraph::import(Resource&& r, const ResourceUse& initial) {
+    if (const ResourceId existing = find(r.name); existing != invalid) {
+        const Resource& e = resources_[existing];
+        if (e.image != r.image || e.buffer != r.buffer) throw std::runtime_error("RenderGraph: resource name imported twice: " + r.name);
+        return existing;
+    }
+    const auto& map = tracked(r);
+    const auto it   = map.find(r.image ? handle_key(r.image) : handle_key(r.buffer));
+    if (r.persistent && it != map.end()) r.state = it->second;
+    else r.state = State{.layout = r.image ? initial.layout : VK_IMAGE_LAYOUT_UNDEFINED, .write_stages = initial.stages, .write_access = initial.access & write_access_bits};
+    resources_.push_back(std::move(r));
+    return static_cast<ResourceId>(resources_.size() - 1u);
+}
+
+RenderGraph::ResourceId RenderGraph::find(std::string_view name) const {
+    for (size_t i = 0; i < resources_.size(); ++i) if (resources_[i].name == name) return static_cast<ResourceId>(i);
+    return invalid;
+}
+
+RenderGraph::PassBuilder RenderGraph::add_pass(std::string_view name, std::function<void(VkCommandBuffer)> record) {
+    passes_.push_back(Pass{.name = std::string(name), .record = std::move(record), .uses = {}});
+    return PassBuilder(*this, static_cast<uint32_t>(passes_.size() - 1u));
+}
+
+void RenderGraph::mark_output(ResourceId id) { if (id < resources_.size()) resources_[id].output = true; }
+
+void RenderGraph::set_final_use(ResourceId id, const ResourceUse& u) {
+    if (id >= resources_.size()) return;
+    Resource& r = resources_[id];
+    r.output = true; r.has_final = true; r.final_use = u;
+}
+
+// Appends the barrier (if any) that `u` needs against the resource's current state, then advances the state.
+// Writes and layout changes wait for the last write and every read since; reads only wait for the last write, and only
+// once per stage/access it has not been made visible to yet.
+void RenderGraph::sync(Resource& r, const ResourceUse& u) {
+    State& s = r.state;
+    if (r.memory != UINT32_MAX) {
+        // Aliased memory: the first use discards and waits for the previous alias; later aliases wait for this one
+        Memory& m = memory_[r.memory];
+        if (!r.entered) { s = State{.layout = VK_IMAGE_LAYOUT_UNDEFINED, .write_stages = m.stages, .write_access = m.write_access}; m = {}; r.entered = true; }
+        m.stages |= u.stages;
+        m.write_access |= u.access & write_access_bits;
+    }
+    const bool writes              = (u.access & write_access_bits) != 0;
+    const bool transition          = r.image && u.layout != s.layout;
+    const VkImageLayout old_layout = s.layout;
+    VkPipelineStageFlags2 src_stages = VK_PIPELINE_STAGE_2_NONE;
+    VkAccessFlags2 src_access        = VK_ACCESS_2_NONE;
+    bool needed                      = false;
+
+    if (writes || transition) {
+        src_stages = s.write_stages | s.read_stages; src_access = s.write_access; needed = transition || src_stages != VK_PIPELINE_STAGE_2_NONE;
+        s.layout         = r.image ? u.layout : s.layout;
+        s.write_stages   = u.stages;
+        s.write_access   = u.access & write_access_bits;
+        s.read_stages    = VK_PIPELINE_STAGE_2_NONE;
+        s.visible_stages = writes ? VK_PIPELINE_STAGE_2_NONE : u.stages; // a transition is visible to the use that requested it
+        s.visible_access = writes ? VK_ACCESS_2_NONE : u.access;
+    } else {
+        const bool hidden = (u.stages & ~s.visible_stages) != 0 || (u.access & ~s.visible_access) != 0;
+        if (hidden && s.write_stages != VK_PIPELINE_STAGE_2_NONE) {
+            src_stages = s.write_stages; src_access = s.write_access; needed = true;
+            s.visible_stages |= u.stages; s.visible_access |= u.access;
+        }
+        s.read_stages |= u.stages;
+    }
+    if (!needed) return;
+
+    if (r.image) {
+        image_barriers_.push_back(VkImageMemoryBarrier2{.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2, .pNext = nullptr, .srcStageMask = src_stages, .srcAccessMask = src_access, .dstStageMask = u.stages, .dstAccessMask = u.access,
+            .oldLayout = old_layout, .newLayout = u.layout, .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED, .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED, .image = r.image,
+            .subresourceRange = {r.aspect, 0u, VK_REMAINING_MIP_LEVELS, 0u, VK_REMAINING_ARRAY_LAYERS}});
+    } else {
+        buffer_barriers_.push_back(VkBufferMemoryBarrier2{.sType = VK_STRUCTURE_TYPE_BUFFER_MEMORY_BARRIER_2, .pNext = nullptr, .srcStageMask = src_stages, .srcAccessMask = src_access, .dstStageMask = u.stages, .dstAccessMask = u.access,
+            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED, .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED, .buffer = r.buffer, .offset = 0u, .size = VK_WHOLE_SIZE});
+    }
+}
+
+void RenderGraph::flush(VkCommandBuffer cmd) {
+    if (image_barriers_.empty() && buffer_barriers_.empty()) return;
+    VkDependencyInfo dep{.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO, .pNext = nullptr, .dependencyFlags = 0u, .memoryBarrierCount = 0u, .pMemoryBarriers = nullptr,
+        .bufferMemoryBarrierCount = static_cast<uint32_t>(buffer_barriers_.size()), .pBufferMemoryBarriers = buffer_barriers_.data(),
+        .imageMemoryBarrierCount = static_cast<uint32_t>(image_barriers_.size()), .pImageMemoryBarriers = image_barriers_.data()};
+    vkCmdPipelineBarrier2(cmd, &dep);
+    stats_.barrier_batches++;
+    stats_.image_barriers += static_cast<uint32_t>(image_barriers_.size());
+    stats_.buffer_barriers += static_cast<uint32_t>(buffer_barriers_.size());
+    image_barriers_.clear();
+    buffer_barriers_.clear();
+}
+
+void RenderGraph::execute(VkCommandBuffer cmd) {
+    stats_ = {};
+    last_passes_.clear();
+
+    // Cull back to front: keep passes with side effects or writing something an output or a kept pass consumes
+    std::vector<uint8_t> needed(resources_.size()), keep(passes_.size());
+    for (size_t i = 0; i < resources_.size(); ++i) needed[i] = resources_[i].output ? 1u : 0u;
+    for (size_t i = passes_.size(); i-- > 0;) {
+        const Pass& p = passes_[i];
+        keep[i] = p.side_effect || std::ranges::any_of(p.uses, [&](const Use& u) { return (u.use.access & write_access_bits) != 0 && needed[u.id]; });
+        if (keep[i]) for (const Use& u : p.uses) needed[u.id] = 1u;
+    }
+
+    for (size_t i = 0; i < passes_.size(); ++i) {
+        Pass& p = passes_[i];
+        PassInfo info{.name = p.name, .culled = !keep[i]};
+        if (!keep[i]) { stats_.culled++; last_passes_.push_back(std::move(info)); continue; }
+        for (const Use& u : p.uses) {
+            Resource& r = resources_[u.id];
+            r.lifetime.first = std::min(r.lifetime.first, static_cast<uint32_t>(i));
+            r.lifetime.last  = std::max(r.lifetime.last, static_cast<uint32_t>(i));
+            sync(r, u.use);
+        }
+        info.image_barriers  = static_cast<uint32_t>(image_barriers_.size());
+        info.buffer_barriers = static_cast<uint32_t>(buffer_barriers_.size());
+        flush(cmd);
+        if (p.record) { gpu_zone z(cmd, p.name); p.record(cmd); }
+        stats_.passes++;
+        last_passes_.push_back(std::move(info));
+    }
+
+    for (Resource& r : resources_) if (r.has_final) { r.lifetime.first = std::min(r.lifetime.first, pass_count()); r.lifetime.last = pass_count(); sync(r, r.final_use); }
+    flush(cmd);
+
+    for (const Resource& r : resources_) if (r.persistent) tracked(r)[r.image ? handle_key(r.image) : handle_key(r.buffer)] = r.state;
+}
+
+void RenderGraph::reset() { resources_.clear(); passes_.clear(); }
+
+VkImageLayout RenderGraph::layout(ResourceId id) const { return id < resources_.size() ? resources_[id].state.layout : VK_IMAGE_LAYOUT_UNDEFINED; }
+
+VkImageLayout RenderGraph::tracked_layout(VkImage image, VkImageLayout fallback) const {
+    const auto it = tracked_images_.find(handle_key(image));
+    return it != tracked_images_.end() ? it->second.layout : fallback;
+}
+
+void RenderGraph::forget_image(VkImage image) { tracked_images_.erase(handle_key(image)); }
+void RenderGraph::forget_buffer(VkBuffer buffer) { tracked_buffers_.erase(handle_key(buffer)); }
+void RenderGraph::forget_memory(uint32_t memory) { memory_.erase(memory); }
+void RenderGraph::forget_all() { tracked_images_.clear(); tracked_buffers_.clear(); memory_.clear(); }
+
+void RenderGraph::imgui_panel_contents() const {
+    ImGui::Text("Passes: %u executed, %u culled", stats_.passes, stats_.culled);
+    ImGui::Text("Barriers: %u image, %u buffer in %u batches", stats_.image_barriers, stats_.buffer_barriers, stats_.barrier_batches);
+    if (last_passes_.empty()) return;
+    if (ImGui::BeginTable("##render_graph", 3, ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV | ImGuiTableFlags_SizingStretchProp)) {
+        ImGui::TableSetupColumn("Pass", ImGuiTableColumnFlags_WidthStretch, 3.0f);
+        ImGui::TableSetupColumn("image");
+        ImGui::TableSetupColumn("buffer");
+        ImGui::TableHeadersRow();
+        for (const auto& p : last_passes_) {
+            ImGui::TableNextRow();
+            ImGui::TableNextColumn();
+            if (p.culled) { ImGui::TextDisabled("%s (culled)", p.name.c_str()); continue; }
+            ImGui::TextUnformatted(p.name.c_str());
+            ImGui::TableNextColumn(); ImGui::Text("%u", p.image_barriers);
+            ImGui::TableNextColumn(); ImGui::Text("%u", p.buffer_barriers);
+        }
+        ImGui::EndTable();
+    }
+    ImGui::TextDisabled("barriers recorded in front of each pass");
+}
+
+} // namespace vv
@@ -0,0 +1,57 @@
+#include "vv_retire.h"
+#include <algorithm>
+#include <imgui.h>
+#include <iterator>
+#include <type_traits>
+#include <vk_mem_alloc.h>
+
+namespace vv {
+
+void RetireQueue::init(VkDevice device, VmaAllocator allocator, VkSemaphore timeline) {
+    device_    = device;
+    allocator_ = allocator;
+    timeline_  = timeline;
+}
+
+void RetireQueue::shutdown() {
+    while (!entries_.empty()) { // callbacks may retire further handles
+        std::vector<Entry> all = std::move(entries_);
+        entries_.clear();
+        for (auto& e : all) destroy(e.handle);
+    }
+    device_ = VK_NULL_HANDLE; allocator_ = nullptr; timeline_ = VK_NULL_HANDLE;
+}
+
+void RetireQueue::retire(VkBuffer buffer, VmaAllocation allocation, uint64_t value) { if (buffer) entries_.push_back(Entry{value, Buffer{buffer, allocation}}); }
+void RetireQueue::retire(VkImage image, VmaAllocation allocation, uint64_t value) { if (image) entries_.push_back(Entry{value, Image{image, allocation}}); }
+void RetireQueue::retire(VkImageView view, uint64_t value) { if (view) entries_.push_back(Entry{value, View{view}}); }
+void RetireQueue::retire(VkPipeline pipeline, uint64_t value) { if (pipeline) entries_.push_back(Entry{value, Pipeline{pipeline}}); }
+void RetireQueue::retire(std::function<void()> fn, uint64_t value) { if (fn) entries_.push_back(Entry{value, std::move(fn)}); }
+
+void RetireQueue::collect() {
+    if (entries_.empty() || !timeline_) return;
+    uint64_t completed = 0;
+    if (vkGetSemaphoreCounterValue(device_, timeline_, &completed) != VK_SUCCESS) return;
+    // Partition first, then move the ready tail out: the predicate only reads, so no entry is moved from twice
+    const auto tail = std::stable_partition(entries_.begin(), entries_.end(), [&](const Entry& e) { return e.value > completed; });
+    std::vector<Entry> ready(std::make_move_iterator(tail), std::make_move_iterator(entries_.end()));
+    entries_.erase(tail, entries_.end());
+    for (auto& e : ready) destroy(e.handle); // after the erase: callbacks may retire further handles
+}
+
+void RetireQueue::destroy(Handle& h) {
+    std::visit([&]<class T>(T& v) {
+        if constexpr (std::is_same_v<T, Buffer>) vmaDestroyBuffer(allocator_, v.buffer, v.allocation);
+        else if constexpr (std::is_same_v<T, Image>) vmaDestroyImage(allocator_, v.image, v.allocation);
+        else if constexpr (std::is_same_v<T, View>) vkDestroyImageView(device_, v.view, nullptr);
+        else if constexpr (std::is_same_v<T, Pipeline>) vkDestroyPipeline(device_, v.pipeline, nullptr);
+        else v();
+    }, h);
+    ++destroyed_;
+}
+
+void RetireQueue::imgui_panel_contents() const {
+    ImGui::Text("Retire queue: %zu pending, %llu destroyed (next frame value %llu)", entries_.size(), static_cast<unsigned long long>(destroyed_), static_cast<unsigned long long>(frame_value()));
+}
+
+} // namespace vv
@@ -0,0 +1,306 @@
+#include "vv_shader.h"
+#include "vv_profiler.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <imgui.h>
+#include <set>
+#include <sstream>
+#include <string_view>
+
+#ifdef VV_HAVE_SHADERC
+#include <shaderc/shaderc.hpp>
+#endif
+
+namespace vv {
+
+namespace {
+    constexpr const char* kBackend =
+#ifdef VV_HAVE_SHADERC
+        "shaderc";
+#else
+        "glslc";
+#endif
+
+    struct StageInfo { const char* ext; VkShaderStageFlagBits stage; };
+    constexpr StageInfo kStages[] = {
+        {"vert", VK_SHADER_STAGE_VERTEX_BIT}, {"frag", VK_SHADER_STAGE_FRAGMENT_BIT}, {"comp", VK_SHADER_STAGE_COMPUTE_BIT},
+        {"geom", VK_SHADER_STAGE_GEOMETRY_BIT}, {"tesc", VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT}, {"tese", VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT},
+        {"task", VK_SHADER_STAGE_TASK_BIT_EXT}, {"mesh", VK_SHADER_STAGE_MESH_BIT_EXT},
+    };
+
+    const StageInfo* stage_info(VkShaderStageFlagBits stage, const std::filesystem::path& path) {
+        const std::string ext = path.extension().string();
+        for (const auto& s : kStages) if (stage ? s.stage == stage : ext == std::string(".") + s.ext) return &s;
+        return nullptr;
+    }
+
+    uint64_t fnv1a(const void* data, size_t n, uint64_t h = 1469598103934665603ull) {
+        const auto* p = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < n; ++i) { h ^= p[i]; h *= 1099511628211ull; }
+        return h;
+    }
+    uint64_t hash_field(std::string_view s, uint64_t h) { h = fnv1a(s.data(), s.size(), h); return fnv1a("", 1, h); } // NUL-separated
+
+    bool read_file(const std::filesystem::path& p, std::string& out) {
+        std::ifstream f(p, std::ios::binary);
+        if (!f) return false;
+        std::ostringstream ss; ss << f.rdbuf(); out = ss.str();
+        return true;
+    }
+
+    std::filesystem::path resolve_include(const std::string& name, const std::filesystem::path& from_dir, const std::vector<std::filesystem::path>& dirs) {
+        std::error_code ec;
+        if (!from_dir.empty() && std::filesystem::exists(from_dir / name, ec)) return from_dir / name;
+        for (const auto& d : dirs) if (std::filesystem::exists(d / name, ec)) return d / name;
+        return {};
+    }
+
+    // Every file reachable through #include, in first-seen order. Conditional includes are followed too: the key only
+    // needs to change whenever the output might.
+    void collect_includes(const std::filesystem::path& file, const std::string& text, const std::vector<std::filesystem::path>& dirs, std::vector<std::pair<std::filesystem::path, std::string>>& out, std::set<std::filesystem::path>& seen) {
+        std::istringstream lines(text);
+        for (std::string line; std::getline(lines, line);) {
+            const size_t hash = line.find_first_not_of(" \t");
+            if (hash == std::string::npos || line.compare(hash, 8, "#include") != 0) continue;
+            const size_t open = line.find_first_of("\"<", hash + 8);
+            const size_t close = open == std::string::npos ? std::string::npos : line.find_first_of("\">", open + 1);
+            if (close == std::string::npos) continue;
+            const std::filesystem::path inc = resolve_include(line.substr(open + 1, close - open - 1), file.parent_path(), dirs);
+            if (inc.empty() || !seen.insert(inc.lexically_normal()).second) continue;
+            std::string content;
+            if (!read_file(inc, content)) continue;
+            out.emplace_back(inc, content);
+            collect_includes(inc, out.back().second, dirs, out, seen);
+        }
+    }
+
+    bool read_spirv(const std::filesystem::path& p, std::vector<uint32_t>& out) {
+        std::ifstream f(p, std::ios::binary | std::ios::ate);
+        if (!f) return false;
+        const auto size = static_cast<size_t>(f.tellg());
+        if (size == 0 || size % 4 != 0) return false;
+        out.resize(size / 4); f.seekg(0);
+        return static_cast<bool>(f.read(reinterpret_cast<char*>(out.data()), static_cast<std::streamsize>(size)));
+    }
+
+    void write_spirv(const std::filesystem::path& p, const std::vector<uint32_t>& spirv) {
+        std::error_code ec;
+        std::filesystem::path tmp = p; tmp += ".tmp" + std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+        {
+            std::ofstream f(tmp, std::ios::binary | std::ios::trunc);
+            if (!f.write(reinterpret_cast<const char*>(spirv.data()), static_cast<std::streamsize>(spirv.size() * 4))) return;
+        }
+        std::filesystem::rename(tmp, p, ec);
+        if (ec) std::filesystem::remove(tmp, ec);
+    }
+
+#ifdef VV_HAVE_SHADERC
+    class Includer final : public shaderc::CompileOptions::IncluderInterface {
+    public:
+        explicit Includer(std::vector<std::filesystem::path> dirs) : dirs_(std::move(dirs)) {}
+        shaderc_include_result* GetInclude(const char* requested, shaderc_include_type type, const char* requesting, size_t) override {
+            auto* r = new Result{};
+            const std::filesystem::path from = type == shaderc_include_type_relative ? std::filesystem::path(requesting).parent_path() : std::filesystem::path{};
+            const std::filesystem::path found = resolve_include(requested, from, dirs_);
+            if (!found.empty() && read_file(found, r->content)) r->name = found.string();
+            else r->content = std::string("cannot open include file ") + requested; // empty source_name reports an error
+            r->result = shaderc_include_result{r->name.c_str(), r->name.size(), r->content.c_str(), r->content.size(), r};
+            return &r->result;
+        }
+        void ReleaseInclude(shaderc_include_result* data) override { delete static_cast<Result*>(data->user_data); }
+
+    private:
+        struct Result { std::string name, content; shaderc_include_result result{}; };
+        std::vector<std::filesystem::path> dirs_;
+    };
+
+    shaderc_shader_kind shaderc_kind(VkShaderStageFlagBits stage) {
+        switch (stage) {
+        case VK_SHADER_STAGE_VERTEX_BIT: return shaderc_vertex_shader;
+        case VK_SHADER_STAGE_FRAGMENT_BIT: return shaderc_fragment_shader;
+        case VK_SHADER_STAGE_GEOMETRY_BIT: return shaderc_geometry_shader;
+        case VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT: return shaderc_tess_control_shader;
+        case VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT: return shaderc_tess_evaluation_shader;
+        case VK_SHADER_STAGE_TASK_BIT_EXT: return shaderc_task_shader;
+        case VK_SHADER_STAGE_MESH_BIT_EXT: return shaderc_mesh_shader;
+        default: return shaderc_compute_shader;
+        }
+    }
+
+    bool compile_glsl(const ShaderRequest& req, const StageInfo& stage, const std::string& source, const std::vector<std::filesystem::path>& dirs, std::vector<uint32_t>& spirv, std::string& log) {
+        thread_local shaderc::Compiler compiler;
+        shaderc::CompileOptions opt;
+        opt.SetTargetEnvironment(shaderc_target_env_vulkan, shaderc_env_version_vulkan_1_3);
+        opt.SetOptimizationLevel(shaderc_optimization_level_performance);
+        for (const auto& [name, value] : req.defines) opt.AddMacroDefinition(name, value);
+        opt.SetIncluder(std::make_unique<Includer>(dirs));
+        const shaderc::SpvCompilationResult res = compiler.CompileGlslToSpv(source, shaderc_kind(stage.stage), req.path.string().c_str(), req.entry.c_str(), opt);
+        log = res.GetErrorMessage();
+        if (res.GetCompilationStatus() != shaderc_compilation_status_success) return false;
+        spirv.assign(res.cbegin(), res.cend());
+        return true;
+    }
+#else
+    bool compile_glsl(const ShaderRequest& req, const StageInfo& stage, const std::string&, const std::vector<std::filesystem::path>& dirs, std::vector<uint32_t>& spirv, std::string& log) {
+#ifdef VV_GLSLC_EXECUTABLE
+        const std::string glslc = VV_GLSLC_EXECUTABLE;
+#else
+        const std::string glslc = "glslc";
+#endif
+        const std::filesystem::path out = std::filesystem::temp_directory_path() / ("vv_" + std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id())) + ".spv");
+        std::filesystem::path err = out; err += ".log";
+        std::string cmd = "\"" + glslc + "\" -fshader-stage=" + stage.ext + " --target-env=vulkan1.3 -O -fentry-point=" + req.entry;
+        for (const auto& [name, value] : req.defines) cmd += " \"-D" + name + (value.empty() ? "" : "=" + value) + "\"";
+        cmd += " \"-I" + req.path.parent_path().string() + "\"";
+        for (const auto& d : dirs) cmd += " \"-I" + d.string() + "\"";
+        cmd += " \"" + req.path.string() + "\" -o \"" + out.string() + "\" 2> \"" + err.string() + "\"";
+#ifdef _WIN32
+        cmd = "\"" + cmd + "\""; // cmd.exe strips the outer pair of quotes
+#endif
+        const int rc = std::system(cmd.c_str());
+        read_file(err, log);
+        std::error_code ec;
+        const bool ok = rc == 0 && read_spirv(out, spirv);
+        std::filesystem::remove(out, ec); std::filesystem::remove(err, ec);
+        if (!ok && log.empty()) log = "glslc failed (exit code " + std::to_string(rc) + ")";
+        return ok;
+    }
+#endif
+} // namespace
+
+bool ShaderService::init(VkDevice device, const std::filesystem::path& cache_dir, uint32_t workers) {
+    device_ = device; cache_dir_ = cache_dir; stop_ = false;
+    std::error_code ec;
+    std::filesystem::create_directories(cache_dir_, ec); // without it every shader just compiles each run
+    for (uint32_t i = 0; i < std::max(1u, workers); ++i) threads_.emplace_back([this, i] { worker_main(i); });
+    return true;
+}
+
+void ShaderService::shutdown() {
+    { std::lock_guard lock(mutex_); stop_ = true; }
+    cv_.notify_all();
+    for (auto& t : threads_) if (t.joinable()) t.join();
+    threads_.clear();
+    for (auto& [hash, m] : modules_) vkDestroyShaderModule(device_, m.module, nullptr);
+    modules_.clear();
+    module_hashes_.clear();
+    device_ = VK_NULL_HANDLE;
+}
+
+void ShaderService::add_include_dir(const std::filesystem::path& dir) {
+    std::lock_guard lock(mutex_);
+    if (std::ranges::find(include_dirs_, dir) == include_dirs_.end()) include_dirs_.push_back(dir);
+}
+
+ShaderFuture ShaderService::compile(ShaderRequest request) {
+    auto promise = std::make_shared<std::promise<CompiledShader>>();
+    ShaderFuture future = promise->get_future().share();
+    {
+        std::lock_guard lock(mutex_);
+        stats_.requests++;
+        jobs_.emplace_back([this, promise, request = std::move(request)] { promise->set_value(run(request)); });
+    }
+    cv_.notify_one();
+    return future;
+}
+
+void ShaderService::worker_main(uint32_t index) {
+    CpuTracer::set_thread_name("shader worker " + std::to_string(index));
+    for (;;) {
+        std::function<void()> job;
+        {
+            std::unique_lock lock(mutex_);
+            cv_.wait(lock, [&] { return stop_ || !jobs_.empty(); });
+            if (jobs_.empty()) return; // stop_ with nothing left: queued requests are always answered
+            job = std::move(jobs_.front()); jobs_.pop_front();
+        }
+        job();
+    }
+}
+
+CompiledShader ShaderService::run(const ShaderRequest& request) {
+    cpu_zone z("compile_shader");
+    CompiledShader out{};
+    const StageInfo* stage = stage_info(request.stage, request.path);
+    if (!stage) { out.log = "unknown shader stage for " + request.path.string(); std::lock_guard lock(mutex_); stats_.failures++; return out; }
+    std::string source;
+    if (!read_file(request.path, source)) { out.log = "cannot open " + request.path.string(); std::lock_guard lock(mutex_); stats_.failures++; return out; }
+    std::vector<std::filesystem::path> dirs;
+    { std::lock_guard lock(mutex_); dirs = include_dirs_; }
+
+    // Key: backend, stage, entry, defines, then the source and each include with its path
+    std::vector<std::pair<std::filesystem::path, std::string>> includes;
+    std::set<std::filesystem::path> seen{request.path.lexically_normal()};
+    collect_includes(request.path, source, dirs, includes, seen);
+    uint64_t key = hash_field(kBackend, 1469598103934665603ull);
+    key = hash_field(stage->ext, key); key = hash_field(request.entry, key);
+    for (const auto& [name, value] : request.defines) { key = hash_field(name, key); key = hash_field(value, key); }
+    key = hash_field(source, key);
+    for (const auto& [path, text] : includes) { key = hash_field(path.generic_string(), key); key = hash_field(text, key); }
+    char name[32]; std::snprintf(name, sizeof(name), "%016llx.spv", static_cast<unsigned long long>(key));
+    const std::filesystem::path cached = cache_dir_ / name;
+
+    std::vector<uint32_t> spirv;
+    if (read_spirv(cached, spirv)) {
+        out.cached = true;
+        std::lock_guard lock(mutex_); stats_.disk_hits++;
+    } else {
+        const auto t0 = std::chrono::steady_clock::now();
+        const bool ok = compile_glsl(request, *stage, source, dirs, spirv, out.log);
+        const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - t0).count();
+        { std::lock_guard lock(mutex_); stats_.compiles++; stats_.compile_ms += ms; if (!ok) stats_.failures++; }
+        if (!ok) return out;
+        write_spirv(cached, spirv);
+    }
+    out.module = module_for(spirv);
+    if (!out.module) out.log += "vkCreateShaderModule failed";
+    return out;
+}
+
+CompiledShader ShaderService::load(std::span<const uint32_t> spirv) {
+    CompiledShader out{};
+    { std::lock_guard lock(mutex_); stats_.requests++; }
+    out.module = module_for(spirv);
+    if (!out.module) out.log = "vkCreateShaderModule failed";
+    return out;
+}
+
+VkShaderModule ShaderService::module_for(std::span<const uint32_t> spirv) {
+    const uint64_t h = fnv1a(spirv.data(), spirv.size() * 4);
+    {
+        std::lock_guard lock(mutex_);
+        if (auto it = modules_.find(h); it != modules_.end()) { it->second.refs++; return it->second.module; }
+    }
+    VkShaderModuleCreateInfo ci{.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO, .pNext = nullptr, .flags = 0u, .codeSize = spirv.size() * 4, .pCode = spirv.data()};
+    VkShaderModule m{VK_NULL_HANDLE};
+    if (vkCreateShaderModule(device_, &ci, nullptr, &m) != VK_SUCCESS) return VK_NULL_HANDLE;
+    std::lock_guard lock(mutex_);
+    auto [it, inserted] = modules_.try_emplace(h, Module{m, 0u});
+    if (!inserted) vkDestroyShaderModule(device_, m, nullptr); // another worker got there first
+    else { module_hashes_.emplace(m, h); stats_.modules++; }
+    it->second.refs++;
+    return it->second.module;
+}
+
+void ShaderService::release(VkShaderModule module) {
+    if (!module) return;
+    std::lock_guard lock(mutex_);
+    const auto h = module_hashes_.find(module);
+    if (h == module_hashes_.end()) return;
+    const auto it = modules_.find(h->second);
+    if (--it->second.refs > 0) return;
+    vkDestroyShaderModule(device_, module, nullptr);
+    modules_.erase(it);
+    module_hashes_.erase(h);
+    stats_.modules--;
+}
+
+void ShaderService::imgui_panel_contents() const {
+    const Stats s = stats();
+    ImGui::Text("Shaders (%s): %llu requests, %llu from disk cache, %llu compiled (%.1f ms), %llu failed, %llu modules", kBackend, static_cast<unsigned long long>(s.requests), static_cast<unsigned long long>(s.disk_hits),
+        static_cast<unsigned long long>(s.compiles), s.compile_ms, static_cast<unsigned long long>(s.failures), static_cast<unsigned long long>(s.modules));
+}
+
+} // namespace vv
@@ -0,0 +1,248 @@
+#include "vv_tonemap.h"
+#include "vv_pipeline_cache.h"
+#include "vv_shader.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <imgui.h>
+#include <vk_mem_alloc.h>
+
+namespace vv {
+
+static constexpr uint32_t kBins = 256; // VV_TONEMAP_BINS
+static constexpr uint32_t kAuto = 4u, kDither = 8u, kEncodeSrgb = 16u;
+
+// Mirrors VvTonemapPush in vv_tonemap.glsl (std430)
+struct ToneMapper::Push {
+    uint32_t extent[2];
+    float min_log2;
+    float log2_range;
+    float dt;
+    float adaptation;
+    float exposure_ev;
+    uint32_t flags;
+    float uv_scale[2];
+    float uv_max[2];
+    uint32_t frame;
+};
+
+#ifdef VV_HAVE_BUILTIN_SHADERS
+// Generated at build time from include/shaders (cmake/vv_embed_spirv.cmake)
+#include "vv_tonemap_histogram.comp.inc"
+#include "vv_tonemap_exposure.comp.inc"
+#include "vv_fullscreen.vert.inc"
+#include "vv_tonemap.frag.inc"
+#endif
+
+static bool is_srgb(VkFormat f) { return f == VK_FORMAT_B8G8R8A8_SRGB || f == VK_FORMAT_R8G8B8A8_SRGB || f == VK_FORMAT_A8B8G8R8_SRGB_PACK32; }
+
+bool ToneMapper::init(VkDevice device, VmaAllocator allocator, ShaderService& shaders, PipelineCache& cache, const std::filesystem::path& shader_dir, VkFormat target_format, uint32_t frames_in_flight) {
+    device_ = device; allocator_ = allocator; target_format_ = target_format;
+
+    const VkSamplerCreateInfo sci{.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO, .magFilter = VK_FILTER_LINEAR, .minFilter = VK_FILTER_LINEAR, .mipmapMode = VK_SAMPLER_MIPMAP_MODE_NEAREST,
+        .addressModeU = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE, .addressModeV = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE, .addressModeW = VK_SAMPLER_ADDRESS_MODE_CLAMP_TO_EDGE, .maxLod = 0.0f};
+    if (vkCreateSampler(device_, &sci, nullptr, &sampler_) != VK_SUCCESS) return false;
+
+    constexpr VkShaderStageFlags stages = VK_SHADER_STAGE_COMPUTE_BIT | VK_SHADER_STAGE_FRAGMENT_BIT;
+    const std::array<VkDescriptorSetLayoutBinding, 3> bindings{{
+        {.binding = 0u, .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, .descriptorCount = 1u, .stageFlags = stages, .pImmutableSamplers = nullptr},
+        {.binding = 1u, .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, .descriptorCount = 1u, .stageFlags = stages, .pImmutableSamplers = nullptr},
+        {.binding = 2u, .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, .descriptorCount = 1u, .stageFlags = stages, .pImmutableSamplers = nullptr},
+    }};
+    const VkDescriptorSetLayoutCreateInfo lci{.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO, .pNext = nullptr, .flags = 0u, .bindingCount = 3u, .pBindings = bindings.data()};
+    if (vkCreateDescriptorSetLayout(device_, &lci, nullptr, &set_layout_) != VK_SUCCESS) return false;
+    const VkPushConstantRange pcr{.stageFlags = stages, .offset = 0u, .size = sizeof(Push)};
+    const VkPipelineLayoutCreateInfo pli{.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO, .pNext = nullptr, .flags = 0u, .setLayoutCount = 1u, .pSetLayouts = &set_layout_, .pushConstantRangeCount = 1u, .pPushConstantRanges = &pcr};
+    if (vkCreatePipelineLayout(device_, &pli, nullptr, &layout_) != VK_SUCCESS) return false;
+
+    // Rewritten every frame, so one set per frame slot is enough and no frame in flight ever sees an update
+    const std::array<VkDescriptorPoolSize, 2> sizes{{{VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, frames_in_flight}, {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 2u * frames_in_flight}}};
+    const VkDescriptorPoolCreateInfo pci{.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO, .pNext = nullptr, .flags = 0u, .maxSets = frames_in_flight, .poolSizeCount = 2u, .pPoolSizes = sizes.data()};
+    if (vkCreateDescriptorPool(device_, &pci, nullptr, &pool_) != VK_SUCCESS) return false;
+    sets_.resize(frames_in_flight);
+    const std::vector<VkDescriptorSetLayout> layouts(frames_in_flight, set_layout_);
+    const VkDescriptorSetAllocateInfo ai{.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO, .pNext = nullptr, .descriptorPool = pool_, .descriptorSetCount = frames_in_flight, .pSetLayouts = layouts.data()};
+    if (vkAllocateDescriptorSets(device_, &ai, sets_.data()) != VK_SUCCESS) return false;
+
+    VkBufferCreateInfo bci{.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO, .pNext = nullptr, .flags = 0u, .size = kBins * sizeof(uint32_t), .usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT | VK_BUFFER_USAGE_TRANSFER_DST_BIT,
+        .sharingMode = VK_SHARING_MODE_EXCLUSIVE, .queueFamilyIndexCount = 0u, .pQueueFamilyIndices = nullptr};
+    VmaAllocationCreateInfo aci{}; aci.usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE; // shared-memory atomics land here once per workgroup and bin
+    if (vmaCreateBuffer(allocator_, &bci, &aci, &histogram_, &histogram_alloc_, nullptr) != VK_SUCCESS) return false;
+    bci.size  = 4u * sizeof(float);
+    bci.usage = VK_BUFFER_USAGE_STORAGE_BUFFER_BIT;
+    aci.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_RANDOM_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT;
+    VmaAllocationInfo info{};
+    if (vmaCreateBuffer(allocator_, &bci, &aci, &exposure_, &exposure_alloc_, &info) != VK_SUCCESS) return false;
+    exposure_mapped_ = info.pMappedData;
+    std::memset(exposure_mapped_, 0, 4u * sizeof(float)); // valid = 0: the first reduction takes its average as is
+    vmaFlushAllocation(allocator_, exposure_alloc_, 0, VK_WHOLE_SIZE);
+
+    return build_pipelines(shaders, cache, shader_dir);
+}
+
+bool ToneMapper::reload(ShaderService& shaders, PipelineCache& cache, const std::filesystem::path& shader_dir) {
+    return layout_ && build_pipelines(shaders, cache, shader_dir);
+}
+
+bool ToneMapper::build_pipelines(ShaderService& shaders, PipelineCache& cache, const std::filesystem::path& shader_dir) {
+    std::array<CompiledShader, 4> s{}; // histogram, exposure, vert, frag
+    if (shader_dir.empty()) {
+#ifdef VV_HAVE_BUILTIN_SHADERS
+        s = {shaders.load(vv_tonemap_histogram_comp_spv), shaders.load(vv_tonemap_exposure_comp_spv), shaders.load(vv_fullscreen_vert_spv), shaders.load(vv_tonemap_frag_spv)};
+#endif
+    } else {
+        s = {shaders.compile_now({.path = shader_dir / "vv_tonemap_histogram.comp"}), shaders.compile_now({.path = shader_dir / "vv_tonemap_exposure.comp"}),
+             shaders.compile_now({.path = shader_dir / "vv_fullscreen.vert"}), shaders.compile_now({.path = shader_dir / "vv_tonemap.frag"})};
+    }
+    const bool compiled = std::ranges::all_of(s, [](const CompiledShader& c) { return c.module != VK_NULL_HANDLE; });
+
+    auto compute = [&](VkShaderModule module, VkPipeline* out) {
+        const VkComputePipelineCreateInfo ci{.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO, .pNext = nullptr, .flags = 0u,
+            .stage = {.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO, .pNext = nullptr, .flags = 0u, .stage = VK_SHADER_STAGE_COMPUTE_BIT, .module = module, .pName = "main", .pSpecializationInfo = nullptr},
+            .layout = layout_, .basePipelineHandle = VK_NULL_HANDLE, .basePipelineIndex = -1};
+        return cache.create(ci, out) == VK_SUCCESS;
+    };
+    const std::array<VkPipelineShaderStageCreateInfo, 2> st{{
+        {.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO, .pNext = nullptr, .flags = 0u, .stage = VK_SHADER_STAGE_VERTEX_BIT, .module = s[2].module, .pName = "main", .pSpecializationInfo = nullptr},
+        {.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO, .pNext = nullptr, .flags = 0u, .stage = VK_SHADER_STAGE_FRAGMENT_BIT, .module = s[3].module, .pName = "main", .pSpecializationInfo = nullptr},
+    }};
+    const VkPipelineVertexInputStateCreateInfo vi{.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO};
+    const VkPipelineInputAssemblyStateCreateInfo ia{.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO, .topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST};
+    const VkPipelineViewportStateCreateInfo vp{.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO, .viewportCount = 1u, .scissorCount = 1u};
+    const VkPipelineRasterizationStateCreateInfo rs{.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO, .polygonMode = VK_POLYGON_MODE_FILL, .cullMode = VK_CULL_MODE_NONE, .frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE, .lineWidth = 1.0f};
+    const VkPipelineMultisampleStateCreateInfo ms{.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO, .rasterizationSamples = VK_SAMPLE_COUNT_1_BIT};
+    const VkPipelineColorBlendAttachmentState ba{.blendEnable = VK_FALSE, .colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT};
+    const VkPipelineColorBlendStateCreateInfo cb{.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO, .attachmentCount = 1u, .pAttachments = &ba};
+    const std::array<VkDynamicState, 2> dyn{VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR};
+    const VkPipelineDynamicStateCreateInfo ds{.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO, .dynamicStateCount = 2u, .pDynamicStates = dyn.data()};
+    const VkPipelineRenderingCreateInfo ri{.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO, .colorAttachmentCount = 1u, .pColorAttachmentFormats = &target_format_};
+    const VkGraphicsPipelineCreateInfo gci{.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO, .pNext = &ri, .stageCount = 2u, .pStages = st.data(), .pVertexInputState = &vi, .pInputAssemblyState = &ia,
+        .pViewportState = &vp, .pRasterizationState = &rs, .pMultisampleState = &ms, .pColorBlendState = &cb, .pDynamicState = &ds, .layout = layout_};
+
+    std::array<VkPipeline, 3> p{}; // histogram, exposure, present
+    const bool ok = compiled && compute(s[0].module, &p[0]) && compute(s[1].module, &p[1]) && cache.create(gci, &p[2]) == VK_SUCCESS;
+    for (const CompiledShader& c : s) shaders.release(c.module); // the pipelines are built
+    if (!ok) {
+        for (VkPipeline q : p) if (q) vkDestroyPipeline(device_, q, nullptr);
+        return false;
+    }
+    for (VkPipeline q : {histogram_pipeline_, exposure_pipeline_, present_pipeline_}) if (q) vkDestroyPipeline(device_, q, nullptr);
+    histogram_pipeline_ = p[0]; exposure_pipeline_ = p[1]; present_pipeline_ = p[2];
+    return true;
+}
+
+void ToneMapper::shutdown() {
+    if (present_pipeline_) vkDestroyPipeline(device_, present_pipeline_, nullptr);
+    if (exposure_pipeline_) vkDestroyPipeline(device_, exposure_pipeline_, nullptr);
+    if (histogram_pipeline_) vkDestroyPipeline(device_, histogram_pipeline_, nullptr);
+    if (pool_) vkDestroyDescriptorPool(device_, pool_, nullptr); // frees sets_
+    if (layout_) vkDestroyPipelineLayout(device_, layout_, nullptr);
+    if (set_layout_) vkDestroyDescriptorSetLayout(device_, set_layout_, nullptr);
+    if (sampler_) vkDestroySampler(device_, sampler_, nullptr);
+    if (histogram_) vmaDestroyBuffer(allocator_, histogram_, histogram_alloc_);
+    if (exposure_) vmaDestroyBuffer(allocator_, exposure_, exposure_alloc_);
+    present_pipeline_ = exposure_pipeline_ = histogram_pipeline_ = VK_NULL_HANDLE;
+    pool_ = VK_NULL_HANDLE; layout_ = VK_NULL_HANDLE; set_layout_ = VK_NULL_HANDLE; sampler_ = VK_NULL_HANDLE; sets_.clear();
+    histogram_ = exposure_ = VK_NULL_HANDLE; histogram_alloc_ = exposure_alloc_ = nullptr; exposure_mapped_ = nullptr;
+    histogram_cleared_ = false;
+    device_ = VK_NULL_HANDLE; allocator_ = nullptr;
+}
+
+void ToneMapper::prepare(uint32_t slot, VkImageView source, VkExtent3D source_size, VkExtent2D render_extent, double dt_sec) {
+    slot_          = slot % static_cast<uint32_t>(sets_.size());
+    source_size_   = source_size;
+    render_extent_ = {std::min(render_extent.width, source_size.width), std::min(render_extent.height, source_size.height)};
+    dt_            = static_cast<float>(dt_sec);
+    frame_++;
+
+    const VkDescriptorImageInfo ii{.sampler = sampler_, .imageView = source, .imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL};
+    const std::array<VkDescriptorBufferInfo, 2> bi{{{histogram_, 0u, VK_WHOLE_SIZE}, {exposure_, 0u, VK_WHOLE_SIZE}}};
+    const std::array<VkWriteDescriptorSet, 3> w{{
+        {.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, .dstSet = sets_[slot_], .dstBinding = 0u, .descriptorCount = 1u, .descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, .pImageInfo = &ii},
+        {.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, .dstSet = sets_[slot_], .dstBinding = 1u, .descriptorCount = 1u, .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, .pBufferInfo = &bi[0]},
+        {.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET, .dstSet = sets_[slot_], .dstBinding = 2u, .descriptorCount = 1u, .descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, .pBufferInfo = &bi[1]},
+    }};
+    vkUpdateDescriptorSets(device_, 3u, w.data(), 0u, nullptr);
+}
+
+ToneMapper::Push ToneMapper::push() const {
+    static_assert(sizeof(Push) == 52, "must match VvTonemapPush");
+    const float w = static_cast<float>(std::max(1u, source_size_.width)), h = static_cast<float>(std::max(1u, source_size_.height));
+    Push p{};
+    p.extent[0]   = render_extent_.width;
+    p.extent[1]   = render_extent_.height;
+    p.min_log2    = settings_.min_log2_luminance;
+    p.log2_range  = std::max(settings_.max_log2_luminance - settings_.min_log2_luminance, 0.01f);
+    p.dt          = dt_;
+    p.adaptation  = settings_.adaptation_rate;
+    p.exposure_ev = settings_.exposure_ev;
+    p.flags       = static_cast<uint32_t>(settings_.curve) | (settings_.auto_exposure ? kAuto : 0u) | (settings_.dither ? kDither : 0u) | (is_srgb(target_format_) ? 0u : kEncodeSrgb);
+    p.uv_scale[0] = static_cast<float>(render_extent_.width) / w;
+    p.uv_scale[1] = static_cast<float>(render_extent_.height) / h;
+    p.uv_max[0]   = (static_cast<float>(render_extent_.width) - 0.5f) / w;
+    p.uv_max[1]   = (static_cast<float>(render_extent_.height) - 0.5f) / h;
+    p.frame       = frame_;
+    return p;
+}
+
+void ToneMapper::record_histogram(VkCommandBuffer cmd) {
+    if (!histogram_cleared_) {
+        // Afterwards the reduction leaves it zeroed for the next frame
+        vkCmdFillBuffer(cmd, histogram_, 0u, VK_WHOLE_SIZE, 0u);
+        const VkMemoryBarrier2 mb{.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER_2, .pNext = nullptr, .srcStageMask = VK_PIPELINE_STAGE_2_CLEAR_BIT, .srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT,
+            .dstStageMask = VK_PIPELINE_STAGE_2_COMPUTE_SHADER_BIT, .dstAccessMask = VK_ACCESS_2_SHADER_STORAGE_READ_BIT | VK_ACCESS_2_SHADER_STORAGE_WRITE_BIT};
+        const VkDependencyInfo dep{.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO, .memoryBarrierCount = 1u, .pMemoryBarriers = &mb};
+        vkCmdPipelineBarrier2(cmd, &dep);
+        histogram_cleared_ = true;
+    }
+    const Push p = push();
+    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, histogram_pipeline_);
+    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, layout_, 0u, 1u, &sets_[slot_], 0u, nullptr);
+    vkCmdPushConstants(cmd, layout_, VK_SHADER_STAGE_COMPUTE_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0u, sizeof(Push), &p);
+    // 16x16 groups, each thread reading one texel of a 2x2 block
+    vkCmdDispatch(cmd, (render_extent_.width + 31u) / 32u, (render_extent_.height + 31u) / 32u, 1u);
+}
+
+void ToneMapper::record_exposure(VkCommandBuffer cmd) const {
+    const Push p = push();
+    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, exposure_pipeline_);
+    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_COMPUTE, layout_, 0u, 1u, &sets_[slot_], 0u, nullptr);
+    vkCmdPushConstants(cmd, layout_, VK_SHADER_STAGE_COMPUTE_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0u, sizeof(Push), &p);
+    vkCmdDispatch(cmd, 1u, 1u, 1u);
+}
+
+void ToneMapper::record_present(VkCommandBuffer cmd, VkImageView target, VkExtent2D target_extent) const {
+    const VkRenderingAttachmentInfo ca{.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO, .pNext = nullptr, .imageView = target, .imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+        .resolveMode = VK_RESOLVE_MODE_NONE, .resolveImageView = VK_NULL_HANDLE, .resolveImageLayout = VK_IMAGE_LAYOUT_UNDEFINED, .loadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE, .storeOp = VK_ATTACHMENT_STORE_OP_STORE, .clearValue = {}};
+    const VkRenderingInfo ri{.sType = VK_STRUCTURE_TYPE_RENDERING_INFO, .renderArea = {{0, 0}, target_extent}, .layerCount = 1u, .colorAttachmentCount = 1u, .pColorAttachments = &ca};
+    vkCmdBeginRendering(cmd, &ri);
+    const VkViewport viewport{0.0f, 0.0f, static_cast<float>(target_extent.width), static_cast<float>(target_extent.height), 0.0f, 1.0f};
+    const VkRect2D scissor{{0, 0}, target_extent};
+    vkCmdSetViewport(cmd, 0u, 1u, &viewport);
+    vkCmdSetScissor(cmd, 0u, 1u, &scissor);
+    const Push p = push();
+    vkCmdBindPipeline(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, present_pipeline_);
+    vkCmdBindDescriptorSets(cmd, VK_PIPELINE_BIND_POINT_GRAPHICS, layout_, 0u, 1u, &sets_[slot_], 0u, nullptr);
+    vkCmdPushConstants(cmd, layout_, VK_SHADER_STAGE_COMPUTE_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, 0u, sizeof(Push), &p);
+    vkCmdDraw(cmd, 3u, 1u, 0u, 0u);
+    vkCmdEndRendering(cmd);
+}
+
+void ToneMapper::imgui_panel_contents() {
+    int curve = static_cast<int>(settings_.curve);
+    if (ImGui::Combo("Curve", &curve, "None\0Reinhard\0ACES\0")) settings_.curve = static_cast<ToneCurve>(curve);
+    ImGui::Checkbox("Auto exposure", &settings_.auto_exposure);
+    ImGui::SliderFloat(settings_.auto_exposure ? "Compensation (EV)" : "Exposure (EV)", &settings_.exposure_ev, -8.0f, 8.0f, "%.2f");
+    if (settings_.auto_exposure) {
+        ImGui::SliderFloat("Adaptation (1/s)", &settings_.adaptation_rate, 0.1f, 10.0f, "%.2f");
+        ImGui::DragFloatRange2("Histogram (log2)", &settings_.min_log2_luminance, &settings_.max_log2_luminance, 0.1f, -20.0f, 20.0f, "%.1f");
+        // Written by the GPU a frame or more ago; display only
+        vmaInvalidateAllocation(allocator_, exposure_alloc_, 0, VK_WHOLE_SIZE);
+        float values[2]; std::memcpy(values, exposure_mapped_, sizeof(values));
+        ImGui::Text("Adapted luminance: %.4f (x%.3f exposure)", std::exp2(values[0]), values[1]);
+    }
+    ImGui::Checkbox("Dither", &settings_.dither);
+}
+
+} // namespace vv
@@ -0,0 +1,212 @@
+#include "vv_upload.h"
+#include "vv_buffer.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <imgui.h>
+#include <stdexcept>
+#include <vk_mem_alloc.h>
+
+namespace vv {
+
+static constexpr VkDeviceSize kAlign = 16; // covers vkCmdCopyBufferToImage's texel-size and 4-byte offset rules
+
+bool UploadService::init(VkDevice device, VmaAllocator allocator, VkQueue queue, uint32_t queue_family, uint32_t graphics_family, VkDeviceSize ring_bytes) {
+    device_ = device; allocator_ = allocator; queue_ = queue; queue_family_ = queue_family; graphics_family_ = graphics_family;
+    VkCommandPoolCreateInfo pci{.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO, .pNext = nullptr, .flags = VK_COMMAND_POOL_CREATE_RESET_COMMAND_BUFFER_BIT | VK_COMMAND_POOL_CREATE_TRANSIENT_BIT, .queueFamilyIndex = queue_family_};
+    if (vkCreateCommandPool(device_, &pci, nullptr, &pool_) != VK_SUCCESS) return false;
+    VkSemaphoreTypeCreateInfo tci{.sType = VK_STRUCTURE_TYPE_SEMAPHORE_TYPE_CREATE_INFO, .pNext = nullptr, .semaphoreType = VK_SEMAPHORE_TYPE_TIMELINE, .initialValue = 0};
+    VkSemaphoreCreateInfo sci{.sType = VK_STRUCTURE_TYPE_SEMAPHORE_CREATE_INFO, .pNext = &tci, .flags = 0u};
+    if (vkCreateSemaphore(device_, &sci, nullptr, &timeline_) != VK_SUCCESS) return false;
+
+    ring_size_ = ring_bytes;
+    VkBufferCreateInfo bci{.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO, .pNext = nullptr, .flags = 0u, .size = ring_size_, .usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT, .sharingMode = VK_SHARING_MODE_EXCLUSIVE, .queueFamilyIndexCount = 0u, .pQueueFamilyIndices = nullptr};
+    VmaAllocationCreateInfo aci{}; aci.usage = VMA_MEMORY_USAGE_AUTO_PREFER_HOST; aci.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT;
+    VmaAllocationInfo info{};
+    if (vmaCreateBuffer(allocator_, &bci, &aci, &ring_, &ring_alloc_, &info) != VK_SUCCESS) return false;
+    ring_mapped_ = static_cast<std::byte*>(info.pMappedData);
+
+    // ReBAR: a device-local, host-visible heap larger than the legacy 256 MiB BAR window
+    const VkPhysicalDeviceMemoryProperties* mp = nullptr;
+    vmaGetMemoryProperties(allocator_, &mp);
+    constexpr VkMemoryPropertyFlags want = VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT;
+    for (uint32_t i = 0; i < mp->memoryTypeCount; ++i)
+        if ((mp->memoryTypes[i].propertyFlags & want) == want && mp->memoryHeaps[mp->memoryTypes[i].heapIndex].size > (256ull << 20)) rebar_ = true;
+    return true;
+}
+
+void UploadService::shutdown() {
+    buffer_copies_.clear(); image_copies_.clear(); in_flight_.clear(); free_cmds_.clear();
+    if (ring_) { vmaDestroyBuffer(allocator_, ring_, ring_alloc_); ring_ = VK_NULL_HANDLE; ring_alloc_ = nullptr; ring_mapped_ = nullptr; }
+    if (timeline_) { vkDestroySemaphore(device_, timeline_, nullptr); timeline_ = VK_NULL_HANDLE; }
+    if (pool_) { vkDestroyCommandPool(device_, pool_, nullptr); pool_ = VK_NULL_HANDLE; } // frees the command buffers
+    head_ = tail_ = submitted_ = acquired_ = reclaimed_ = wait_value_ = 0;
+}
+
+UploadService::Buffer UploadService::create_buffer(VkDeviceSize size, VkBufferUsageFlags usage) const {
+    const uint32_t families[2] = {graphics_family_, queue_family_};
+    const bool shared = graphics_family_ != queue_family_;
+    VkBufferCreateInfo bci{.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO, .pNext = nullptr, .flags = 0u, .size = size, .usage = usage | VK_BUFFER_USAGE_TRANSFER_DST_BIT, .sharingMode = shared ? VK_SHARING_MODE_CONCURRENT : VK_SHARING_MODE_EXCLUSIVE, .queueFamilyIndexCount = shared ? 2u : 0u, .pQueueFamilyIndices = shared ? families : nullptr};
+    // VMA picks host-visible device-local memory when it exists and falls back to plain device-local otherwise
+    VmaAllocationCreateInfo aci{}; aci.usage = VMA_MEMORY_USAGE_AUTO_PREFER_DEVICE;
+    aci.flags = VMA_ALLOCATION_CREATE_HOST_ACCESS_SEQUENTIAL_WRITE_BIT | VMA_ALLOCATION_CREATE_HOST_ACCESS_ALLOW_TRANSFER_INSTEAD_BIT | VMA_ALLOCATION_CREATE_MAPPED_BIT;
+    Buffer b{.size = size};
+    VmaAllocationInfo info{};
+    if (vmaCreateBuffer(allocator_, &bci, &aci, &b.buffer, &b.allocation, &info) != VK_SUCCESS) throw std::runtime_error("UploadService: buffer allocation failed");
+    VkMemoryPropertyFlags props = 0;
+    vmaGetAllocationMemoryProperties(allocator_, b.allocation, &props);
+    if ((props & VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT) && (props & VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT)) b.mapped = info.pMappedData;
+    if (usage & VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT) b.address = buffer_address(device_, b.buffer);
+    return b;
+}
+
+UploadService::Ticket UploadService::upload(const Buffer& dst, VkDeviceSize offset, const void* data, VkDeviceSize size) {
+    if (size == 0) return 0;
+    if (dst.mapped) {
+        std::memcpy(static_cast<std::byte*>(dst.mapped) + offset, data, size);
+        vmaFlushAllocation(allocator_, dst.allocation, offset, size); // no-op on coherent memory
+        stats_.bytes_direct += size;
+        return 0;
+    }
+    // Chunked so a single large upload can never need the whole ring at once
+    const VkDeviceSize chunk = std::max<VkDeviceSize>(kAlign, ring_size_ / 4);
+    const auto* src = static_cast<const std::byte*>(data);
+    for (VkDeviceSize done = 0; done < size;) {
+        const VkDeviceSize n = std::min(chunk, size - done);
+        const VkDeviceSize at = reserve(n, kAlign);
+        std::memcpy(ring_mapped_ + at, src + done, n);
+        vmaFlushAllocation(allocator_, ring_alloc_, at, n); // the ring may be non-coherent; no-op otherwise
+        buffer_copies_.push_back(BufferCopy{dst.buffer, VkBufferCopy{.srcOffset = at, .dstOffset = offset + done, .size = n}});
+        done += n;
+    }
+    stats_.bytes_staged += size; stats_.copies++;
+    return submitted_ + 1;
+}
+
+UploadService::Ticket UploadService::upload(VkImage dst, const VkBufferImageCopy& region, VkImageLayout final_layout, const void* data, VkDeviceSize size) {
+    if (size > ring_size_) throw std::runtime_error("UploadService: image upload larger than the staging ring");
+    const VkDeviceSize at = reserve(size, kAlign);
+    std::memcpy(ring_mapped_ + at, data, size);
+    vmaFlushAllocation(allocator_, ring_alloc_, at, size);
+    VkBufferImageCopy r = region; r.bufferOffset = at;
+    image_copies_.push_back(ImageCopy{dst, r, final_layout});
+    stats_.bytes_staged += size; stats_.copies++;
+    return submitted_ + 1;
+}
+
+VkDeviceSize UploadService::reserve(VkDeviceSize size, VkDeviceSize align) {
+    for (;;) {
+        const VkDeviceSize pos = (head_ % ring_size_ + align - 1) / align * align;
+        const VkDeviceSize start = pos + size <= ring_size_ ? pos : ring_size_; // never straddle the wrap point
+        const uint64_t new_head = head_ - head_ % ring_size_ + start + size;
+        if (new_head - tail_ <= ring_size_) { head_ = new_head; return start % ring_size_; }
+        // Full: submit what is recorded, then wait for the oldest batch not yet reclaimed to hand its space back.
+        // Its queue-family acquires and command buffer are still processed by the next acquire().
+        if (!buffer_copies_.empty() || !image_copies_.empty()) flush();
+        auto it = std::ranges::find_if(in_flight_, [&](const Batch& b) { return b.value > reclaimed_; });
+        if (it == in_flight_.end()) throw std::runtime_error("UploadService: staging ring exhausted");
+        VkSemaphoreWaitInfo wi{.sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO, .pNext = nullptr, .flags = 0u, .semaphoreCount = 1u, .pSemaphores = &timeline_, .pValues = &it->value};
+        if (vkWaitSemaphores(device_, &wi, UINT64_MAX) != VK_SUCCESS) throw std::runtime_error("UploadService: timeline wait failed");
+        tail_ = std::max<uint64_t>(tail_, it->ring_end);
+        reclaimed_ = it->value;
+        stats_.ring_stalls++;
+    }
+}
+
+VkCommandBuffer UploadService::next_cmd() {
+    if (!free_cmds_.empty()) { VkCommandBuffer c = free_cmds_.back(); free_cmds_.pop_back(); return c; }
+    VkCommandBuffer c{};
+    VkCommandBufferAllocateInfo ai{.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO, .pNext = nullptr, .commandPool = pool_, .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY, .commandBufferCount = 1u};
+    if (vkAllocateCommandBuffers(device_, &ai, &c) != VK_SUCCESS) throw std::runtime_error("UploadService: command buffer allocation failed");
+    return c;
+}
+
+void UploadService::flush() {
+    if (buffer_copies_.empty() && image_copies_.empty()) return;
+    VkCommandBuffer cmd = next_cmd();
+    if (vkResetCommandBuffer(cmd, 0u) != VK_SUCCESS) throw std::runtime_error("UploadService: command buffer reset failed");
+    VkCommandBufferBeginInfo bi{.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO, .pNext = nullptr, .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT, .pInheritanceInfo = nullptr};
+    if (vkBeginCommandBuffer(cmd, &bi) != VK_SUCCESS) throw std::runtime_error("UploadService: command buffer begin failed");
+
+    // Buffer copies: one vkCmdCopyBuffer per destination
+    std::stable_sort(buffer_copies_.begin(), buffer_copies_.end(), [](const BufferCopy& a, const BufferCopy& b) { return a.dst < b.dst; });
+    std::vector<VkBufferCopy> regions;
+    for (size_t i = 0; i < buffer_copies_.size();) {
+        regions.clear();
+        size_t j = i;
+        for (; j < buffer_copies_.size() && buffer_copies_[j].dst == buffer_copies_[i].dst; ++j) regions.push_back(buffer_copies_[j].region);
+        vkCmdCopyBuffer(cmd, ring_, buffer_copies_[i].dst, static_cast<uint32_t>(regions.size()), regions.data());
+        i = j;
+    }
+
+    Batch batch{.cmd = cmd, .value = ++submitted_, .ring_end = head_, .acquires = {}};
+    if (!image_copies_.empty()) {
+        auto range_of = [](const VkImageSubresourceLayers& l) { return VkImageSubresourceRange{l.aspectMask, l.mipLevel, 1u, l.baseArrayLayer, l.layerCount}; };
+        const bool transfer_ownership = queue_family_ != graphics_family_;
+        std::vector<VkImageMemoryBarrier2> barriers;
+        barriers.reserve(image_copies_.size());
+        for (const auto& c : image_copies_)
+            barriers.push_back(VkImageMemoryBarrier2{.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2, .pNext = nullptr, .srcStageMask = VK_PIPELINE_STAGE_2_NONE, .srcAccessMask = 0u, .dstStageMask = VK_PIPELINE_STAGE_2_COPY_BIT, .dstAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT, .oldLayout = VK_IMAGE_LAYOUT_UNDEFINED, .newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED, .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED, .image = c.dst, .subresourceRange = range_of(c.region.imageSubresource)});
+        VkDependencyInfo dep{.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO, .pNext = nullptr, .dependencyFlags = 0u, .memoryBarrierCount = 0u, .pMemoryBarriers = nullptr, .bufferMemoryBarrierCount = 0u, .pBufferMemoryBarriers = nullptr, .imageMemoryBarrierCount = static_cast<uint32_t>(barriers.size()), .pImageMemoryBarriers = barriers.data()};
+        vkCmdPipelineBarrier2(cmd, &dep);
+        for (const auto& c : image_copies_) vkCmdCopyBufferToImage(cmd, ring_, c.dst, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1u, &c.region);
+
+        // Release to the graphics family (acquired in acquire()), or transition in place when the families match
+        barriers.clear();
+        for (const auto& c : image_copies_) {
+            const VkImageSubresourceRange range = range_of(c.region.imageSubresource);
+            barriers.push_back(VkImageMemoryBarrier2{.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2, .pNext = nullptr, .srcStageMask = VK_PIPELINE_STAGE_2_COPY_BIT, .srcAccessMask = VK_ACCESS_2_TRANSFER_WRITE_BIT, .dstStageMask = transfer_ownership ? VK_PIPELINE_STAGE_2_NONE : VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, .dstAccessMask = 0u, .oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, .newLayout = c.final_layout, .srcQueueFamilyIndex = transfer_ownership ? queue_family_ : VK_QUEUE_FAMILY_IGNORED, .dstQueueFamilyIndex = transfer_ownership ? graphics_family_ : VK_QUEUE_FAMILY_IGNORED, .image = c.dst, .subresourceRange = range});
+            if (transfer_ownership) batch.acquires.push_back(ImageAcquire{c.dst, range, c.final_layout});
+        }
+        dep.imageMemoryBarrierCount = static_cast<uint32_t>(barriers.size()); dep.pImageMemoryBarriers = barriers.data();
+        vkCmdPipelineBarrier2(cmd, &dep);
+    }
+    if (vkEndCommandBuffer(cmd) != VK_SUCCESS) throw std::runtime_error("UploadService: command buffer end failed");
+
+    VkCommandBufferSubmitInfo cbsi{.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_SUBMIT_INFO, .pNext = nullptr, .commandBuffer = cmd, .deviceMask = 0u};
+    VkSemaphoreSubmitInfo signal{.sType = VK_STRUCTURE_TYPE_SEMAPHORE_SUBMIT_INFO, .pNext = nullptr, .semaphore = timeline_, .value = batch.value, .stageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, .deviceIndex = 0u};
+    VkSubmitInfo2 si{.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO_2, .pNext = nullptr, .flags = 0u, .waitSemaphoreInfoCount = 0u, .pWaitSemaphoreInfos = nullptr, .commandBufferInfoCount = 1u, .pCommandBufferInfos = &cbsi, .signalSemaphoreInfoCount = 1u, .pSignalSemaphoreInfos = &signal};
+    if (vkQueueSubmit2(queue_, 1u, &si, VK_NULL_HANDLE) != VK_SUCCESS) throw std::runtime_error("UploadService: transfer submit failed");
+    in_flight_.push_back(std::move(batch));
+    buffer_copies_.clear(); image_copies_.clear();
+}
+
+void UploadService::acquire(VkCommandBuffer graphics_cmd) {
+    last_frame_ = stats_;
+    stats_.bytes_staged = stats_.bytes_direct = 0; stats_.copies = 0;
+    wait_value_ = 0;
+    if (in_flight_.empty()) return;
+    uint64_t completed = 0;
+    if (vkGetSemaphoreCounterValue(device_, timeline_, &completed) != VK_SUCCESS) return;
+    retire_completed(completed, graphics_cmd);
+}
+
+void UploadService::retire_completed(uint64_t completed, VkCommandBuffer graphics_cmd) {
+    std::vector<VkImageMemoryBarrier2> barriers;
+    size_t n = 0;
+    for (; n < in_flight_.size() && in_flight_[n].value <= completed; ++n) {
+        Batch& b = in_flight_[n];
+        for (const auto& a : b.acquires)
+            barriers.push_back(VkImageMemoryBarrier2{.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER_2, .pNext = nullptr, .srcStageMask = VK_PIPELINE_STAGE_2_NONE, .srcAccessMask = 0u, .dstStageMask = VK_PIPELINE_STAGE_2_ALL_COMMANDS_BIT, .dstAccessMask = VK_ACCESS_2_MEMORY_READ_BIT, .oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, .newLayout = a.layout, .srcQueueFamilyIndex = queue_family_, .dstQueueFamilyIndex = graphics_family_, .image = a.image, .subresourceRange = a.range});
+        tail_ = std::max<uint64_t>(tail_, b.ring_end);
+        reclaimed_ = std::max(reclaimed_, b.value);
+        free_cmds_.push_back(b.cmd);
+        acquired_ = b.value;
+        wait_value_ = b.value;
+    }
+    in_flight_.erase(in_flight_.begin(), in_flight_.begin() + static_cast<std::ptrdiff_t>(n));
+    if (!barriers.empty()) {
+        VkDependencyInfo dep{.sType = VK_STRUCTURE_TYPE_DEPENDENCY_INFO, .pNext = nullptr, .dependencyFlags = 0u, .memoryBarrierCount = 0u, .pMemoryBarriers = nullptr, .bufferMemoryBarrierCount = 0u, .pBufferMemoryBarriers = nullptr, .imageMemoryBarrierCount = static_cast<uint32_t>(barriers.size()), .pImageMemoryBarriers = barriers.data()};
+        vkCmdPipelineBarrier2(graphics_cmd, &dep);
+    }
+    stats_.batches_in_flight = static_cast<uint32_t>(in_flight_.size());
+}
+
+void UploadService::imgui_panel_contents() const {
+    const double used = ring_size_ ? static_cast<double>(head_ - tail_) / static_cast<double>(ring_size_) : 0.0;
+    ImGui::Text("Uploads: %u copies, %.1f KiB staged, %.1f KiB direct last frame", last_frame_.copies, static_cast<double>(last_frame_.bytes_staged) / 1024.0, static_cast<double>(last_frame_.bytes_direct) / 1024.0);
+    ImGui::Text("Staging ring: %.1f%% of %.1f MiB in use, %zu batches in flight, %u stalls", used * 100.0, static_cast<double>(ring_size_) / (1024.0 * 1024.0), in_flight_.size(), stats_.ring_stalls);
+    ImGui::Text("Direct writes (ReBAR): %s", rebar_ ? "yes" : "no (small BAR / staging only)");
+}
+
+} // namespace vv